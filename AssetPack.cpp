@@ -0,0 +1,222 @@
+#include <fstream>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+#include "AssetPack.h"
+
+static const char packMagic[8] = { 'A', 'S', 'S', 'E', 'T', 'P', 'A', 'K' };
+
+// blobs start on this boundary, like the mesh cache's sections, so a cache inside a pack keeps
+// its arrays aligned
+static const uint64_t blobAlignment = 16;
+
+struct PackHeader {
+	char magic[8];
+	uint32_t version;
+	uint32_t numAssets;
+	uint64_t namesOffset;
+	uint64_t namesSize;
+};
+
+struct PackTableEntry {
+	uint32_t nameOffset;
+	uint32_t nameSize;
+	uint32_t format;
+	uint32_t reserved;
+	uint64_t offset;
+	uint64_t size;
+	int64_t sourceTime;
+};
+
+static uint64_t alignUp(uint64_t value) {
+	return (value + blobAlignment - 1) & ~(blobAlignment - 1);
+}
+
+// the form names are stored and looked up in, so "shaders\a.glsl" and "./shaders/a.glsl" match
+static std::string normalizeName(const std::string &name) {
+	std::string normalized = name;
+	std::replace(normalized.begin(), normalized.end(), '\\', '/');
+	while (normalized.compare(0, 2, "./") == 0) {
+		normalized.erase(0, 2);
+	}
+	return normalized;
+}
+
+static bool entryBefore(const AssetEntry &a, const AssetEntry &b) {
+	return a.name < b.name;
+}
+
+AssetPack::AssetPack() {
+}
+
+bool AssetPack::open(const std::string filename) {
+	this->close();
+
+	if (!this->file.open(filename, true)) {
+		return false;
+	}
+
+	const char* data = this->file.getData();
+	uint64_t size = this->file.getSize();
+
+	PackHeader header;
+	if (size < sizeof(header)) {
+		this->close();
+		return false;
+	}
+	memcpy(&header, data, sizeof(header));
+
+	bool valid = memcmp(header.magic, packMagic, sizeof(packMagic)) == 0
+		&& header.version == ASSET_PACK_VERSION
+		&& sizeof(header) + (uint64_t)header.numAssets * sizeof(PackTableEntry) <= size
+		&& header.namesOffset <= size && header.namesSize <= size - header.namesOffset;
+	if (!valid) {
+		this->close();
+		return false;
+	}
+
+	const char* table = data + sizeof(header);
+	const char* names = data + header.namesOffset;
+	for (uint32_t i = 0; i < header.numAssets; i++) {
+		PackTableEntry entry;
+		memcpy(&entry, table + i * sizeof(entry), sizeof(entry));
+
+		if (entry.offset % blobAlignment != 0 || entry.offset > size || entry.size > size - entry.offset
+			|| entry.nameOffset > header.namesSize || entry.nameSize > header.namesSize - entry.nameOffset
+			|| entry.format > ASSET_IMAGE_RGBA8) {
+			this->close();
+			return false;
+		}
+
+		AssetEntry asset;
+		asset.name.assign(names + entry.nameOffset, entry.nameSize);
+		asset.format = (AssetFormat)entry.format;
+		asset.data = data + entry.offset;
+		asset.size = (size_t)entry.size;
+		asset.sourceTime = entry.sourceTime;
+		this->entries.push_back(asset);
+	}
+
+	// save() writes them sorted, but a lookup must not depend on it
+	std::sort(this->entries.begin(), this->entries.end(), entryBefore);
+	return true;
+}
+
+void AssetPack::close() {
+	this->entries.clear();
+	this->pendingData.clear();
+	this->file.close();
+}
+
+bool AssetPack::isOpen() {
+	return this->file.isOpen();
+}
+
+const AssetEntry* AssetPack::find(const std::string name) {
+	if (!this->file.isOpen()) {
+		return nullptr;
+	}
+	AssetEntry key;
+	key.name = normalizeName(name);
+	std::vector<AssetEntry>::iterator found = std::lower_bound(this->entries.begin(), this->entries.end(), key, entryBefore);
+	return found != this->entries.end() && found->name == key.name ? &*found : nullptr;
+}
+
+unsigned int AssetPack::getNumAssets() {
+	return (unsigned int)this->entries.size();
+}
+
+const AssetEntry* AssetPack::getAssets() {
+	return this->entries.data();
+}
+
+void AssetPack::addAsset(const std::string name, const AssetFormat format, const void* data, const size_t size,
+	const long long sourceTime) {
+	// a pack is either read or written
+	if (this->file.isOpen()) {
+		this->close();
+	}
+
+	AssetEntry asset;
+	asset.name = normalizeName(name);
+	asset.format = format;
+	asset.data = nullptr;
+	asset.size = size;
+	asset.sourceTime = sourceTime;
+	this->entries.push_back(asset);
+	this->pendingData.push_back(std::vector<char>((const char*)data, (const char*)data + size));
+}
+
+bool AssetPack::save(const std::string filename) {
+	// sorted by name, which is the order find() searches them in
+	std::vector<size_t> order(this->entries.size());
+	for (size_t i = 0; i < order.size(); i++) {
+		order[i] = i;
+	}
+	std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+		return this->entries[a].name < this->entries[b].name;
+	});
+
+	std::string names;
+	std::vector<PackTableEntry> table(order.size());
+	for (size_t i = 0; i < order.size(); i++) {
+		const AssetEntry &asset = this->entries[order[i]];
+		table[i].nameOffset = (uint32_t)names.size();
+		table[i].nameSize = (uint32_t)asset.name.size();
+		table[i].format = (uint32_t)asset.format;
+		table[i].reserved = 0;
+		table[i].size = asset.size;
+		table[i].sourceTime = asset.sourceTime;
+		names.append(asset.name);
+	}
+
+	PackHeader header;
+	memcpy(header.magic, packMagic, sizeof(packMagic));
+	header.version = ASSET_PACK_VERSION;
+	header.numAssets = (uint32_t)table.size();
+	header.namesOffset = sizeof(header) + table.size() * sizeof(PackTableEntry);
+	header.namesSize = names.size();
+
+	// lay the blobs out after the header, table and names
+	uint64_t offset = alignUp(header.namesOffset + header.namesSize);
+	for (size_t i = 0; i < table.size(); i++) {
+		table[i].offset = offset;
+		offset = alignUp(offset + table[i].size);
+	}
+
+	// write to a temporary file and move it into place, so a crash never leaves a torn pack
+	std::string tempFilename = filename + ".tmp";
+	std::ofstream fileOut(tempFilename, std::ios::binary | std::ios::trunc);
+	if (!fileOut.is_open()) {
+		this->entries.clear();
+		this->pendingData.clear();
+		return false;
+	}
+
+	const char padding[blobAlignment] = { 0 };
+	uint64_t written = header.namesOffset + header.namesSize;
+	fileOut.write((const char*)&header, sizeof(header));
+	fileOut.write((const char*)table.data(), table.size() * sizeof(PackTableEntry));
+	fileOut.write(names.data(), names.size());
+	for (size_t i = 0; i < table.size(); i++) {
+		fileOut.write(padding, table[i].offset - written);
+		fileOut.write(this->pendingData[order[i]].data(), table[i].size);
+		written = table[i].offset + table[i].size;
+	}
+	fileOut.close();
+	this->entries.clear();
+	this->pendingData.clear();
+
+	if (!fileOut) {
+		std::remove(tempFilename.c_str());
+		return false;
+	}
+
+	std::remove(filename.c_str());
+	if (std::rename(tempFilename.c_str(), filename.c_str()) != 0) {
+		std::remove(tempFilename.c_str());
+		return false;
+	}
+	return true;
+}
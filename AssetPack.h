@@ -0,0 +1,70 @@
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+#include "MappedFile.h"
+
+#pragma once
+
+// bump whenever the layout of the file changes
+#define ASSET_PACK_VERSION 1
+
+// how an asset's blob holds it: the source file's bytes as they are, or processed ahead of time
+enum AssetFormat {
+	ASSET_RAW = 0,
+	// an image decoded to 8-bit RGBA: an AssetImageHeader, then the rows top to bottom
+	ASSET_IMAGE_RGBA8 = 1
+};
+
+struct AssetImageHeader {
+	uint32_t width;
+	uint32_t height;
+};
+typedef struct AssetImageHeader AssetImageHeader;
+
+// an asset of an open pack: its blob, and the modification time of the file it was made from
+// (which is what a cache built from the file was keyed on)
+struct AssetEntry {
+	std::string name;
+	AssetFormat format;
+	const char* data;
+	size_t size;
+	long long sourceTime;
+};
+typedef struct AssetEntry AssetEntry;
+
+// a single file holding the assets the program would otherwise open one by one (meshes, their
+// caches, textures, shaders), each under the relative path it would be loaded by, behind a table
+// of contents. It is mapped once, copy-on-write like the mesh cache, and blobs start on 16-byte
+// boundaries so arrays inside them can be used in place. Anything a pack lacks is read from the
+// loose file instead, which is how assets are edited during development.
+class AssetPack {
+private:
+	MappedFile file;
+	std::vector<AssetEntry> entries;
+	std::vector<std::vector<char> > pendingData;
+
+	AssetPack(const AssetPack&) = delete;
+	AssetPack& operator=(const AssetPack&) = delete;
+
+public:
+	AssetPack();
+
+	// maps a pack, failing if it is missing, corrupt, or from another version
+	bool open(const std::string filename);
+	void close();
+	bool isOpen();
+
+	// the asset loaded by that path ('\' and '/' alike, without any leading "./"), or null if the
+	// pack has none; it stays valid until the pack is closed
+	const AssetEntry* find(const std::string name);
+	unsigned int getNumAssets();
+	const AssetEntry* getAssets();
+
+	// queues a copy of an asset for save(), which writes every queued asset into a new pack; a
+	// pack that was open is closed first
+	void addAsset(const std::string name, const AssetFormat format, const void* data, const size_t size,
+		const long long sourceTime);
+	bool save(const std::string filename);
+};
@@ -0,0 +1,149 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+
+#define STB_IMAGE_IMPLEMENTATION
+#include "apis/stb_image.h"
+
+#include "AssetPack.h"
+#include "MappedFile.h"
+#include "ObjMesh.h"
+#include "GlbFile.h"
+
+// packs the files main loads into one asset pack, which main maps at startup in place of opening
+// them one by one. Each file is stored under the path it is given as, so it should be named
+// relative to where main runs. Images are decoded to RGBA8 ahead of time unless --raw is given,
+// and every mesh is stored with the cache main would build for it, so nothing is parsed at startup.
+//
+// usage: assetpack <pack> [--raw] files...
+//   e.g. assetpack assets.pack meshes/newHead.obj meshes/newHead.mtl textures/sun.jpg shaders/*.glsl
+
+static bool hasExtension(const std::string &filename, const char* extension) {
+	std::string suffix = std::string(".") + extension;
+	if (filename.size() < suffix.size()) {
+		return false;
+	}
+	std::string ending = filename.substr(filename.size() - suffix.size());
+	std::transform(ending.begin(), ending.end(), ending.begin(), [](unsigned char c) { return (char)std::tolower(c); });
+	return ending == suffix;
+}
+
+static bool isImageFilename(const std::string &filename) {
+	return hasExtension(filename, "jpg") || hasExtension(filename, "jpeg") || hasExtension(filename, "png")
+		|| hasExtension(filename, "bmp") || hasExtension(filename, "tga");
+}
+
+static bool isMeshFilename(const std::string &filename) {
+	return hasExtension(filename, "obj") || isGlbFilename(filename);
+}
+
+// the same processing main gives the head, so that the cache's key matches what main asks for
+static void configureMesh(ObjMesh &mesh) {
+	mesh.setUseCache(true);
+	mesh.setWeldVertices(true);
+	mesh.setOptimizeVertexCache(true);
+	mesh.setOptimizeVertexFetch(true);
+	mesh.setGenerateLods(true);
+	mesh.setGenerateMeshlets(true);
+}
+
+// queues a file as it is, failing if it cannot be read
+static bool addRawFile(AssetPack &pack, const std::string &filename, const std::string &name) {
+	MappedFile fileIn;
+	if (!fileIn.open(filename)) {
+		std::cerr << "Could not open " << filename.c_str() << std::endl;
+		return false;
+	}
+	pack.addAsset(name, ASSET_RAW, fileIn.getData(), fileIn.getSize(), fileIn.getModifiedTime());
+	return true;
+}
+
+static bool addImage(AssetPack &pack, const std::string &filename) {
+	MappedFile fileIn;
+	if (!fileIn.open(filename)) {
+		std::cerr << "Could not open " << filename.c_str() << std::endl;
+		return false;
+	}
+
+	int width, height, numComponents;
+	unsigned char* bitmap = stbi_load_from_memory((const stbi_uc*)fileIn.getData(), (int)fileIn.getSize(),
+		&width, &height, &numComponents, 4);
+	if (bitmap == nullptr) {
+		std::cerr << "Could not decode " << filename.c_str() << ": " << stbi_failure_reason() << std::endl;
+		return false;
+	}
+
+	AssetImageHeader image;
+	image.width = (uint32_t)width;
+	image.height = (uint32_t)height;
+	size_t pixelsSize = (size_t)width * (size_t)height * 4;
+	std::vector<char> blob(sizeof(image) + pixelsSize);
+	memcpy(blob.data(), &image, sizeof(image));
+	memcpy(blob.data() + sizeof(image), bitmap, pixelsSize);
+	stbi_image_free(bitmap);
+
+	pack.addAsset(filename, ASSET_IMAGE_RGBA8, blob.data(), blob.size(), fileIn.getModifiedTime());
+	return true;
+}
+
+static bool addMesh(AssetPack &pack, const std::string &filename) {
+	if (!addRawFile(pack, filename, filename)) {
+		return false;
+	}
+
+	// loading the mesh the way main does writes (or refreshes) its loose cache, which is packed next to it
+	ObjMesh mesh;
+	configureMesh(mesh);
+	mesh.load(filename, true, true);
+	if (mesh.getNumIndexedVertices() == 0) {
+		std::cerr << "Could not load " << filename.c_str() << std::endl;
+		return false;
+	}
+	std::string cacheFilename = filename + ".cache";
+	return addRawFile(pack, cacheFilename, cacheFilename);
+}
+
+int main(int argc, char** argv) {
+	if (argc < 3) {
+		std::cerr << "usage: assetpack <pack> [--raw] files..." << std::endl;
+		return 1;
+	}
+	std::string packFilename = argv[1];
+
+	AssetPack pack;
+	bool decodeImages = true;
+	for (int a = 2; a < argc; a++) {
+		std::string filename = argv[a];
+		if (filename == "--raw") {
+			decodeImages = false;
+			continue;
+		}
+
+		bool added;
+		if (isMeshFilename(filename)) {
+			added = addMesh(pack, filename);
+		} else if (decodeImages && isImageFilename(filename)) {
+			added = addImage(pack, filename);
+		} else {
+			added = addRawFile(pack, filename, filename);
+		}
+		if (!added) {
+			return 1;
+		}
+	}
+
+	unsigned int numAssets = pack.getNumAssets();
+	size_t totalSize = 0;
+	for (unsigned int i = 0; i < numAssets; i++) {
+		totalSize += pack.getAssets()[i].size;
+	}
+	if (!pack.save(packFilename)) {
+		std::cerr << "Could not write " << packFilename.c_str() << std::endl;
+		return 1;
+	}
+	std::cout << "Packed " << numAssets << " assets, " << totalSize << " bytes, into " << packFilename.c_str() << std::endl;
+	return 0;
+}
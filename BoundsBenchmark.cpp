@@ -0,0 +1,169 @@
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <limits>
+#include <cstdlib>
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+
+#include "PositionBounds.h"
+
+// a headless benchmark of what a load does to the positions for autoCentre and autoNormalize:
+// find the bounds and centroid, move the centroid to the origin and scale the largest extent to
+// 1. The loops the parser used before run first, as the baseline, and then computePositionBounds()
+// and transformPositions() with every instruction set this CPU has.
+//
+// usage: boundsbench [numVertices]   (10000000 by default)
+
+// how long to keep repeating each measurement, of which the fastest pass counts
+static const double minSeconds = 0.25;
+static const int minPasses = 3;
+
+static const size_t defaultNumVertices = 10000000;
+
+typedef std::chrono::steady_clock Clock;
+
+// the old loops: a branchy per-vertex min/max, a serial float sum, then a subtract pass and a
+// divide pass (with the max starting at lowest() rather than the old, wrong, min())
+static void referenceCentre(float* positions, const size_t numVertices, float centre[3], float &scale) {
+	float minimum[3] = { std::numeric_limits<float>::max(), std::numeric_limits<float>::max(), std::numeric_limits<float>::max() };
+	float maximum[3] = { std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest() };
+	for (size_t i = 0; i < numVertices; i++) {
+		for (int axis = 0; axis < 3; axis++) {
+			float v = positions[i * 3 + axis];
+			if (v < minimum[axis]) {
+				minimum[axis] = v;
+			}
+			if (v > maximum[axis]) {
+				maximum[axis] = v;
+			}
+		}
+	}
+
+	float total[3] = { 0.0f, 0.0f, 0.0f };
+	for (size_t i = 0; i < numVertices; i++) {
+		for (int axis = 0; axis < 3; axis++) {
+			total[axis] += positions[i * 3 + axis];
+		}
+	}
+
+	scale = 0.0f;
+	for (int axis = 0; axis < 3; axis++) {
+		centre[axis] = total[axis] / float(numVertices);
+		if (maximum[axis] - minimum[axis] > scale) {
+			scale = maximum[axis] - minimum[axis];
+		}
+	}
+
+	for (size_t i = 0; i < numVertices; i++) {
+		for (int axis = 0; axis < 3; axis++) {
+			positions[i * 3 + axis] -= centre[axis];
+		}
+	}
+	for (size_t i = 0; i < numVertices; i++) {
+		for (int axis = 0; axis < 3; axis++) {
+			positions[i * 3 + axis] /= scale;
+		}
+	}
+}
+
+// the same with the kernels, returning the bounds they found
+static void kernelCentre(float* positions, const size_t numVertices, PositionBounds &bounds, float &scale) {
+	computePositionBounds(positions, numVertices, bounds);
+	scale = 0.0f;
+	for (int axis = 0; axis < 3; axis++) {
+		if (bounds.max[axis] - bounds.min[axis] > scale) {
+			scale = bounds.max[axis] - bounds.min[axis];
+		}
+	}
+	transformPositions(positions, numVertices, bounds.centroid, scale);
+}
+
+// the furthest a centroid is from the exact one on any axis
+static double centroidError(const float centroid[3], const double exact[3]) {
+	double error = 0.0;
+	for (int axis = 0; axis < 3; axis++) {
+		error = std::fmax(error, std::fabs(centroid[axis] - exact[axis]));
+	}
+	return error;
+}
+
+// the fastest pass of fn over a fresh copy of source, in seconds; the copying is not timed
+template <typename Fn>
+static double timePasses(const std::vector<float> &source, std::vector<float> &work, Fn fn) {
+	double best = 0.0;
+	double total = 0.0;
+	for (int pass = 0; pass < minPasses || total < minSeconds; pass++) {
+		memcpy(work.data(), source.data(), source.size() * sizeof(float));
+		Clock::time_point start = Clock::now();
+		fn(work.data());
+		double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+		best = pass == 0 || seconds < best ? seconds : best;
+		total += seconds;
+	}
+	return best;
+}
+
+int main(int argc, char** argv) {
+	size_t numVertices = argc > 1 ? (size_t)strtoull(argv[1], nullptr, 10) : defaultNumVertices;
+	if (numVertices == 0) {
+		std::cerr << "usage: boundsbench [numVertices]" << std::endl;
+		return 1;
+	}
+
+	// a box off the origin, different on each axis, from a fixed seed so runs compare
+	std::vector<float> source(numVertices * 3);
+	uint32_t state = 12345;
+	for (size_t i = 0; i < source.size(); i++) {
+		state = state * 1664525u + 1013904223u;
+		float unit = (state >> 8) * (1.0f / 16777216.0f);
+		int axis = (int)(i % 3);
+		source[i] = (axis == 0 ? 120.0f : axis == 1 ? -40.0f : 3.0f) + unit * (axis == 0 ? 50.0f : axis == 1 ? 200.0f : 10.0f);
+	}
+	std::vector<float> work(source.size());
+
+	// the centroid summed exactly enough to judge the others by
+	double exact[3] = { 0.0, 0.0, 0.0 };
+	for (size_t i = 0; i < source.size(); i++) {
+		exact[i % 3] += source[i];
+	}
+	for (int axis = 0; axis < 3; axis++) {
+		exact[axis] /= (double)numVertices;
+	}
+
+	float centre[3];
+	float scale;
+	double baseline = timePasses(source, work, [&](float* positions) {
+		referenceCentre(positions, numVertices, centre, scale);
+	});
+
+	std::cout << numVertices << " vertices, centre and scale to a unit box (best of at least " << minPasses << " passes)" << std::endl;
+	std::cout << std::fixed << std::setprecision(1);
+	std::cout << "  " << std::left << std::setw(18) << "old scalar loops" << std::right << std::setw(8) << baseline * 1000.0
+		<< " ms         centroid off by " << std::scientific << std::setprecision(1) << centroidError(centre, exact)
+		<< std::fixed << std::endl;
+
+	const char* kernelNames[] = { "scalar", "SSE2", "AVX2" };
+	for (int k = 0; k < 3; k++) {
+		if (!usePositionKernel(kernelNames[k])) {
+			std::cout << "  " << std::left << std::setw(18) << (std::string("kernel, ") + kernelNames[k]) << std::right << "  not on this CPU" << std::endl;
+			continue;
+		}
+
+		PositionBounds bounds;
+		float kernelScale;
+		double seconds = timePasses(source, work, [&](float* positions) {
+			kernelCentre(positions, numVertices, bounds, kernelScale);
+		});
+
+		// the box, and so the scale, must match exactly
+		std::cout << "  " << std::left << std::setw(18) << (std::string("kernel, ") + kernelNames[k]) << std::right
+			<< std::setw(8) << seconds * 1000.0 << " ms  " << std::setprecision(2) << std::setw(5) << baseline / seconds
+			<< "x  centroid off by " << std::scientific << std::setprecision(1) << centroidError(bounds.centroid, exact)
+			<< std::fixed << ", scale " << (kernelScale == scale ? "matches" : "differs") << std::endl;
+	}
+	return 0;
+}
@@ -0,0 +1,671 @@
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <cctype>
+#include <algorithm>
+
+#include "GlbFile.h"
+
+static const uint32_t glbMagic = 0x46546C67;
+static const uint32_t glbVersion = 2;
+static const uint32_t glbChunkJson = 0x4E4F534A;
+static const uint32_t glbChunkBin = 0x004E4942;
+static const size_t glbHeaderSize = 12;
+static const size_t glbChunkHeaderSize = 8;
+
+// the glTF primitive mode of a triangle list, the default
+static const size_t glbModeTriangles = 4;
+
+// the largest byteStride glTF allows
+static const size_t glbMaxStride = 252;
+
+// nesting deeper than any glTF needs is taken as a malformed (or hostile) file
+static const int maxJsonDepth = 64;
+
+// just enough JSON for a glTF file: a parsed value, with an object's members in file order
+enum JsonType {
+	JSON_NULL,
+	JSON_BOOLEAN,
+	JSON_NUMBER,
+	JSON_STRING,
+	JSON_ARRAY,
+	JSON_OBJECT
+};
+
+struct JsonValue {
+	JsonType type;
+	bool boolean;
+	double number;
+	std::string string;
+	std::vector<JsonValue> items;
+	std::vector<std::string> keys;
+	std::vector<JsonValue> values;
+};
+typedef struct JsonValue JsonValue;
+
+static inline void skipWhitespace(const char* &p, const char* end) {
+	while (p < end && (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r')) {
+		p++;
+	}
+}
+
+static inline bool matchWord(const char* &p, const char* end, const char* word) {
+	size_t length = strlen(word);
+	if ((size_t)(end - p) < length || memcmp(p, word, length) != 0) {
+		return false;
+	}
+	p += length;
+	return true;
+}
+
+// the value of a hexadecimal digit, or -1 for any other character
+static int hexDigit(char ch) {
+	if (ch >= '0' && ch <= '9') {
+		return ch - '0';
+	}
+	if (ch >= 'a' && ch <= 'f') {
+		return ch - 'a' + 10;
+	}
+	if (ch >= 'A' && ch <= 'F') {
+		return ch - 'A' + 10;
+	}
+	return -1;
+}
+
+static bool parseHex4(const char* p, const char* end, uint32_t &code) {
+	if (end - p < 4) {
+		return false;
+	}
+	code = 0;
+	for (int i = 0; i < 4; i++) {
+		int digit = hexDigit(p[i]);
+		if (digit < 0) {
+			return false;
+		}
+		code = code * 16 + (uint32_t)digit;
+	}
+	return true;
+}
+
+static void appendUtf8(std::string &string, uint32_t code) {
+	if (code < 0x80) {
+		string.push_back((char)code);
+	} else if (code < 0x800) {
+		string.push_back((char)(0xC0 | (code >> 6)));
+		string.push_back((char)(0x80 | (code & 0x3F)));
+	} else if (code < 0x10000) {
+		string.push_back((char)(0xE0 | (code >> 12)));
+		string.push_back((char)(0x80 | ((code >> 6) & 0x3F)));
+		string.push_back((char)(0x80 | (code & 0x3F)));
+	} else {
+		string.push_back((char)(0xF0 | (code >> 18)));
+		string.push_back((char)(0x80 | ((code >> 12) & 0x3F)));
+		string.push_back((char)(0x80 | ((code >> 6) & 0x3F)));
+		string.push_back((char)(0x80 | (code & 0x3F)));
+	}
+}
+
+// p is on the opening quote, and ends up past the closing one
+static bool parseJsonString(const char* &p, const char* end, std::string &string) {
+	p++;
+	while (p < end && *p != '"') {
+		char ch = *p++;
+		if ((unsigned char)ch < 0x20) {
+			return false;
+		}
+		if (ch != '\\') {
+			string.push_back(ch);
+			continue;
+		}
+		if (p == end) {
+			return false;
+		}
+		char escape = *p++;
+		switch (escape) {
+		case '"': case '\\': case '/': string.push_back(escape); break;
+		case 'b': string.push_back('\b'); break;
+		case 'f': string.push_back('\f'); break;
+		case 'n': string.push_back('\n'); break;
+		case 'r': string.push_back('\r'); break;
+		case 't': string.push_back('\t'); break;
+		case 'u': {
+			uint32_t code;
+			if (!parseHex4(p, end, code)) {
+				return false;
+			}
+			p += 4;
+			// characters beyond the basic plane come as a pair of surrogates
+			if (code >= 0xD800 && code < 0xDC00) {
+				uint32_t low;
+				if (end - p < 6 || p[0] != '\\' || p[1] != 'u' || !parseHex4(p + 2, end, low) || low < 0xDC00 || low >= 0xE000) {
+					return false;
+				}
+				p += 6;
+				code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+			} else if (code >= 0xDC00 && code < 0xE000) {
+				return false;
+			}
+			appendUtf8(string, code);
+			break;
+		}
+		default:
+			return false;
+		}
+	}
+	if (p == end) {
+		return false;
+	}
+	p++;
+	return true;
+}
+
+static bool parseJsonNumber(const char* &p, const char* end, double &number) {
+	const char* start = p;
+	if (p < end && *p == '-') {
+		p++;
+	}
+	const char* digits = p;
+	while (p < end && isdigit((unsigned char)*p)) {
+		p++;
+	}
+	if (p == digits) {
+		return false;
+	}
+	if (p < end && *p == '.') {
+		p++;
+		digits = p;
+		while (p < end && isdigit((unsigned char)*p)) {
+			p++;
+		}
+		if (p == digits) {
+			return false;
+		}
+	}
+	if (p < end && (*p == 'e' || *p == 'E')) {
+		p++;
+		if (p < end && (*p == '+' || *p == '-')) {
+			p++;
+		}
+		digits = p;
+		while (p < end && isdigit((unsigned char)*p)) {
+			p++;
+		}
+		if (p == digits) {
+			return false;
+		}
+	}
+	// the chunk is not terminated, so strtod gets a copy of just the number
+	std::string text(start, p);
+	number = strtod(text.c_str(), nullptr);
+	return true;
+}
+
+static bool parseJsonValue(const char* &p, const char* end, int depth, JsonValue &value) {
+	value.type = JSON_NULL;
+	skipWhitespace(p, end);
+	if (p == end || depth > maxJsonDepth) {
+		return false;
+	}
+
+	if (*p == '{') {
+		value.type = JSON_OBJECT;
+		p++;
+		skipWhitespace(p, end);
+		if (p < end && *p == '}') {
+			p++;
+			return true;
+		}
+		while (true) {
+			skipWhitespace(p, end);
+			value.keys.emplace_back();
+			if (p == end || *p != '"' || !parseJsonString(p, end, value.keys.back())) {
+				return false;
+			}
+			skipWhitespace(p, end);
+			if (p == end || *p++ != ':') {
+				return false;
+			}
+			value.values.emplace_back();
+			if (!parseJsonValue(p, end, depth + 1, value.values.back())) {
+				return false;
+			}
+			skipWhitespace(p, end);
+			if (p == end) {
+				return false;
+			}
+			char separator = *p++;
+			if (separator == '}') {
+				return true;
+			}
+			if (separator != ',') {
+				return false;
+			}
+		}
+	}
+	if (*p == '[') {
+		value.type = JSON_ARRAY;
+		p++;
+		skipWhitespace(p, end);
+		if (p < end && *p == ']') {
+			p++;
+			return true;
+		}
+		while (true) {
+			value.items.emplace_back();
+			if (!parseJsonValue(p, end, depth + 1, value.items.back())) {
+				return false;
+			}
+			skipWhitespace(p, end);
+			if (p == end) {
+				return false;
+			}
+			char separator = *p++;
+			if (separator == ']') {
+				return true;
+			}
+			if (separator != ',') {
+				return false;
+			}
+		}
+	}
+	if (*p == '"') {
+		value.type = JSON_STRING;
+		return parseJsonString(p, end, value.string);
+	}
+	if (matchWord(p, end, "true")) {
+		value.type = JSON_BOOLEAN;
+		value.boolean = true;
+		return true;
+	}
+	if (matchWord(p, end, "false")) {
+		value.type = JSON_BOOLEAN;
+		value.boolean = false;
+		return true;
+	}
+	if (matchWord(p, end, "null")) {
+		return true;
+	}
+	value.type = JSON_NUMBER;
+	return parseJsonNumber(p, end, value.number);
+}
+
+// the member of an object, or null when it has none of that name (or is not an object)
+static const JsonValue* findMember(const JsonValue* object, const char* key) {
+	if (object == nullptr || object->type != JSON_OBJECT) {
+		return nullptr;
+	}
+	for (size_t i = 0; i < object->keys.size(); i++) {
+		if (object->keys[i] == key) {
+			return &object->values[i];
+		}
+	}
+	return nullptr;
+}
+
+static const JsonValue* findItem(const JsonValue* array, size_t index) {
+	if (array == nullptr || array->type != JSON_ARRAY || index >= array->items.size()) {
+		return nullptr;
+	}
+	return &array->items[index];
+}
+
+// reads a member that is a count or an index, or fallback when there is none; false if the member
+// is there but is not a whole number that fits
+static bool readCount(const JsonValue* object, const char* key, size_t fallback, size_t &count) {
+	const JsonValue* member = findMember(object, key);
+	if (member == nullptr) {
+		count = fallback;
+		return true;
+	}
+	if (member->type != JSON_NUMBER || member->number < 0.0 || member->number > 4.0e15 || member->number != floor(member->number)) {
+		return false;
+	}
+	count = (size_t)member->number;
+	return true;
+}
+
+static std::string readString(const JsonValue* object, const char* key) {
+	const JsonValue* member = findMember(object, key);
+	return member != nullptr && member->type == JSON_STRING ? member->string : std::string();
+}
+
+static unsigned int componentSize(size_t componentType) {
+	switch (componentType) {
+	case GLB_BYTE: case GLB_UNSIGNED_BYTE: return 1;
+	case GLB_SHORT: case GLB_UNSIGNED_SHORT: return 2;
+	case GLB_UNSIGNED_INT: case GLB_FLOAT: return 4;
+	default: return 0;
+	}
+}
+
+// matrices are never vertex attributes or indices, so they are left unsupported
+static unsigned int typeComponents(const std::string &type) {
+	if (type == "SCALAR") {
+		return 1;
+	}
+	if (type == "VEC2") {
+		return 2;
+	}
+	if (type == "VEC3") {
+		return 3;
+	}
+	if (type == "VEC4") {
+		return 4;
+	}
+	return 0;
+}
+
+static uint32_t readWord(const char* p) {
+	uint32_t word;
+	memcpy(&word, p, sizeof(word));
+	return word;
+}
+
+// decodes the %XX escapes of a relative uri into the filename it names
+static std::string decodeUri(const std::string &uri) {
+	std::string decoded;
+	for (size_t i = 0; i < uri.size(); i++) {
+		if (uri[i] == '%' && i + 2 < uri.size() && hexDigit(uri[i + 1]) >= 0 && hexDigit(uri[i + 2]) >= 0) {
+			decoded.push_back((char)(hexDigit(uri[i + 1]) * 16 + hexDigit(uri[i + 2])));
+			i += 2;
+		} else {
+			decoded.push_back(uri[i]);
+		}
+	}
+	return decoded;
+}
+
+// resolves an accessor to the bytes it covers in the BIN chunk, checking that every element lies
+// inside its buffer view, and the view inside the chunk
+static bool readAccessor(const JsonValue &root, const unsigned char* bin, const size_t binSize, const size_t index,
+	GlbAccessor &accessor, std::string &error) {
+	const JsonValue* object = findItem(findMember(&root, "accessors"), index);
+	if (object == nullptr) {
+		error = "accessor " + std::to_string(index) + " does not exist";
+		return false;
+	}
+	if (findMember(object, "sparse") != nullptr) {
+		error = "sparse accessors are not supported";
+		return false;
+	}
+
+	size_t componentType, count, viewIndex, accessorOffset;
+	if (!readCount(object, "componentType", 0, componentType) || !readCount(object, "count", 0, count)
+		|| !readCount(object, "bufferView", (size_t)-1, viewIndex) || !readCount(object, "byteOffset", 0, accessorOffset)) {
+		error = "accessor " + std::to_string(index) + " is malformed";
+		return false;
+	}
+	const JsonValue* normalized = findMember(object, "normalized");
+	accessor.componentType = (unsigned int)componentType;
+	accessor.components = typeComponents(readString(object, "type"));
+	accessor.normalized = normalized != nullptr && normalized->type == JSON_BOOLEAN && normalized->boolean;
+	accessor.count = count;
+	size_t elementSize = (size_t)componentSize(componentType) * accessor.components;
+	if (elementSize == 0) {
+		error = "accessor " + std::to_string(index) + " has an unsupported type";
+		return false;
+	}
+	if (viewIndex == (size_t)-1) {
+		error = "accessors without a buffer view are not supported";
+		return false;
+	}
+
+	const JsonValue* view = findItem(findMember(&root, "bufferViews"), viewIndex);
+	size_t bufferIndex, viewOffset, viewLength, viewStride;
+	if (view == nullptr || !readCount(view, "buffer", (size_t)-1, bufferIndex) || !readCount(view, "byteOffset", 0, viewOffset)
+		|| !readCount(view, "byteLength", (size_t)-1, viewLength) || !readCount(view, "byteStride", 0, viewStride)
+		|| viewLength == (size_t)-1 || (viewStride != 0 && (viewStride < elementSize || viewStride > glbMaxStride))) {
+		error = "buffer view " + std::to_string(viewIndex) + " is missing or malformed";
+		return false;
+	}
+	// a GLB's own data is its first buffer, the one without a uri
+	const JsonValue* buffer = findItem(findMember(&root, "buffers"), bufferIndex);
+	if (buffer == nullptr || bufferIndex != 0 || findMember(buffer, "uri") != nullptr || bin == nullptr) {
+		error = "only the GLB's embedded buffer is supported";
+		return false;
+	}
+	if (viewOffset > binSize || viewLength > binSize - viewOffset) {
+		error = "buffer view " + std::to_string(viewIndex) + " runs past the BIN chunk";
+		return false;
+	}
+
+	accessor.stride = viewStride != 0 ? viewStride : elementSize;
+	if (accessorOffset > viewLength || (count > 0 && (count > viewLength
+		|| (count - 1) * accessor.stride + elementSize > viewLength - accessorOffset))) {
+		error = "accessor " + std::to_string(index) + " runs past its buffer view";
+		return false;
+	}
+	accessor.data = bin + viewOffset + accessorOffset;
+	return true;
+}
+
+// reads the optional attribute of a primitive into accessor, which is left empty without it
+static bool readAttribute(const JsonValue &root, const unsigned char* bin, const size_t binSize, const JsonValue* attributes,
+	const char* name, GlbAccessor &accessor, std::string &error) {
+	memset(&accessor, 0, sizeof(accessor));
+	size_t index;
+	if (!readCount(attributes, name, (size_t)-1, index)) {
+		error = std::string("attribute ") + name + " is malformed";
+		return false;
+	}
+	return index == (size_t)-1 || readAccessor(root, bin, binSize, index, accessor, error);
+}
+
+static bool readPrimitive(const JsonValue &root, const unsigned char* bin, const size_t binSize, const JsonValue* object,
+	GlbPrimitive &primitive, std::string &error) {
+	const JsonValue* attributes = findMember(object, "attributes");
+	size_t material;
+	if (!readAttribute(root, bin, binSize, attributes, "POSITION", primitive.positions, error)
+		|| !readAttribute(root, bin, binSize, attributes, "TEXCOORD_0", primitive.textureCoords, error)
+		|| !readAttribute(root, bin, binSize, attributes, "NORMAL", primitive.normals, error)
+		|| !readAttribute(root, bin, binSize, object, "indices", primitive.indices, error)) {
+		return false;
+	}
+	if (!readCount(object, "material", (size_t)-1, material) || (material != (size_t)-1 && findItem(findMember(&root, "materials"), material) == nullptr)) {
+		error = "a primitive has a malformed material";
+		return false;
+	}
+	primitive.material = material == (size_t)-1 ? -1 : (int)material;
+
+	size_t numVertices = primitive.positions.count;
+	if ((primitive.positions.data != nullptr && primitive.positions.components != 3)
+		|| (primitive.textureCoords.data != nullptr && (primitive.textureCoords.components != 2 || primitive.textureCoords.count != numVertices))
+		|| (primitive.normals.data != nullptr && (primitive.normals.components != 3 || primitive.normals.count != numVertices))) {
+		error = "a primitive's attributes do not match";
+		return false;
+	}
+	if (primitive.indices.data != nullptr) {
+		if (primitive.indices.components != 1 || primitive.indices.normalized || (primitive.indices.componentType != GLB_UNSIGNED_BYTE
+			&& primitive.indices.componentType != GLB_UNSIGNED_SHORT && primitive.indices.componentType != GLB_UNSIGNED_INT)) {
+			error = "a primitive's indices are not unsigned integers";
+			return false;
+		}
+		for (size_t i = 0; i < primitive.indices.count; i++) {
+			if (readGlbIndex(primitive.indices, i) >= numVertices) {
+				error = "a primitive indexes past its vertices";
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+static void readMaterial(const JsonValue &root, const JsonValue* object, GlbMaterial &material) {
+	material.name = readString(object, "name");
+	for (int c = 0; c < 4; c++) {
+		material.baseColour[c] = 1.0f;
+	}
+	material.baseColourTexture.clear();
+
+	const JsonValue* pbr = findMember(object, "pbrMetallicRoughness");
+	const JsonValue* factor = findMember(pbr, "baseColorFactor");
+	for (int c = 0; c < 4; c++) {
+		const JsonValue* component = findItem(factor, c);
+		if (component != nullptr && component->type == JSON_NUMBER) {
+			material.baseColour[c] = (float)component->number;
+		}
+	}
+
+	// embedded images (in a buffer view, or a data: uri) have no file to hand on
+	size_t textureIndex, imageIndex;
+	const JsonValue* textureInfo = findMember(pbr, "baseColorTexture");
+	if (textureInfo == nullptr || !readCount(textureInfo, "index", (size_t)-1, textureIndex)) {
+		return;
+	}
+	const JsonValue* texture = findItem(findMember(&root, "textures"), textureIndex);
+	if (texture == nullptr || !readCount(texture, "source", (size_t)-1, imageIndex)) {
+		return;
+	}
+	std::string uri = readString(findItem(findMember(&root, "images"), imageIndex), "uri");
+	if (!uri.empty() && uri.compare(0, 5, "data:") != 0) {
+		material.baseColourTexture = decodeUri(uri);
+	}
+}
+
+bool readGlb(const char* data, const size_t size, GlbContents &contents, std::string &error) {
+	contents.primitives.clear();
+	contents.materials.clear();
+
+	// the header, the JSON chunk, and the BIN chunk if there is one
+	if (size < glbHeaderSize + glbChunkHeaderSize || readWord(data) != glbMagic) {
+		error = "not a GLB file";
+		return false;
+	}
+	size_t length = readWord(data + 8);
+	if (readWord(data + 4) != glbVersion || length > size || length < glbHeaderSize + glbChunkHeaderSize) {
+		error = "not a glTF 2.0 binary, or truncated";
+		return false;
+	}
+	size_t jsonLength = readWord(data + glbHeaderSize);
+	if (readWord(data + glbHeaderSize + 4) != glbChunkJson || jsonLength > length - glbHeaderSize - glbChunkHeaderSize) {
+		error = "the JSON chunk is missing or truncated";
+		return false;
+	}
+	const char* json = data + glbHeaderSize + glbChunkHeaderSize;
+	const unsigned char* bin = nullptr;
+	size_t binSize = 0;
+	size_t binChunk = glbHeaderSize + glbChunkHeaderSize + jsonLength;
+	if (length - binChunk >= glbChunkHeaderSize && readWord(data + binChunk + 4) == glbChunkBin) {
+		binSize = readWord(data + binChunk);
+		bin = (const unsigned char*)data + binChunk + glbChunkHeaderSize;
+		if (binSize > length - binChunk - glbChunkHeaderSize) {
+			error = "the BIN chunk is truncated";
+			return false;
+		}
+	}
+
+	JsonValue root;
+	const char* p = json;
+	if (!parseJsonValue(p, json + jsonLength, 0, root) || root.type != JSON_OBJECT) {
+		error = "the JSON chunk is malformed";
+		return false;
+	}
+
+	// quantised attributes are converted on load; anything else a file requires would be misread
+	const JsonValue* required = findMember(&root, "extensionsRequired");
+	for (size_t e = 0; required != nullptr && e < required->items.size(); e++) {
+		if (required->items[e].string != "KHR_mesh_quantization") {
+			error = "the file requires " + required->items[e].string;
+			return false;
+		}
+	}
+
+	const JsonValue* materials = findMember(&root, "materials");
+	for (size_t m = 0; materials != nullptr && m < materials->items.size(); m++) {
+		GlbMaterial material;
+		readMaterial(root, &materials->items[m], material);
+		contents.materials.push_back(material);
+	}
+
+	const JsonValue* meshes = findMember(&root, "meshes");
+	for (size_t m = 0; meshes != nullptr && m < meshes->items.size(); m++) {
+		const JsonValue* primitives = findMember(&meshes->items[m], "primitives");
+		for (size_t i = 0; primitives != nullptr && i < primitives->items.size(); i++) {
+			const JsonValue* object = &primitives->items[i];
+			size_t mode;
+			if (!readCount(object, "mode", glbModeTriangles, mode)) {
+				error = "a primitive has a malformed mode";
+				return false;
+			}
+			if (mode != glbModeTriangles) {
+				continue;
+			}
+			GlbPrimitive primitive;
+			primitive.mesh = readString(&meshes->items[m], "name");
+			if (!readPrimitive(root, bin, binSize, object, primitive, error)) {
+				return false;
+			}
+			if (primitive.positions.data != nullptr) {
+				contents.primitives.push_back(primitive);
+			}
+		}
+	}
+	return true;
+}
+
+unsigned int readGlbIndex(const GlbAccessor &indices, const size_t element) {
+	const unsigned char* p = indices.data + element * indices.stride;
+	if (indices.componentType == GLB_UNSIGNED_BYTE) {
+		return p[0];
+	}
+	if (indices.componentType == GLB_UNSIGNED_SHORT) {
+		uint16_t index;
+		memcpy(&index, p, sizeof(index));
+		return index;
+	}
+	uint32_t index;
+	memcpy(&index, p, sizeof(index));
+	return index;
+}
+
+void readGlbFloats(const GlbAccessor &accessor, const size_t element, float* values) {
+	const unsigned char* p = accessor.data + element * accessor.stride;
+	for (unsigned int c = 0; c < accessor.components; c++) {
+		switch (accessor.componentType) {
+		case GLB_BYTE: {
+			int8_t value;
+			memcpy(&value, p + c, sizeof(value));
+			values[c] = accessor.normalized ? std::max(value / 127.0f, -1.0f) : (float)value;
+			break;
+		}
+		case GLB_UNSIGNED_BYTE:
+			values[c] = accessor.normalized ? p[c] / 255.0f : (float)p[c];
+			break;
+		case GLB_SHORT: {
+			int16_t value;
+			memcpy(&value, p + c * sizeof(value), sizeof(value));
+			values[c] = accessor.normalized ? std::max(value / 32767.0f, -1.0f) : (float)value;
+			break;
+		}
+		case GLB_UNSIGNED_SHORT: {
+			uint16_t value;
+			memcpy(&value, p + c * sizeof(value), sizeof(value));
+			values[c] = accessor.normalized ? value / 65535.0f : (float)value;
+			break;
+		}
+		case GLB_UNSIGNED_INT: {
+			uint32_t value;
+			memcpy(&value, p + c * sizeof(value), sizeof(value));
+			values[c] = (float)value;
+			break;
+		}
+		default:
+			memcpy(&values[c], p + c * sizeof(float), sizeof(float));
+			break;
+		}
+	}
+}
+
+bool isGlbFilename(const std::string &filename) {
+	if (filename.size() < 4) {
+		return false;
+	}
+	std::string extension = filename.substr(filename.size() - 4);
+	for (size_t i = 0; i < extension.size(); i++) {
+		extension[i] = (char)tolower((unsigned char)extension[i]);
+	}
+	return extension == ".glb";
+}
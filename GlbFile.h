@@ -0,0 +1,72 @@
+#include <string>
+#include <vector>
+#include <cstddef>
+
+#pragma once
+
+// the component types of glTF accessors, which are the GL enums of the same names
+#define GLB_BYTE 5120
+#define GLB_UNSIGNED_BYTE 5121
+#define GLB_SHORT 5122
+#define GLB_UNSIGNED_SHORT 5123
+#define GLB_UNSIGNED_INT 5125
+#define GLB_FLOAT 5126
+
+// an accessor of a glTF binary: count elements of components values each, the first at data,
+// inside the file's BIN chunk, and each stride bytes after the one before. data is null for an
+// attribute the primitive does not have.
+struct GlbAccessor {
+	const unsigned char* data;
+	size_t count;
+	size_t stride;
+	unsigned int componentType;
+	unsigned int components;
+	bool normalized;
+};
+typedef struct GlbAccessor GlbAccessor;
+
+// a triangle list of one of the file's meshes; indices has no data for an unindexed primitive,
+// and material is -1 for one without a material
+struct GlbPrimitive {
+	std::string mesh;
+	GlbAccessor positions;
+	GlbAccessor textureCoords;
+	GlbAccessor normals;
+	GlbAccessor indices;
+	int material;
+};
+typedef struct GlbPrimitive GlbPrimitive;
+
+// what ObjMesh can use of a glTF material: its name, the base colour factor, and the uri of the
+// base colour texture's image when it is a file of its own rather than embedded
+struct GlbMaterial {
+	std::string name;
+	float baseColour[4];
+	std::string baseColourTexture;
+};
+typedef struct GlbMaterial GlbMaterial;
+
+struct GlbContents {
+	std::vector<GlbPrimitive> primitives;
+	std::vector<GlbMaterial> materials;
+};
+typedef struct GlbContents GlbContents;
+
+// reads the triangle primitives of every mesh, and the materials, of a glTF 2.0 binary (.glb) in
+// memory, leaving the vertex and index data where it is: the accessors point into data, which
+// must outlive them. Every accessor is checked to lie within its buffer view and the BIN chunk,
+// and every index to name a vertex of its primitive. Node transforms are not applied, and points
+// and lines are skipped. Fails, with the reason in error, if the file is not a GLB, is malformed,
+// or needs what this reader lacks: sparse accessors, external buffers, or a required extension
+// other than KHR_mesh_quantization.
+bool readGlb(const char* data, const size_t size, GlbContents &contents, std::string &error);
+
+// index element of an indices accessor, whatever its width
+unsigned int readGlbIndex(const GlbAccessor &indices, const size_t element);
+
+// element of an attribute accessor as floats, one per component, converting integers as glTF
+// defines: normalised ones to [0, 1] or [-1, 1], and the rest (quantised attributes) by value
+void readGlbFloats(const GlbAccessor &accessor, const size_t element, float* values);
+
+// whether a filename has the .glb extension, in any case
+bool isGlbFilename(const std::string &filename);
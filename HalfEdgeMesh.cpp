@@ -0,0 +1,177 @@
+#include <vector>
+#include <cstdint>
+#include <cstring>
+
+#include "HalfEdgeMesh.h"
+#include "Parallel.h"
+#include "MemoryArena.h"
+
+// half-edges and vertices are handed to threads in runs of at least this many
+static const size_t minHalfEdgesPerThread = 1 << 14;
+static const size_t minVerticesPerThread = 1 << 14;
+
+// a position's bits, with -0 taken as 0 so the two join
+static inline void positionKey(const float* position, uint32_t* key) {
+	for (int axis = 0; axis < 3; axis++) {
+		float value = position[axis] + 0.0f;
+		memcpy(&key[axis], &value, sizeof(uint32_t));
+	}
+}
+
+static inline uint32_t hashPositionKey(const uint32_t* key) {
+	uint32_t hash = 2166136261u;
+	for (int i = 0; i < 3; i++) {
+		hash = (hash ^ key[i]) * 16777619u;
+	}
+	return hash ^ (hash >> 15);
+}
+
+// maps every vertex to the lowest-numbered vertex at its position, returning how many positions there are
+static size_t joinPositions(const float* positions, const size_t numVertices, MemoryArena &arena,
+	std::vector<unsigned int> &positionIds) {
+	size_t tableSize = 1;
+	while (tableSize < numVertices * 2) {
+		tableSize *= 2;
+	}
+	const unsigned int empty = HALF_EDGE_NONE;
+	unsigned int* table = arena.allocate<unsigned int>(tableSize);
+	for (size_t i = 0; i < tableSize; i++) {
+		table[i] = empty;
+	}
+
+	positionIds.resize(numVertices);
+	size_t numPositions = 0;
+	for (size_t v = 0; v < numVertices; v++) {
+		uint32_t key[3];
+		positionKey(positions + v * 3, key);
+		size_t slot = hashPositionKey(key) & (tableSize - 1);
+
+		while (table[slot] != empty) {
+			uint32_t other[3];
+			positionKey(positions + (size_t)table[slot] * 3, other);
+			if (memcmp(key, other, sizeof(key)) == 0) {
+				break;
+			}
+			slot = (slot + 1) & (tableSize - 1);
+		}
+
+		if (table[slot] == empty) {
+			table[slot] = (unsigned int)v;
+			numPositions++;
+		}
+		positionIds[v] = table[slot];
+	}
+	return numPositions;
+}
+
+void buildHalfEdgeMesh(const unsigned int* indices, const size_t numIndices, const float* positions,
+	const size_t numVertices, const unsigned int numThreads, HalfEdgeMesh &mesh) {
+	size_t numHalfEdges = numIndices - numIndices % 3;
+	unsigned int threads = resolveThreadCount(numThreads);
+	MemoryArena arena;
+
+	mesh.numPositions = joinPositions(positions, numVertices, arena, mesh.positionIds);
+	const unsigned int* positionIds = mesh.positionIds.data();
+
+	mesh.vertices.resize(numHalfEdges);
+	unsigned int* vertices = mesh.vertices.data();
+	parallelFor(threads, numHalfEdges, minHalfEdgesPerThread, [&](unsigned int, size_t begin, size_t end) {
+		for (size_t h = begin; h < end; h++) {
+			vertices[h] = positionIds[indices[h]];
+		}
+	});
+
+	// the half-edges leaving each vertex: outgoing[firstOutgoing[v]] up to outgoing[firstOutgoing[v + 1]].
+	// Every thread reads all the half-edges but only counts, and places, those leaving its own vertices.
+	unsigned int* firstOutgoing = arena.allocate<unsigned int>(numVertices + 1);
+	unsigned int* outgoing = arena.allocate<unsigned int>(numHalfEdges);
+	firstOutgoing[0] = 0;
+	parallelFor(threads, numVertices, minVerticesPerThread, [&](unsigned int, size_t begin, size_t end) {
+		memset(firstOutgoing + begin + 1, 0, (end - begin) * sizeof(unsigned int));
+		for (size_t h = 0; h < numHalfEdges; h++) {
+			if (vertices[h] >= begin && vertices[h] < end) {
+				firstOutgoing[vertices[h] + 1]++;
+			}
+		}
+	});
+	for (size_t v = 0; v < numVertices; v++) {
+		firstOutgoing[v + 1] += firstOutgoing[v];
+	}
+	unsigned int* cursors = arena.allocate<unsigned int>(numVertices);
+	parallelFor(threads, numVertices, minVerticesPerThread, [&](unsigned int, size_t begin, size_t end) {
+		memcpy(cursors + begin, firstOutgoing + begin, (end - begin) * sizeof(unsigned int));
+		for (size_t h = 0; h < numHalfEdges; h++) {
+			if (vertices[h] >= begin && vertices[h] < end) {
+				outgoing[cursors[vertices[h]]++] = (unsigned int)h;
+			}
+		}
+	});
+
+	// a half-edge from v to w pairs with the one half-edge from w to v, as long as it is also the
+	// only one from v to w; each thread writes the twins of the half-edges leaving its own vertices
+	mesh.twins.resize(numHalfEdges);
+	mesh.vertexEdges.resize(numVertices);
+	unsigned int* twins = mesh.twins.data();
+	unsigned int* vertexEdges = mesh.vertexEdges.data();
+	std::vector<size_t> borderEdges(threads, 0);
+	std::vector<size_t> nonManifoldHalfEdges(threads, 0);
+	parallelFor(threads, numVertices, minVerticesPerThread, [&](unsigned int thread, size_t begin, size_t end) {
+		for (size_t v = begin; v < end; v++) {
+			vertexEdges[v] = HALF_EDGE_NONE;
+			for (unsigned int i = firstOutgoing[v]; i < firstOutgoing[v + 1]; i++) {
+				unsigned int h = outgoing[i];
+				unsigned int w = vertices[nextHalfEdge(h)];
+				twins[h] = HALF_EDGE_NONE;
+				if (w == v) {
+					nonManifoldHalfEdges[thread]++;
+					continue;
+				}
+
+				unsigned int numAlong = 0;
+				for (unsigned int j = firstOutgoing[v]; j < firstOutgoing[v + 1]; j++) {
+					numAlong += vertices[nextHalfEdge(outgoing[j])] == w;
+				}
+				unsigned int numAgainst = 0;
+				unsigned int twin = HALF_EDGE_NONE;
+				for (unsigned int j = firstOutgoing[w]; j < firstOutgoing[w + 1]; j++) {
+					if (vertices[nextHalfEdge(outgoing[j])] == v) {
+						twin = outgoing[j];
+						numAgainst++;
+					}
+				}
+
+				if (numAlong == 1 && numAgainst == 1) {
+					twins[h] = twin;
+				} else if (numAlong == 1 && numAgainst == 0) {
+					borderEdges[thread]++;
+				} else {
+					nonManifoldHalfEdges[thread]++;
+				}
+			}
+
+			// a border half-edge starts the ring, if there is one
+			if (firstOutgoing[v] < firstOutgoing[v + 1]) {
+				vertexEdges[v] = outgoing[firstOutgoing[v]];
+			}
+			for (unsigned int i = firstOutgoing[v]; i < firstOutgoing[v + 1]; i++) {
+				unsigned int h = outgoing[i];
+				if (twins[h] == HALF_EDGE_NONE && vertices[nextHalfEdge(h)] != v) {
+					vertexEdges[v] = h;
+					break;
+				}
+			}
+		}
+	});
+
+	mesh.numBorderEdges = 0;
+	mesh.numNonManifoldHalfEdges = 0;
+	for (unsigned int t = 0; t < threads; t++) {
+		mesh.numBorderEdges += borderEdges[t];
+		mesh.numNonManifoldHalfEdges += nonManifoldHalfEdges[t];
+	}
+}
+
+size_t getHalfEdgeMemory(const HalfEdgeMesh &mesh) {
+	return (mesh.vertices.capacity() + mesh.twins.capacity() + mesh.positionIds.capacity() + mesh.vertexEdges.capacity())
+		* sizeof(unsigned int);
+}
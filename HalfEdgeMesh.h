@@ -0,0 +1,72 @@
+#include <vector>
+#include <cstddef>
+
+#pragma once
+
+// the twin of a half-edge without one, and the edge of a vertex no triangle uses
+#define HALF_EDGE_NONE 0xffffffffu
+
+// the connectivity of an indexed triangle list as half-edges in flat arrays. Half-edge h is
+// corner h of the list: it belongs to triangle h / 3 and runs from that corner to the next one
+// of the triangle, so next, previous and the triangle need no storage, and indices[h] still
+// gives the vertex whose attributes the corner uses.
+//
+// Connectivity is by position rather than by vertex, so the vertices an attribute seam splits
+// (e.g. by texture coordinate) stay joined: every vertex belongs to the lowest-numbered vertex
+// at its position, which stands for all of them in vertices and vertexEdges.
+struct HalfEdgeMesh {
+	// per half-edge: the position vertex it leaves, and the half-edge running the other way
+	// along the same edge, or HALF_EDGE_NONE on a border (or an edge of more than two triangles,
+	// or of two that disagree on their winding)
+	std::vector<unsigned int> vertices;
+	std::vector<unsigned int> twins;
+	// per vertex: the vertex standing for its position
+	std::vector<unsigned int> positionIds;
+	// per position vertex: one half-edge leaving it, a border one if it has any, so a walk of its
+	// ring from there sees the whole fan (one of them, where several fans meet at the vertex);
+	// HALF_EDGE_NONE for the other vertices
+	std::vector<unsigned int> vertexEdges;
+	size_t numPositions;
+	// how many edges have a single triangle, and how many half-edges were left without a twin
+	// for lying on an edge of more than two triangles, or of two that disagree on their winding,
+	// or of a triangle with two corners at one position
+	size_t numBorderEdges;
+	size_t numNonManifoldHalfEdges;
+};
+typedef struct HalfEdgeMesh HalfEdgeMesh;
+
+// builds the half-edges of numIndices / 3 triangles over numVertices vertices (three floats of
+// positions each). Positions are joined on the calling thread; the half-edges are grouped by the
+// vertex they leave, paired with their twins and the vertex edges chosen on numThreads threads,
+// each owning a range of vertices, so none of it needs atomics.
+void buildHalfEdgeMesh(const unsigned int* indices, const size_t numIndices, const float* positions,
+	const size_t numVertices, const unsigned int numThreads, HalfEdgeMesh &mesh);
+
+// the bytes the mesh holds
+size_t getHalfEdgeMemory(const HalfEdgeMesh &mesh);
+
+static inline unsigned int nextHalfEdge(const unsigned int h) {
+	return h % 3 == 2 ? h - 2 : h + 1;
+}
+
+static inline unsigned int previousHalfEdge(const unsigned int h) {
+	return h % 3 == 0 ? h + 2 : h - 1;
+}
+
+// the position vertex a half-edge arrives at
+static inline unsigned int halfEdgeTarget(const HalfEdgeMesh &mesh, const unsigned int h) {
+	return mesh.vertices[nextHalfEdge(h)];
+}
+
+// the next half-edge leaving the same vertex, turning the way the triangles wind, or
+// HALF_EDGE_NONE at a border. Around an inner vertex it comes back to where it started:
+//
+//   unsigned int first = mesh.vertexEdges[v];
+//   for (unsigned int h = first; h != HALF_EDGE_NONE;) {
+//       ... halfEdgeTarget(mesh, h) is a neighbour of v, and h / 3 a triangle around it ...
+//       h = nextRingHalfEdge(mesh, h);
+//       if (h == first) break;
+//   }
+static inline unsigned int nextRingHalfEdge(const HalfEdgeMesh &mesh, const unsigned int h) {
+	return mesh.twins[previousHalfEdge(h)];
+}
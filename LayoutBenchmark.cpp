@@ -0,0 +1,209 @@
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+#include "ObjMesh.h"
+#include "VertexLayout.h"
+#include "VertexQuantization.h"
+
+// a headless benchmark of the vertex layouts main can upload: every attribute in its own array,
+// or all of them interleaved in one, each in the float and the quantised formats. It walks the
+// index buffer the way a GPU's vertex fetch does, reading every attribute of each vertex, once in
+// the mesh's optimised order and once with the triangles shuffled, which is what a mesh that
+// never went through the optimisers looks like.
+//
+// usage: layoutbench [mesh.obj]   (meshes/newHead.obj by default)
+
+// how long to keep repeating each measurement, of which the fastest pass counts
+static const double minSeconds = 0.25;
+static const int minPasses = 3;
+static const size_t cacheLineSize = 64;
+
+// where one attribute of vertex v lives: data + v * stride
+struct FetchStream {
+	const unsigned char* data;
+	size_t stride;
+	unsigned int size;
+};
+typedef struct FetchStream FetchStream;
+
+// the attributes of one layout, either in separate arrays or at the offsets of one interleaved array
+struct FetchLayout {
+	std::string name;
+	FetchStream streams[VERTEX_NUM_ATTRIBUTES];
+	unsigned int bytesPerVertex;
+	bool interleaved;
+};
+typedef struct FetchLayout FetchLayout;
+
+static FetchLayout separateLayout(const std::string name, const VertexLayout &layout, const void* const* attributes) {
+	FetchLayout fetch;
+	fetch.name = name;
+	fetch.bytesPerVertex = layout.stride;
+	fetch.interleaved = false;
+	for (int a = 0; a < VERTEX_NUM_ATTRIBUTES; a++) {
+		fetch.streams[a].data = (const unsigned char*)attributes[a];
+		fetch.streams[a].stride = layout.attributes[a].size;
+		fetch.streams[a].size = layout.attributes[a].size;
+	}
+	return fetch;
+}
+
+static FetchLayout interleavedLayout(const std::string name, const VertexLayout &layout, const unsigned char* vertices) {
+	FetchLayout fetch;
+	fetch.name = name;
+	fetch.bytesPerVertex = layout.stride;
+	fetch.interleaved = true;
+	for (int a = 0; a < VERTEX_NUM_ATTRIBUTES; a++) {
+		fetch.streams[a].data = vertices + layout.attributes[a].offset;
+		fetch.streams[a].stride = layout.stride;
+		fetch.streams[a].size = layout.attributes[a].size;
+	}
+	return fetch;
+}
+
+// reads every attribute of every indexed vertex, summing its words so the reads cannot be skipped;
+// both kinds of layout run exactly this loop, so only where the bytes live differs
+static uint32_t fetchVertices(const FetchLayout &layout, const unsigned int* indices, const size_t numIndices) {
+	uint32_t sum = 0;
+	for (size_t i = 0; i < numIndices; i++) {
+		size_t v = indices[i];
+		for (int a = 0; a < VERTEX_NUM_ATTRIBUTES; a++) {
+			const FetchStream &stream = layout.streams[a];
+			const unsigned char* attribute = stream.data + v * stream.stride;
+			for (unsigned int w = 0; w < stream.size; w += 4) {
+				uint32_t word;
+				memcpy(&word, attribute + w, sizeof(word));
+				sum += word;
+			}
+		}
+	}
+	return sum;
+}
+
+// the fastest pass over the indices, in nanoseconds per index
+static double timeFetch(const FetchLayout &layout, const std::vector<unsigned int> &indices, uint32_t &checksum) {
+	typedef std::chrono::steady_clock Clock;
+	double best = 0.0;
+	double total = 0.0;
+	for (int pass = 0; pass < minPasses || total < minSeconds; pass++) {
+		Clock::time_point start = Clock::now();
+		checksum = fetchVertices(layout, indices.data(), indices.size());
+		double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+		best = pass == 0 || seconds < best ? seconds : best;
+		total += seconds;
+	}
+	return best * 1e9 / (double)indices.size();
+}
+
+// the cache lines a vertex's attributes span, averaged over the vertices, assuming every array
+// starts on a line; attributes of an interleaved vertex that share a line count once
+static double linesPerVertex(const FetchLayout &layout, const size_t numVertices) {
+	size_t lines = 0;
+	for (size_t v = 0; v < numVertices; v++) {
+		size_t lastLine = (size_t)-1;
+		for (int a = 0; a < VERTEX_NUM_ATTRIBUTES; a++) {
+			const FetchStream &stream = layout.streams[a];
+			if (stream.size == 0) {
+				continue;
+			}
+			size_t base = layout.interleaved ? (size_t)(stream.data - layout.streams[0].data) : 0;
+			size_t first = (base + v * stream.stride) / cacheLineSize;
+			size_t last = (base + v * stream.stride + stream.size - 1) / cacheLineSize;
+			if (!layout.interleaved || first != lastLine) {
+				lines += last - first + 1;
+			} else {
+				lines += last - first;
+			}
+			lastLine = last;
+		}
+	}
+	return numVertices > 0 ? (double)lines / (double)numVertices : 0.0;
+}
+
+int main(int argc, char** argv) {
+	std::string filename = argc > 1 ? argv[1] : "meshes/newHead.obj";
+
+	// the same processing main gives the head, minus the cache, so a run leaves no files behind
+	ObjMesh mesh;
+	mesh.setWeldVertices(true);
+	mesh.setOptimizeVertexCache(true);
+	mesh.setOptimizeVertexFetch(true);
+	mesh.setInterleaveVertices(true);
+	mesh.load(filename, true, true);
+
+	size_t numVertices = mesh.getNumVertices();
+	if (numVertices == 0 || mesh.getInterleavedVertices() == nullptr) {
+		std::cerr << "No vertices in " << filename.c_str() << std::endl;
+		return 1;
+	}
+
+	const void* floatAttributes[VERTEX_NUM_ATTRIBUTES];
+	floatAttributes[VERTEX_POSITION] = mesh.getIndexedPositions();
+	floatAttributes[VERTEX_TEXTURE_COORDS] = mesh.getIndexedTextureCoords();
+	floatAttributes[VERTEX_NORMAL] = mesh.getIndexedNormals();
+	floatAttributes[VERTEX_TANGENT] = mesh.getIndexedTangents();
+
+	QuantizedVertices quantized;
+	quantizeVertices((const float*)mesh.getIndexedPositions(), (const float*)mesh.getIndexedTextureCoords(),
+		(const float*)mesh.getIndexedNormals(), (const float*)mesh.getIndexedTangents(), numVertices, quantized);
+	const void* quantizedAttributes[VERTEX_NUM_ATTRIBUTES];
+	quantizedAttributes[VERTEX_POSITION] = quantized.positions.data();
+	quantizedAttributes[VERTEX_TEXTURE_COORDS] = quantized.textureCoords.data();
+	quantizedAttributes[VERTEX_NORMAL] = quantized.normals.data();
+	quantizedAttributes[VERTEX_TANGENT] = quantized.tangents.data();
+
+	VertexLayout quantizedLayout = quantizedVertexLayout();
+	std::vector<unsigned char> quantizedVertices(numVertices * quantizedLayout.stride);
+	interleaveVertices(quantizedLayout, quantizedAttributes, numVertices, quantizedVertices.data());
+
+	FetchLayout layouts[4];
+	layouts[0] = separateLayout("float, separate", mesh.getVertexLayout(), floatAttributes);
+	layouts[1] = interleavedLayout("float, interleaved", mesh.getVertexLayout(), mesh.getInterleavedVertices());
+	layouts[2] = separateLayout("quantized, separate", quantizedLayout, quantizedAttributes);
+	layouts[3] = interleavedLayout("quantized, interleaved", quantizedLayout, quantizedVertices.data());
+
+	// the optimised order, and the same triangles in a random order
+	std::vector<unsigned int> optimized(mesh.getTriangleIndices(), mesh.getTriangleIndices() + mesh.getNumIndexedVertices());
+	std::vector<unsigned int> triangleOrder(optimized.size() / 3);
+	for (size_t t = 0; t < triangleOrder.size(); t++) {
+		triangleOrder[t] = (unsigned int)t;
+	}
+	std::shuffle(triangleOrder.begin(), triangleOrder.end(), std::mt19937(1));
+	std::vector<unsigned int> shuffled(triangleOrder.size() * 3);
+	for (size_t t = 0; t < triangleOrder.size(); t++) {
+		for (int c = 0; c < 3; c++) {
+			shuffled[t * 3 + c] = optimized[triangleOrder[t] * 3 + c];
+		}
+	}
+
+	std::cout << numVertices << " vertices, " << optimized.size() << " indices" << std::endl;
+	std::cout << std::left << std::setw(24) << "layout" << std::right << std::setw(8) << "bytes"
+		<< std::setw(8) << "lines" << std::setw(14) << "optimised ns" << std::setw(14) << "shuffled ns" << std::endl;
+
+	// the interleaved layouts must read exactly what the separate ones of their format do
+	uint32_t checksums[4];
+	bool matched = true;
+	for (int l = 0; l < 4; l++) {
+		uint32_t shuffledChecksum;
+		double optimizedTime = timeFetch(layouts[l], optimized, checksums[l]);
+		double shuffledTime = timeFetch(layouts[l], shuffled, shuffledChecksum);
+		matched = matched && shuffledChecksum == checksums[l] && (l % 2 == 0 || checksums[l] == checksums[l - 1]);
+
+		std::cout << std::left << std::setw(24) << layouts[l].name << std::right << std::setw(8) << layouts[l].bytesPerVertex
+			<< std::setw(8) << std::fixed << std::setprecision(2) << linesPerVertex(layouts[l], numVertices)
+			<< std::setw(14) << optimizedTime << std::setw(14) << shuffledTime << std::endl;
+	}
+
+	if (!matched) {
+		std::cerr << "The interleaved vertices differ from the separate ones" << std::endl;
+		return 1;
+	}
+	return 0;
+}
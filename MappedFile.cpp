@@ -0,0 +1,156 @@
+#ifdef _WIN32
+#  define WIN32_LEAN_AND_MEAN
+#  define NOMINMAX
+#  include <windows.h>
+#else
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <fcntl.h>
+#  include <unistd.h>
+#endif
+
+#include "MappedFile.h"
+
+MappedFile::MappedFile() {
+	this->data = nullptr;
+	this->size = 0;
+	this->modifiedTime = 0;
+	this->opened = false;
+#ifdef _WIN32
+	this->fileHandle = INVALID_HANDLE_VALUE;
+	this->mappingHandle = nullptr;
+#endif
+}
+
+MappedFile::~MappedFile() {
+	this->close();
+}
+
+bool MappedFile::open(const std::string filename, const bool copyOnWrite) {
+	this->close();
+
+#ifdef _WIN32
+	HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+		OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (file == INVALID_HANDLE_VALUE) {
+		return false;
+	}
+
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(file, &fileSize)) {
+		CloseHandle(file);
+		return false;
+	}
+
+	FILETIME writeTime;
+	if (!GetFileTime(file, nullptr, nullptr, &writeTime)) {
+		CloseHandle(file);
+		return false;
+	}
+
+	this->fileHandle = file;
+	this->size = (size_t)fileSize.QuadPart;
+	this->modifiedTime = ((long long)writeTime.dwHighDateTime << 32) | writeTime.dwLowDateTime;
+	this->opened = true;
+
+	// an empty file cannot be mapped, but it is still a valid (empty) file
+	if (this->size == 0) {
+		return true;
+	}
+
+	HANDLE mapping = CreateFileMappingA(file, nullptr, copyOnWrite ? PAGE_WRITECOPY : PAGE_READONLY, 0, 0, nullptr);
+	if (mapping == nullptr) {
+		this->close();
+		return false;
+	}
+	this->mappingHandle = mapping;
+
+	this->data = (char*)MapViewOfFile(mapping, copyOnWrite ? FILE_MAP_COPY : FILE_MAP_READ, 0, 0, 0);
+	if (this->data == nullptr) {
+		this->close();
+		return false;
+	}
+#else
+	int fd = ::open(filename.c_str(), O_RDONLY);
+	if (fd < 0) {
+		return false;
+	}
+
+	struct stat fileStat;
+	if (fstat(fd, &fileStat) != 0) {
+		::close(fd);
+		return false;
+	}
+
+	this->size = (size_t)fileStat.st_size;
+	this->modifiedTime = (long long)fileStat.st_mtime;
+	this->opened = true;
+
+	// an empty file cannot be mapped, but it is still a valid (empty) file
+	if (this->size == 0) {
+		::close(fd);
+		return true;
+	}
+
+	int protection = copyOnWrite ? (PROT_READ | PROT_WRITE) : PROT_READ;
+	int flags = MAP_PRIVATE;
+#ifdef MAP_POPULATE
+	flags |= MAP_POPULATE;
+#endif
+	void* mapping = mmap(nullptr, this->size, protection, flags, fd, 0);
+	::close(fd);
+	if (mapping == MAP_FAILED) {
+		this->size = 0;
+		this->opened = false;
+		return false;
+	}
+
+	// we walk the file front to back, so let the kernel read ahead aggressively
+	madvise(mapping, this->size, MADV_SEQUENTIAL);
+
+	this->data = (char*)mapping;
+#endif
+
+	return true;
+}
+
+void MappedFile::close() {
+#ifdef _WIN32
+	if (this->data != nullptr) {
+		UnmapViewOfFile(this->data);
+	}
+	if (this->mappingHandle != nullptr) {
+		CloseHandle((HANDLE)this->mappingHandle);
+	}
+	if (this->fileHandle != INVALID_HANDLE_VALUE) {
+		CloseHandle((HANDLE)this->fileHandle);
+	}
+	this->fileHandle = INVALID_HANDLE_VALUE;
+	this->mappingHandle = nullptr;
+#else
+	if (this->data != nullptr) {
+		munmap(this->data, this->size);
+	}
+#endif
+
+	this->data = nullptr;
+	this->size = 0;
+	this->modifiedTime = 0;
+	this->opened = false;
+}
+
+bool MappedFile::isOpen() {
+	return this->opened;
+}
+
+const char* MappedFile::getData() {
+	return this->data;
+}
+
+size_t MappedFile::getSize() {
+	return this->size;
+}
+
+long long MappedFile::getModifiedTime() {
+	return this->modifiedTime;
+}
@@ -0,0 +1,33 @@
+#include <string>
+#include <cstddef>
+
+#pragma once
+
+// a read-only view of a whole file, memory-mapped so it can be parsed in place;
+// a copy-on-write mapping may also be written through without touching the file
+class MappedFile {
+private:
+	char* data;
+	size_t size;
+	long long modifiedTime;
+	bool opened;
+#ifdef _WIN32
+	void* fileHandle;
+	void* mappingHandle;
+#endif
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+public:
+	MappedFile();
+	~MappedFile();
+
+	bool open(const std::string filename, const bool copyOnWrite = false);
+	void close();
+
+	bool isOpen();
+	const char* getData();
+	size_t getSize();
+	long long getModifiedTime();
+};
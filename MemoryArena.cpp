@@ -0,0 +1,106 @@
+#ifdef _WIN32
+#  define WIN32_LEAN_AND_MEAN
+#  define NOMINMAX
+#  include <windows.h>
+#  include <psapi.h>
+#else
+#  include <sys/resource.h>
+#endif
+
+#include <cstdlib>
+
+#include "MemoryArena.h"
+
+// every allocation starts on a boundary that suits SIMD loads
+static const size_t arenaAlignment = 16;
+
+MemoryArena::MemoryArena(size_t blockSize) {
+	this->blockSize = blockSize;
+	this->cursor = nullptr;
+	this->blockEnd = nullptr;
+	this->used = 0;
+	this->peak = 0;
+}
+
+MemoryArena::~MemoryArena() {
+	this->release();
+}
+
+void* MemoryArena::allocateBytes(size_t size) {
+	if (size == 0) {
+		return nullptr;
+	}
+	if (size > SIZE_MAX - arenaAlignment * 2) {
+		throw std::bad_alloc();
+	}
+	size = (size + arenaAlignment - 1) & ~(arenaAlignment - 1);
+
+	if (this->cursor == nullptr || size > (size_t)(this->blockEnd - this->cursor)) {
+		// big arrays get a block of their own, so they never waste the rest of a shared one
+		size_t newBlockSize = size > this->blockSize / 2 ? size : this->blockSize;
+		char* block = (char*)malloc(newBlockSize + arenaAlignment);
+		if (block == nullptr) {
+			throw std::bad_alloc();
+		}
+		this->blocks.push_back(block);
+
+		char* aligned = (char*)(((size_t)block + arenaAlignment - 1) & ~(arenaAlignment - 1));
+		if (newBlockSize != this->blockSize) {
+			// keep filling the current shared block afterwards
+			this->used += size;
+			if (this->used > this->peak) {
+				this->peak = this->used;
+			}
+			return aligned;
+		}
+		this->cursor = aligned;
+		this->blockEnd = aligned + newBlockSize;
+	}
+
+	void* result = this->cursor;
+	this->cursor += size;
+	this->used += size;
+	if (this->used > this->peak) {
+		this->peak = this->used;
+	}
+	return result;
+}
+
+void MemoryArena::release() {
+	for (size_t i = 0; i < this->blocks.size(); i++) {
+		free(this->blocks[i]);
+	}
+	this->blocks.clear();
+	this->cursor = nullptr;
+	this->blockEnd = nullptr;
+	this->used = 0;
+}
+
+size_t MemoryArena::getUsed() {
+	return this->used;
+}
+
+size_t MemoryArena::getPeak() {
+	return this->peak;
+}
+
+size_t getPeakResidentBytes() {
+#ifdef _WIN32
+	PROCESS_MEMORY_COUNTERS counters;
+	if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+		return (size_t)counters.PeakWorkingSetSize;
+	}
+	return 0;
+#else
+	struct rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage) != 0) {
+		return 0;
+	}
+#  ifdef __APPLE__
+	return (size_t)usage.ru_maxrss;
+#  else
+	// Linux reports kilobytes
+	return (size_t)usage.ru_maxrss * 1024;
+#  endif
+#endif
+}
@@ -0,0 +1,46 @@
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+
+#pragma once
+
+// a bump allocator for the short-lived arrays of a single load: allocations are never freed one
+// by one, only all together by release() (or the destructor), and are left uninitialised, so it
+// only suits plain data. Like new, it throws std::bad_alloc when memory runs out, so callers never
+// get a null array to write through (only a zero-length allocation returns null). It also keeps
+// a high-water mark of the bytes it has handed out.
+class MemoryArena {
+private:
+	std::vector<char*> blocks;
+	size_t blockSize;
+	char* cursor;
+	char* blockEnd;
+	size_t used;
+	size_t peak;
+
+	void* allocateBytes(size_t size);
+
+	MemoryArena(const MemoryArena&) = delete;
+	MemoryArena& operator=(const MemoryArena&) = delete;
+
+public:
+	MemoryArena(size_t blockSize = 1 << 20);
+	~MemoryArena();
+
+	template <typename T>
+	T* allocate(size_t count) {
+		if (count > SIZE_MAX / sizeof(T)) {
+			throw std::bad_alloc();
+		}
+		return (T*)this->allocateBytes(count * sizeof(T));
+	}
+
+	void release();
+
+	size_t getUsed();
+	size_t getPeak();
+};
+
+// the most memory the process has had resident so far, in bytes, or 0 where it is not known
+size_t getPeakResidentBytes();
@@ -0,0 +1,54 @@
+#include <vector>
+#include <cstddef>
+#include <utility>
+
+#pragma once
+
+// an array of mesh data that is either owned, or a view into memory someone else keeps alive
+// (e.g. a memory-mapped mesh cache); edit() turns a view into an owned copy before it is changed
+template <typename T>
+class MeshBuffer {
+private:
+	std::vector<T> owned;
+	T* mapped;
+	size_t mappedCount;
+
+public:
+	MeshBuffer() {
+		this->mapped = nullptr;
+		this->mappedCount = 0;
+	}
+
+	void assign(std::vector<T> &&values) {
+		this->owned = std::move(values);
+		this->mapped = nullptr;
+		this->mappedCount = 0;
+	}
+
+	void map(T* values, size_t count) {
+		std::vector<T>().swap(this->owned);
+		this->mapped = values;
+		this->mappedCount = count;
+	}
+
+	std::vector<T>& edit() {
+		if (this->mapped != nullptr) {
+			this->owned.assign(this->mapped, this->mapped + this->mappedCount);
+			this->mapped = nullptr;
+			this->mappedCount = 0;
+		}
+		return this->owned;
+	}
+
+	bool isMapped() const {
+		return this->mapped != nullptr;
+	}
+
+	T* data() {
+		return this->mapped != nullptr ? this->mapped : this->owned.data();
+	}
+
+	size_t size() const {
+		return this->mapped != nullptr ? this->mappedCount : this->owned.size();
+	}
+};
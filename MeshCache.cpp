@@ -0,0 +1,191 @@
+#include <fstream>
+#include <cstdio>
+#include <cstring>
+
+#include "MeshCache.h"
+
+static const char cacheMagic[8] = { 'O', 'B', 'J', 'M', 'E', 'S', 'H', 'C' };
+
+// sections start on this boundary so every array can be used in place
+static const uint64_t sectionAlignment = 16;
+
+struct CacheHeader {
+	char magic[8];
+	uint32_t version;
+	uint32_t numSections;
+	uint64_t sourceSize;
+	int64_t sourceTime;
+	uint64_t sourceHash;
+	uint32_t flags;
+	uint32_t options;
+};
+
+struct CacheTableEntry {
+	uint32_t id;
+	uint32_t reserved;
+	uint64_t offset;
+	uint64_t size;
+};
+
+static uint64_t alignUp(uint64_t value) {
+	return (value + sectionAlignment - 1) & ~(sectionAlignment - 1);
+}
+
+uint64_t MeshCache::hashContents(const char* data, size_t size) {
+	// FNV-1a over 8-byte words, with a final avalanche so nearby inputs spread out
+	const uint64_t prime = 0x100000001b3ull;
+	uint64_t hash = 0xcbf29ce484222325ull ^ size;
+
+	size_t numWords = size / 8;
+	for (size_t i = 0; i < numWords; i++) {
+		uint64_t word;
+		memcpy(&word, data + i * 8, 8);
+		hash = (hash ^ word) * prime;
+	}
+	for (size_t i = numWords * 8; i < size; i++) {
+		hash = (hash ^ (unsigned char)data[i]) * prime;
+	}
+
+	hash ^= hash >> 33;
+	hash *= 0xff51afd7ed558ccdull;
+	hash ^= hash >> 33;
+	return hash;
+}
+
+bool MeshCache::open(const std::string filename, const MeshCacheKey &key) {
+	this->close();
+
+	if (!this->file.open(filename, true)) {
+		return false;
+	}
+
+	return this->readTable(this->file.getData(), this->file.getSize(), key);
+}
+
+bool MeshCache::open(const char* data, const size_t size, const MeshCacheKey &key) {
+	this->close();
+
+	return this->readTable(data, size, key);
+}
+
+bool MeshCache::readTable(const char* data, const uint64_t size, const MeshCacheKey &key) {
+	CacheHeader header;
+	if (size < sizeof(header)) {
+		this->close();
+		return false;
+	}
+	memcpy(&header, data, sizeof(header));
+
+	bool valid = memcmp(header.magic, cacheMagic, sizeof(cacheMagic)) == 0
+		&& header.version == MESH_CACHE_VERSION
+		&& header.sourceSize == key.sourceSize
+		&& header.sourceTime == key.sourceTime
+		&& header.sourceHash == key.sourceHash
+		&& header.flags == key.flags
+		&& header.options == key.options
+		&& sizeof(header) + (uint64_t)header.numSections * sizeof(CacheTableEntry) <= size;
+	if (!valid) {
+		this->close();
+		return false;
+	}
+
+	const char* table = data + sizeof(header);
+	for (uint32_t i = 0; i < header.numSections; i++) {
+		CacheTableEntry entry;
+		memcpy(&entry, table + i * sizeof(entry), sizeof(entry));
+
+		if (entry.offset % sectionAlignment != 0 || entry.offset > size || entry.size > size - entry.offset) {
+			this->close();
+			return false;
+		}
+
+		Section section;
+		section.id = entry.id;
+		section.data = data + entry.offset;
+		section.offset = entry.offset;
+		section.size = entry.size;
+		this->sections.push_back(section);
+	}
+
+	return true;
+}
+
+void MeshCache::close() {
+	this->sections.clear();
+	this->file.close();
+}
+
+void* MeshCache::getSection(const uint32_t id, size_t &size) {
+	for (unsigned int i = 0; i < this->sections.size(); i++) {
+		if (this->sections[i].id == id) {
+			size = (size_t)this->sections[i].size;
+			return (void*)this->sections[i].data;
+		}
+	}
+	size = 0;
+	return nullptr;
+}
+
+void MeshCache::addSection(const uint32_t id, const void* data, const size_t size) {
+	Section section;
+	section.id = id;
+	section.data = data;
+	section.offset = 0;
+	section.size = size;
+	this->sections.push_back(section);
+}
+
+bool MeshCache::save(const std::string filename, const MeshCacheKey &key) {
+	CacheHeader header;
+	memcpy(header.magic, cacheMagic, sizeof(cacheMagic));
+	header.version = MESH_CACHE_VERSION;
+	header.numSections = (uint32_t)this->sections.size();
+	header.sourceSize = key.sourceSize;
+	header.sourceTime = key.sourceTime;
+	header.sourceHash = key.sourceHash;
+	header.flags = key.flags;
+	header.options = key.options;
+
+	// lay the sections out after the header and table
+	uint64_t offset = alignUp(sizeof(header) + this->sections.size() * sizeof(CacheTableEntry));
+	std::vector<CacheTableEntry> table(this->sections.size());
+	for (unsigned int i = 0; i < this->sections.size(); i++) {
+		table[i].id = this->sections[i].id;
+		table[i].reserved = 0;
+		table[i].offset = offset;
+		table[i].size = this->sections[i].size;
+		offset = alignUp(offset + this->sections[i].size);
+	}
+
+	// write to a temporary file and move it into place, so a crash never leaves a torn cache
+	std::string tempFilename = filename + ".tmp";
+	std::ofstream fileOut(tempFilename, std::ios::binary | std::ios::trunc);
+	if (!fileOut.is_open()) {
+		this->sections.clear();
+		return false;
+	}
+
+	const char padding[sectionAlignment] = { 0 };
+	uint64_t written = sizeof(header) + table.size() * sizeof(CacheTableEntry);
+	fileOut.write((const char*)&header, sizeof(header));
+	fileOut.write((const char*)table.data(), table.size() * sizeof(CacheTableEntry));
+	for (unsigned int i = 0; i < this->sections.size(); i++) {
+		fileOut.write(padding, table[i].offset - written);
+		fileOut.write((const char*)this->sections[i].data, this->sections[i].size);
+		written = table[i].offset + table[i].size;
+	}
+	fileOut.close();
+	this->sections.clear();
+
+	if (!fileOut) {
+		std::remove(tempFilename.c_str());
+		return false;
+	}
+
+	std::remove(filename.c_str());
+	if (std::rename(tempFilename.c_str(), filename.c_str()) != 0) {
+		std::remove(tempFilename.c_str());
+		return false;
+	}
+	return true;
+}
@@ -0,0 +1,73 @@
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+#include "MappedFile.h"
+
+#pragma once
+
+// bump whenever the layout of the file or of any section changes
+#define MESH_CACHE_VERSION 9
+
+// identifies the source a cache was built from, and how it was processed
+struct MeshCacheKey {
+	uint64_t sourceSize;
+	int64_t sourceTime;
+	uint64_t sourceHash;
+	uint32_t flags;
+	// any processing setting that is not on or off, e.g. the bits of the crease angle
+	uint32_t options;
+};
+typedef struct MeshCacheKey MeshCacheKey;
+
+enum MeshCacheSection {
+	CACHE_INFO = 1,
+	CACHE_POSITIONS = 2,
+	CACHE_TEXTURE_COORDS = 3,
+	CACHE_NORMALS = 4,
+	CACHE_TRIANGLE_INDICES = 5,
+	CACHE_SUBMESHES = 6,
+	CACHE_NAMES = 7,
+	CACHE_TANGENTS = 8,
+	CACHE_LODS = 9,
+	CACHE_LOD_RANGES = 10,
+	CACHE_LOD_INDICES = 11,
+	CACHE_MESHLETS = 12
+};
+
+// a versioned binary sidecar holding a processed mesh as a table of aligned sections, so a
+// later launch can map it and use the arrays in place instead of parsing the source again
+class MeshCache {
+private:
+	struct Section {
+		uint32_t id;
+		const void* data;
+		uint64_t offset;
+		uint64_t size;
+	};
+
+	MappedFile file;
+	std::vector<Section> sections;
+
+	bool readTable(const char* data, const uint64_t size, const MeshCacheKey &key);
+
+public:
+	// a fast 64-bit hash of the source contents, used as part of the key
+	static uint64_t hashContents(const char* data, size_t size);
+
+	// maps an existing cache, failing if it is missing, corrupt, stale, or from another version
+	bool open(const std::string filename, const MeshCacheKey &key);
+
+	// the same for a cache someone else has in memory (e.g. a blob of an asset pack), which must
+	// stay alive while it is open, and be writable, as getSection() hands it out so
+	bool open(const char* data, const size_t size, const MeshCacheKey &key);
+	void close();
+
+	// the mapped contents of a section, writable (copy-on-write), or nullptr if it is absent
+	void* getSection(const uint32_t id, size_t &size);
+
+	// queues a section for save(); the data must stay alive until then
+	void addSection(const uint32_t id, const void* data, const size_t size);
+	bool save(const std::string filename, const MeshCacheKey &key);
+};
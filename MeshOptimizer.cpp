@@ -0,0 +1,834 @@
+#include <vector>
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+
+#include "MeshOptimizer.h"
+
+VertexCacheStats analyzeVertexCache(const unsigned int* indices, const size_t numIndices, const size_t numVertices,
+	const unsigned int cacheSize) {
+	VertexCacheStats stats;
+	stats.numTransformed = 0;
+
+	// a vertex is in the FIFO if it was pushed within the last cacheSize misses
+	std::vector<unsigned int> pushedAt(numVertices, 0);
+	unsigned int timestamp = cacheSize + 1;
+
+	for (size_t i = 0; i < numIndices; i++) {
+		unsigned int v = indices[i];
+		if (timestamp - pushedAt[v] > cacheSize) {
+			pushedAt[v] = timestamp++;
+			stats.numTransformed++;
+		}
+	}
+
+	size_t numTriangles = numIndices / 3;
+	stats.acmr = numTriangles > 0 ? float(stats.numTransformed) / float(numTriangles) : 0.0f;
+	stats.atvr = numVertices > 0 ? float(stats.numTransformed) / float(numVertices) : 0.0f;
+	return stats;
+}
+
+// Forsyth's tuning constants for an LRU cache of this many entries
+static const int forsythCacheSize = 32;
+static const int forsythMaxValence = 32;
+static const float forsythCacheDecayPower = 1.5f;
+static const float forsythLastTriangleScore = 0.75f;
+static const float forsythValenceBoostScale = 2.0f;
+static const float forsythValenceBoostPower = 0.5f;
+
+struct ForsythScores {
+	float cache[forsythCacheSize];
+	float valence[forsythMaxValence + 1];
+};
+
+static void buildForsythScores(ForsythScores &scores) {
+	for (int i = 0; i < forsythCacheSize; i++) {
+		if (i < 3) {
+			// the vertices of the triangle just drawn score the same, so no strip-like bias
+			scores.cache[i] = forsythLastTriangleScore;
+		} else {
+			float scale = 1.0f / (forsythCacheSize - 3);
+			scores.cache[i] = powf(1.0f - (i - 3) * scale, forsythCacheDecayPower);
+		}
+	}
+
+	// boost vertices with few triangles left, so lone triangles are not left behind
+	scores.valence[0] = 0.0f;
+	for (int i = 1; i <= forsythMaxValence; i++) {
+		scores.valence[i] = forsythValenceBoostScale * powf((float)i, -forsythValenceBoostPower);
+	}
+}
+
+static inline float vertexScore(const ForsythScores &scores, int cachePosition, unsigned int liveTriangles) {
+	if (liveTriangles == 0) {
+		// no triangle needs this vertex any more
+		return -1.0f;
+	}
+	float score = cachePosition >= 0 ? scores.cache[cachePosition] : 0.0f;
+	return score + scores.valence[liveTriangles < (unsigned int)forsythMaxValence ? liveTriangles : forsythMaxValence];
+}
+
+void optimizeVertexCache(unsigned int* indices, const size_t numIndices, const size_t numVertices) {
+	size_t numTriangles = numIndices / 3;
+	if (numTriangles == 0) {
+		return;
+	}
+
+	ForsythScores scores;
+	buildForsythScores(scores);
+
+	// vertex -> triangle adjacency; each vertex's still-unemitted triangles are kept at the front
+	std::vector<unsigned int> liveTriangles(numVertices, 0);
+	for (size_t i = 0; i < numTriangles * 3; i++) {
+		liveTriangles[indices[i]]++;
+	}
+	std::vector<unsigned int> adjacencyOffsets(numVertices + 1, 0);
+	for (size_t v = 0; v < numVertices; v++) {
+		adjacencyOffsets[v + 1] = adjacencyOffsets[v] + liveTriangles[v];
+	}
+	std::vector<unsigned int> adjacency(numTriangles * 3);
+	std::vector<unsigned int> fill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+	for (size_t t = 0; t < numTriangles; t++) {
+		for (int k = 0; k < 3; k++) {
+			unsigned int v = indices[t * 3 + k];
+			adjacency[fill[v]++] = (unsigned int)t;
+		}
+	}
+
+	std::vector<int> cachePosition(numVertices, -1);
+	std::vector<float> vertexScores(numVertices);
+	for (size_t v = 0; v < numVertices; v++) {
+		vertexScores[v] = vertexScore(scores, -1, liveTriangles[v]);
+	}
+
+	std::vector<float> triangleScores(numTriangles);
+	for (size_t t = 0; t < numTriangles; t++) {
+		triangleScores[t] = vertexScores[indices[t * 3]] + vertexScores[indices[t * 3 + 1]] + vertexScores[indices[t * 3 + 2]];
+	}
+
+	std::vector<char> emitted(numTriangles, 0);
+	std::vector<unsigned int> output(numTriangles * 3);
+
+	// the simulated LRU cache, with room for the three vertices pushed on top of a full cache
+	unsigned int cache[forsythCacheSize + 3];
+	unsigned int newCache[forsythCacheSize + 3];
+	int cacheCount = 0;
+
+	size_t nextUnemitted = 0;
+	long long bestTriangle = -1;
+
+	for (size_t emittedCount = 0; emittedCount < numTriangles; emittedCount++) {
+		// when nothing in the cache leads anywhere, restart at the next triangle in input order
+		if (bestTriangle < 0) {
+			while (emitted[nextUnemitted]) {
+				nextUnemitted++;
+			}
+			bestTriangle = (long long)nextUnemitted;
+		}
+
+		unsigned int t = (unsigned int)bestTriangle;
+		unsigned int a = indices[t * 3 + 0];
+		unsigned int b = indices[t * 3 + 1];
+		unsigned int c = indices[t * 3 + 2];
+		output[emittedCount * 3 + 0] = a;
+		output[emittedCount * 3 + 1] = b;
+		output[emittedCount * 3 + 2] = c;
+		emitted[t] = 1;
+
+		// drop the triangle from its vertices' live lists
+		unsigned int corners[3] = { a, b, c };
+		for (int k = 0; k < 3; k++) {
+			unsigned int v = corners[k];
+			unsigned int* begin = &adjacency[adjacencyOffsets[v]];
+			unsigned int live = liveTriangles[v];
+			for (unsigned int j = 0; j < live; j++) {
+				if (begin[j] == t) {
+					begin[j] = begin[live - 1];
+					begin[live - 1] = t;
+					break;
+				}
+			}
+			liveTriangles[v]--;
+		}
+
+		// push the triangle's vertices to the front of the LRU cache
+		int newCount = 0;
+		newCache[newCount++] = a;
+		newCache[newCount++] = b;
+		newCache[newCount++] = c;
+		for (int i = 0; i < cacheCount; i++) {
+			unsigned int v = cache[i];
+			if (v != a && v != b && v != c) {
+				newCache[newCount++] = v;
+			}
+		}
+
+		// rescore every vertex whose cache position changed, including the ones that fell out
+		for (int i = 0; i < newCount; i++) {
+			unsigned int v = newCache[i];
+			cachePosition[v] = i < forsythCacheSize ? i : -1;
+		}
+
+		for (int i = 0; i < newCount; i++) {
+			unsigned int v = newCache[i];
+			float newScore = vertexScore(scores, cachePosition[v], liveTriangles[v]);
+			float delta = newScore - vertexScores[v];
+			vertexScores[v] = newScore;
+
+			const unsigned int* begin = &adjacency[adjacencyOffsets[v]];
+			for (unsigned int j = 0; j < liveTriangles[v]; j++) {
+				triangleScores[begin[j]] += delta;
+			}
+		}
+
+		// the next triangle is the best one touching the cache
+		bestTriangle = -1;
+		float bestScore = -1.0f;
+		for (int i = 0; i < newCount && i < forsythCacheSize; i++) {
+			unsigned int v = newCache[i];
+			const unsigned int* begin = &adjacency[adjacencyOffsets[v]];
+			for (unsigned int j = 0; j < liveTriangles[v]; j++) {
+				unsigned int other = begin[j];
+				if (triangleScores[other] > bestScore) {
+					bestScore = triangleScores[other];
+					bestTriangle = other;
+				}
+			}
+		}
+
+		cacheCount = newCount < forsythCacheSize ? newCount : forsythCacheSize;
+		memcpy(cache, newCache, cacheCount * sizeof(unsigned int));
+	}
+
+	memcpy(indices, output.data(), numTriangles * 3 * sizeof(unsigned int));
+}
+
+// the resolution of the software rasteriser used to measure overdraw
+static const int overdrawGridSize = 256;
+
+static void rasterizeOverdraw(const unsigned int* indices, const size_t numIndices, const std::vector<float> &projected,
+	const bool cullBackFaces, std::vector<float> &depth, OverdrawStats &stats) {
+	std::fill(depth.begin(), depth.end(), 1e30f);
+
+	for (size_t i = 0; i + 2 < numIndices; i += 3) {
+		const float* a = &projected[indices[i] * 3];
+		const float* b = &projected[indices[i + 1] * 3];
+		const float* c = &projected[indices[i + 2] * 3];
+
+		// counter-clockwise triangles face the viewer; back faces are culled if the renderer culls
+		// them, and otherwise turned around
+		float area = (b[0] - a[0]) * (c[1] - a[1]) - (b[1] - a[1]) * (c[0] - a[0]);
+		if (area < 0.0f && !cullBackFaces) {
+			std::swap(b, c);
+			area = -area;
+		}
+		if (area <= 0.0f) {
+			continue;
+		}
+		float invArea = 1.0f / area;
+
+		int minX = (int)std::max(0.0f, std::floor(std::min(a[0], std::min(b[0], c[0]))));
+		int maxX = (int)std::min(overdrawGridSize - 1.0f, std::ceil(std::max(a[0], std::max(b[0], c[0]))));
+		int minY = (int)std::max(0.0f, std::floor(std::min(a[1], std::min(b[1], c[1]))));
+		int maxY = (int)std::min(overdrawGridSize - 1.0f, std::ceil(std::max(a[1], std::max(b[1], c[1]))));
+
+		// sample at pixel centres with barycentrics
+		for (int y = minY; y <= maxY; y++) {
+			for (int x = minX; x <= maxX; x++) {
+				float px = x + 0.5f;
+				float py = y + 0.5f;
+				float w0 = ((b[0] - px) * (c[1] - py) - (b[1] - py) * (c[0] - px)) * invArea;
+				float w1 = ((c[0] - px) * (a[1] - py) - (c[1] - py) * (a[0] - px)) * invArea;
+				float w2 = 1.0f - w0 - w1;
+				if (w0 < 0.0f || w1 < 0.0f || w2 < 0.0f) {
+					continue;
+				}
+
+				float z = w0 * a[2] + w1 * b[2] + w2 * c[2];
+				float &stored = depth[y * overdrawGridSize + x];
+				if (z < stored) {
+					if (stored == 1e30f) {
+						stats.pixelsCovered++;
+					}
+					stored = z;
+					stats.pixelsShaded++;
+				}
+			}
+		}
+	}
+}
+
+OverdrawStats analyzeOverdraw(const unsigned int* indices, const size_t numIndices, const float* positions,
+	const size_t numVertices, const bool cullBackFaces) {
+	OverdrawStats stats;
+	stats.pixelsCovered = 0;
+	stats.pixelsShaded = 0;
+	stats.overdraw = 0.0f;
+
+	if (numVertices == 0) {
+		return stats;
+	}
+
+	// fit the mesh's bounding box to the grid
+	float minimum[3] = { positions[0], positions[1], positions[2] };
+	float maximum[3] = { positions[0], positions[1], positions[2] };
+	for (size_t v = 0; v < numVertices; v++) {
+		for (int k = 0; k < 3; k++) {
+			minimum[k] = std::min(minimum[k], positions[v * 3 + k]);
+			maximum[k] = std::max(maximum[k], positions[v * 3 + k]);
+		}
+	}
+	float extent = std::max(maximum[0] - minimum[0], std::max(maximum[1] - minimum[1], maximum[2] - minimum[2]));
+	float scale = extent > 0.0f ? (overdrawGridSize - 1) / extent : 0.0f;
+
+	std::vector<float> projected(numVertices * 3);
+	std::vector<float> depth(overdrawGridSize * overdrawGridSize);
+
+	// look along each axis from both sides; the viewer sits at the near (depth 0) end, and the
+	// screen's x axis is mirrored for the min side so winding still reads counter-clockwise
+	for (int axis = 0; axis < 3; axis++) {
+		for (int side = 0; side < 2; side++) {
+			int u = (axis + 1) % 3;
+			int w = (axis + 2) % 3;
+			for (size_t v = 0; v < numVertices; v++) {
+				const float* p = &positions[v * 3];
+				projected[v * 3 + 0] = (side == 0 ? maximum[u] - p[u] : p[u] - minimum[u]) * scale;
+				projected[v * 3 + 1] = (p[w] - minimum[w]) * scale;
+				projected[v * 3 + 2] = side == 0 ? p[axis] - minimum[axis] : maximum[axis] - p[axis];
+			}
+			rasterizeOverdraw(indices, numIndices, projected, cullBackFaces, depth, stats);
+		}
+	}
+
+	stats.overdraw = stats.pixelsCovered > 0 ? float(stats.pixelsShaded) / float(stats.pixelsCovered) : 0.0f;
+	return stats;
+}
+
+// cluster boundaries where the simulated cache was flushed, i.e. every vertex of a triangle missed
+static void findHardBoundaries(const unsigned int* indices, const size_t numTriangles, const size_t numVertices,
+	std::vector<unsigned int> &clusters) {
+	std::vector<unsigned int> pushedAt(numVertices, 0);
+	unsigned int timestamp = VERTEX_CACHE_REPORT_SIZE + 1;
+
+	for (size_t t = 0; t < numTriangles; t++) {
+		int misses = 0;
+		for (int k = 0; k < 3; k++) {
+			unsigned int v = indices[t * 3 + k];
+			if (timestamp - pushedAt[v] > VERTEX_CACHE_REPORT_SIZE) {
+				pushedAt[v] = timestamp++;
+				misses++;
+			}
+		}
+		if (t == 0 || misses == 3) {
+			clusters.push_back((unsigned int)t);
+		}
+	}
+}
+
+// splits hard clusters further wherever the running ACMR of the cluster is already good enough
+static void findSoftBoundaries(const unsigned int* indices, const size_t numTriangles, const size_t numVertices,
+	const std::vector<unsigned int> &hardClusters, const float threshold, std::vector<unsigned int> &clusters) {
+	std::vector<unsigned int> pushedAt(numVertices, 0);
+	unsigned int timestamp = VERTEX_CACHE_REPORT_SIZE + 1;
+
+	float targetAcmr = analyzeVertexCache(indices, numTriangles * 3, numVertices, VERTEX_CACHE_REPORT_SIZE).acmr * threshold;
+
+	for (size_t c = 0; c < hardClusters.size(); c++) {
+		size_t begin = hardClusters[c];
+		size_t end = c + 1 < hardClusters.size() ? hardClusters[c + 1] : numTriangles;
+
+		clusters.push_back((unsigned int)begin);
+
+		// each sub-cluster starts with a cold cache, which is what the GPU will see after a reorder
+		timestamp += VERTEX_CACHE_REPORT_SIZE + 1;
+		unsigned int misses = 0;
+		size_t start = begin;
+		for (size_t t = begin; t < end; t++) {
+			for (int k = 0; k < 3; k++) {
+				unsigned int v = indices[t * 3 + k];
+				if (timestamp - pushedAt[v] > VERTEX_CACHE_REPORT_SIZE) {
+					pushedAt[v] = timestamp++;
+					misses++;
+				}
+			}
+
+			float acmr = float(misses) / float(t - start + 1);
+			if (acmr <= targetAcmr && t + 1 < end) {
+				clusters.push_back((unsigned int)(t + 1));
+				timestamp += VERTEX_CACHE_REPORT_SIZE + 1;
+				misses = 0;
+				start = t + 1;
+			}
+		}
+	}
+}
+
+void optimizeOverdraw(unsigned int* indices, const size_t numIndices, const float* positions,
+	const size_t numVertices, const float threshold) {
+	size_t numTriangles = numIndices / 3;
+	if (numTriangles == 0) {
+		return;
+	}
+
+	std::vector<unsigned int> hardClusters;
+	findHardBoundaries(indices, numTriangles, numVertices, hardClusters);
+	std::vector<unsigned int> clusters;
+	findSoftBoundaries(indices, numTriangles, numVertices, hardClusters, threshold, clusters);
+
+	// the area-weighted centroid of the whole mesh
+	double meshCentroid[3] = { 0.0, 0.0, 0.0 };
+	double meshArea = 0.0;
+
+	std::vector<float> clusterCentroids(clusters.size() * 3, 0.0f);
+	std::vector<float> clusterNormals(clusters.size() * 3, 0.0f);
+
+	for (size_t c = 0; c < clusters.size(); c++) {
+		size_t begin = clusters[c];
+		size_t end = c + 1 < clusters.size() ? clusters[c + 1] : numTriangles;
+
+		double centroid[3] = { 0.0, 0.0, 0.0 };
+		double normal[3] = { 0.0, 0.0, 0.0 };
+		double area = 0.0;
+
+		for (size_t t = begin; t < end; t++) {
+			const float* a = &positions[indices[t * 3 + 0] * 3];
+			const float* b = &positions[indices[t * 3 + 1] * 3];
+			const float* p = &positions[indices[t * 3 + 2] * 3];
+
+			float e1[3] = { b[0] - a[0], b[1] - a[1], b[2] - a[2] };
+			float e2[3] = { p[0] - a[0], p[1] - a[1], p[2] - a[2] };
+			// the cross product's length is twice the area, so its sum is an area-weighted normal
+			float n[3] = { e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2], e1[0] * e2[1] - e1[1] * e2[0] };
+			double triangleArea = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+
+			for (int k = 0; k < 3; k++) {
+				centroid[k] += (a[k] + b[k] + p[k]) / 3.0 * triangleArea;
+				normal[k] += n[k];
+			}
+			area += triangleArea;
+		}
+
+		for (int k = 0; k < 3; k++) {
+			meshCentroid[k] += centroid[k];
+			clusterCentroids[c * 3 + k] = area > 0.0 ? float(centroid[k] / area) : 0.0f;
+		}
+		meshArea += area;
+
+		double length = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+		for (int k = 0; k < 3; k++) {
+			clusterNormals[c * 3 + k] = length > 0.0 ? float(normal[k] / length) : 0.0f;
+		}
+	}
+
+	for (int k = 0; k < 3; k++) {
+		meshCentroid[k] = meshArea > 0.0 ? meshCentroid[k] / meshArea : 0.0;
+	}
+
+	// clusters that face away from the centre are the likely occluders, so they go first
+	std::vector<float> sortKeys(clusters.size());
+	std::vector<unsigned int> order(clusters.size());
+	for (size_t c = 0; c < clusters.size(); c++) {
+		float dot = 0.0f;
+		for (int k = 0; k < 3; k++) {
+			dot += (clusterCentroids[c * 3 + k] - float(meshCentroid[k])) * clusterNormals[c * 3 + k];
+		}
+		sortKeys[c] = dot;
+		order[c] = (unsigned int)c;
+	}
+	std::stable_sort(order.begin(), order.end(), [&](unsigned int a, unsigned int b) {
+		return sortKeys[a] > sortKeys[b];
+	});
+
+	std::vector<unsigned int> output;
+	output.reserve(numTriangles * 3);
+	for (size_t i = 0; i < order.size(); i++) {
+		size_t c = order[i];
+		size_t begin = clusters[c];
+		size_t end = c + 1 < clusters.size() ? clusters[c + 1] : numTriangles;
+		output.insert(output.end(), indices + begin * 3, indices + end * 3);
+	}
+
+	memcpy(indices, output.data(), numTriangles * 3 * sizeof(unsigned int));
+}
+
+// the fetch model: a GPU-like cache of 64-byte lines
+static const unsigned int fetchLineSize = 64;
+static const unsigned int fetchCacheLines = 64;
+
+VertexFetchStats analyzeVertexFetch(const unsigned int* indices, const size_t numIndices, const size_t numVertices,
+	const size_t vertexSize) {
+	VertexFetchStats stats;
+	stats.bytesFetched = 0;
+	stats.overfetch = 0.0f;
+
+	std::vector<char> used(numVertices, 0);
+	size_t numUsed = 0;
+
+	// an LRU of line numbers, most recent first
+	std::vector<size_t> lines;
+	lines.reserve(fetchCacheLines + 1);
+
+	for (size_t i = 0; i < numIndices; i++) {
+		unsigned int v = indices[i];
+		if (!used[v]) {
+			used[v] = 1;
+			numUsed++;
+		}
+
+		size_t firstLine = v * vertexSize / fetchLineSize;
+		size_t lastLine = (v * vertexSize + vertexSize - 1) / fetchLineSize;
+		for (size_t line = firstLine; line <= lastLine; line++) {
+			std::vector<size_t>::iterator found = std::find(lines.begin(), lines.end(), line);
+			if (found != lines.end()) {
+				lines.erase(found);
+			} else {
+				stats.bytesFetched += fetchLineSize;
+				if (lines.size() == fetchCacheLines) {
+					lines.pop_back();
+				}
+			}
+			lines.insert(lines.begin(), line);
+		}
+	}
+
+	stats.overfetch = numUsed > 0 ? (float)((double)stats.bytesFetched / ((double)numUsed * vertexSize)) : 0.0f;
+	return stats;
+}
+
+size_t optimizeVertexFetchRemap(unsigned int* indices, const size_t numIndices, const size_t numVertices,
+	std::vector<unsigned int> &remap) {
+	const unsigned int unused = ~0u;
+	remap.assign(numVertices, unused);
+
+	unsigned int next = 0;
+	for (size_t i = 0; i < numIndices; i++) {
+		unsigned int v = indices[i];
+		if (remap[v] == unused) {
+			remap[v] = next++;
+		}
+		indices[i] = remap[v];
+	}
+	size_t numReferenced = next;
+
+	// keep any vertices nobody references, at the end, so the arrays stay the same size
+	for (size_t v = 0; v < numVertices; v++) {
+		if (remap[v] == unused) {
+			remap[v] = next++;
+		}
+	}
+
+	return numReferenced;
+}
+
+// how many upcoming triangles a strip may pick its next one from
+static const size_t stripWindowSize = 16;
+
+// the window position of a triangle with the directed edge (a, b), and its third vertex
+static int findStripEdge(const unsigned int (*window)[3], const size_t windowSize, const size_t skip,
+	const unsigned int a, const unsigned int b, unsigned int &third) {
+	for (size_t w = 0; w < windowSize; w++) {
+		if (w == skip) {
+			continue;
+		}
+		for (int r = 0; r < 3; r++) {
+			if (window[w][r] == a && window[w][(r + 1) % 3] == b) {
+				third = window[w][(r + 2) % 3];
+				return (int)w;
+			}
+		}
+	}
+	return -1;
+}
+
+size_t stripifyTriangles(const unsigned int* indices, const size_t numIndices, const unsigned int restartIndex,
+	std::vector<unsigned int> &strip) {
+	size_t numTriangles = numIndices / 3;
+	unsigned int window[stripWindowSize][3];
+	size_t windowSize = 0;
+	size_t next = 0;
+
+	// the last two vertices of the current strip, and its length
+	unsigned int p = 0, q = 0;
+	size_t stripLength = 0;
+	size_t numStrips = 0;
+
+	for (;;) {
+		while (windowSize < stripWindowSize && next < numTriangles) {
+			const unsigned int* triangle = indices + next * 3;
+			next++;
+			if (triangle[0] == triangle[1] || triangle[1] == triangle[2] || triangle[2] == triangle[0]) {
+				continue;
+			}
+			window[windowSize][0] = triangle[0];
+			window[windowSize][1] = triangle[1];
+			window[windowSize][2] = triangle[2];
+			windowSize++;
+		}
+		if (windowSize == 0) {
+			break;
+		}
+
+		// a strip's odd triangles have their first two vertices swapped, so the edge the next
+		// triangle must start with alternates between (p, q) and (q, p)
+		unsigned int third = 0;
+		int found = -1;
+		if (stripLength >= 2) {
+			bool odd = (stripLength & 1) != 0;
+			found = findStripEdge(window, windowSize, stripWindowSize, odd ? q : p, odd ? p : q, third);
+		}
+
+		if (found >= 0) {
+			strip.push_back(third);
+			p = q;
+			q = third;
+			stripLength++;
+		} else {
+			// start a new strip with the oldest triangle, rotated so that, if possible, another
+			// triangle in the window continues it
+			found = 0;
+			int rotation = 0;
+			for (int r = 0; r < 3; r++) {
+				unsigned int unused;
+				if (findStripEdge(window, windowSize, 0, window[0][(r + 2) % 3], window[0][(r + 1) % 3], unused) >= 0) {
+					rotation = r;
+					break;
+				}
+			}
+			if (stripLength > 0) {
+				strip.push_back(restartIndex);
+			}
+			strip.push_back(window[0][rotation]);
+			strip.push_back(window[0][(rotation + 1) % 3]);
+			strip.push_back(window[0][(rotation + 2) % 3]);
+			p = window[0][(rotation + 1) % 3];
+			q = window[0][(rotation + 2) % 3];
+			stripLength = 3;
+			numStrips++;
+		}
+
+		memmove(window[found], window[found + 1], (windowSize - found - 1) * sizeof(window[0]));
+		windowSize--;
+	}
+
+	return numStrips;
+}
+
+// normal cones wider than this (the smallest dot product of a normal with the axis) are no use
+static const float minConeSpread = 0.1f;
+
+// the bounding sphere and normal cone of one meshlet
+static void boundMeshlet(Meshlet &meshlet, const unsigned int* indices, const float* positions) {
+	float minimum[3], maximum[3];
+	for (int axis = 0; axis < 3; axis++) {
+		minimum[axis] = positions[indices[meshlet.firstIndex] * 3 + axis];
+		maximum[axis] = minimum[axis];
+	}
+	for (size_t i = meshlet.firstIndex; i < meshlet.firstIndex + meshlet.numIndices; i++) {
+		for (int axis = 0; axis < 3; axis++) {
+			minimum[axis] = std::min(minimum[axis], positions[indices[i] * 3 + axis]);
+			maximum[axis] = std::max(maximum[axis], positions[indices[i] * 3 + axis]);
+		}
+	}
+	float radiusSquared = 0.0f;
+	for (int axis = 0; axis < 3; axis++) {
+		meshlet.centre[axis] = (minimum[axis] + maximum[axis]) * 0.5f;
+	}
+	for (size_t i = meshlet.firstIndex; i < meshlet.firstIndex + meshlet.numIndices; i++) {
+		const float* p = positions + indices[i] * 3;
+		float dx = p[0] - meshlet.centre[0], dy = p[1] - meshlet.centre[1], dz = p[2] - meshlet.centre[2];
+		radiusSquared = std::max(radiusSquared, dx * dx + dy * dy + dz * dz);
+	}
+	meshlet.radius = sqrtf(radiusSquared);
+
+	// the axis is the average of the unit normals, and the cone just wide enough to hold them all
+	std::vector<float> normals;
+	normals.reserve(meshlet.numIndices);
+	float axis[3] = { 0.0f, 0.0f, 0.0f };
+	for (size_t i = meshlet.firstIndex; i < meshlet.firstIndex + meshlet.numIndices; i += 3) {
+		const float* a = positions + indices[i] * 3;
+		const float* b = positions + indices[i + 1] * 3;
+		const float* c = positions + indices[i + 2] * 3;
+		float e1[3] = { b[0] - a[0], b[1] - a[1], b[2] - a[2] };
+		float e2[3] = { c[0] - a[0], c[1] - a[1], c[2] - a[2] };
+		float n[3] = { e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2], e1[0] * e2[1] - e1[1] * e2[0] };
+		float length = sqrtf(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+		if (length == 0.0f) {
+			continue;
+		}
+		for (int k = 0; k < 3; k++) {
+			normals.push_back(n[k] / length);
+			axis[k] += n[k] / length;
+		}
+	}
+	float axisLength = sqrtf(axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2]);
+	float spread = -1.0f;
+	if (axisLength > 0.0f) {
+		spread = 1.0f;
+		for (int k = 0; k < 3; k++) {
+			axis[k] /= axisLength;
+		}
+		for (size_t n = 0; n < normals.size(); n += 3) {
+			spread = std::min(spread, normals[n] * axis[0] + normals[n + 1] * axis[1] + normals[n + 2] * axis[2]);
+		}
+	}
+	for (int k = 0; k < 3; k++) {
+		meshlet.coneAxis[k] = axis[k];
+	}
+	meshlet.coneCutoff = spread <= minConeSpread ? 1.0f : sqrtf(1.0f - spread * spread);
+}
+
+// how much a candidate triangle's normal straying from the meshlet's cone counts against it,
+// next to its distance from the meshlet in units of a full meshlet's expected radius
+static const float meshletConeWeight = 0.5f;
+
+size_t buildMeshlets(unsigned int* indices, const size_t numIndices, const float* positions,
+	const size_t numVertices, const size_t maxVertices, const size_t maxTriangles, std::vector<Meshlet> &meshlets) {
+	size_t numTriangles = numIndices / 3;
+	size_t firstMeshlet = meshlets.size();
+	if (numTriangles == 0) {
+		return 0;
+	}
+
+	// the triangles around each vertex
+	std::vector<unsigned int> firstAdjacent(numVertices + 1, 0);
+	for (size_t i = 0; i < numTriangles * 3; i++) {
+		firstAdjacent[indices[i] + 1]++;
+	}
+	for (size_t v = 0; v < numVertices; v++) {
+		firstAdjacent[v + 1] += firstAdjacent[v];
+	}
+	std::vector<unsigned int> adjacent(numTriangles * 3);
+	std::vector<unsigned int> fill(firstAdjacent.begin(), firstAdjacent.end() - 1);
+	for (size_t i = 0; i < numTriangles * 3; i++) {
+		adjacent[fill[indices[i]]++] = (unsigned int)(i / 3);
+	}
+
+	// each triangle's unit normal and centroid, and the radius a full meshlet is expected to have
+	std::vector<float> normals(numTriangles * 3), centroids(numTriangles * 3);
+	double totalArea = 0.0;
+	for (size_t t = 0; t < numTriangles; t++) {
+		const float* a = positions + indices[t * 3] * 3;
+		const float* b = positions + indices[t * 3 + 1] * 3;
+		const float* c = positions + indices[t * 3 + 2] * 3;
+		float e1[3] = { b[0] - a[0], b[1] - a[1], b[2] - a[2] };
+		float e2[3] = { c[0] - a[0], c[1] - a[1], c[2] - a[2] };
+		float n[3] = { e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2], e1[0] * e2[1] - e1[1] * e2[0] };
+		float length = sqrtf(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+		totalArea += length * 0.5;
+		for (int k = 0; k < 3; k++) {
+			normals[t * 3 + k] = length > 0.0f ? n[k] / length : 0.0f;
+			centroids[t * 3 + k] = (a[k] + b[k] + c[k]) / 3.0f;
+		}
+	}
+	float expectedRadius = sqrtf((float)(totalArea / (double)numTriangles) * (float)maxTriangles / 3.14159265f);
+	float distanceScale = expectedRadius > 0.0f ? 1.0f / expectedRadius : 0.0f;
+
+	// grow each meshlet from the first triangle left in the input order, always taking the
+	// neighbouring triangle that adds the fewest vertices, and of those the one closest to the
+	// meshlet and best aligned with its normals, until it is full or runs out of neighbours
+	std::vector<unsigned char> emitted(numTriangles, 0);
+	std::vector<unsigned int> seenIn(numVertices, 0);
+	std::vector<unsigned int> candidates, meshletTriangles;
+	std::vector<unsigned int> reordered;
+	reordered.reserve(numTriangles * 3);
+	unsigned int mark = 0;
+	size_t cursor = 0;
+	while (true) {
+		while (cursor < numTriangles && emitted[cursor]) {
+			cursor++;
+		}
+		if (cursor == numTriangles) {
+			break;
+		}
+
+		mark++;
+		candidates.clear();
+		meshletTriangles.clear();
+		unsigned int meshletVertices = 0;
+		float centre[3] = { 0.0f, 0.0f, 0.0f };
+		float axis[3] = { 0.0f, 0.0f, 0.0f };
+		size_t next = cursor;
+		while (next != (size_t)-1) {
+			emitted[next] = 1;
+			meshletTriangles.push_back((unsigned int)next);
+			for (int c = 0; c < 3; c++) {
+				unsigned int v = indices[next * 3 + c];
+				if (seenIn[v] != mark) {
+					seenIn[v] = mark;
+					meshletVertices++;
+					for (unsigned int a = firstAdjacent[v]; a < firstAdjacent[v + 1]; a++) {
+						if (!emitted[adjacent[a]]) {
+							candidates.push_back(adjacent[a]);
+						}
+					}
+				}
+			}
+			float count = (float)meshletTriangles.size();
+			for (int k = 0; k < 3; k++) {
+				centre[k] += (centroids[next * 3 + k] - centre[k]) / count;
+				axis[k] += normals[next * 3 + k];
+			}
+			if (meshletTriangles.size() == maxTriangles) {
+				break;
+			}
+			float axisLength = sqrtf(axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2]);
+			float inverseAxisLength = axisLength > 0.0f ? 1.0f / axisLength : 0.0f;
+
+			next = (size_t)-1;
+			unsigned int bestAdded = 3;
+			float bestScore = 0.0f;
+			size_t kept = 0;
+			for (size_t i = 0; i < candidates.size(); i++) {
+				unsigned int t = candidates[i];
+				if (emitted[t]) {
+					continue;
+				}
+				candidates[kept++] = t;
+				unsigned int added = 0;
+				for (int c = 0; c < 3; c++) {
+					added += seenIn[indices[t * 3 + c]] != mark ? 1 : 0;
+				}
+				if (meshletVertices + added > maxVertices || added > bestAdded) {
+					continue;
+				}
+				float dx = centroids[t * 3] - centre[0], dy = centroids[t * 3 + 1] - centre[1], dz = centroids[t * 3 + 2] - centre[2];
+				float alignment = (normals[t * 3] * axis[0] + normals[t * 3 + 1] * axis[1] + normals[t * 3 + 2] * axis[2])
+					* inverseAxisLength;
+				float score = sqrtf(dx * dx + dy * dy + dz * dz) * distanceScale * (1.0f - meshletConeWeight)
+					+ (1.0f - alignment) * meshletConeWeight;
+				if (added < bestAdded || score < bestScore) {
+					next = t;
+					bestAdded = added;
+					bestScore = score;
+				}
+			}
+			candidates.resize(kept);
+
+			// a patch with nothing left around it takes the next triangle in the input order
+			if (kept == 0) {
+				while (cursor < numTriangles && emitted[cursor]) {
+					cursor++;
+				}
+				if (cursor < numTriangles && meshletVertices + 3 <= maxVertices) {
+					next = cursor;
+				}
+			}
+		}
+
+		// the meshlet's triangles keep their input order, and with it most of its vertex cache order
+		std::sort(meshletTriangles.begin(), meshletTriangles.end());
+		Meshlet meshlet = { (unsigned int)reordered.size(), (unsigned int)meshletTriangles.size() * 3, meshletVertices,
+			{ 0.0f, 0.0f, 0.0f }, 0.0f, { 0.0f, 0.0f, 0.0f }, 1.0f };
+		for (size_t m = 0; m < meshletTriangles.size(); m++) {
+			const unsigned int* triangle = indices + meshletTriangles[m] * 3;
+			reordered.insert(reordered.end(), triangle, triangle + 3);
+		}
+		meshlets.push_back(meshlet);
+	}
+
+	std::copy(reordered.begin(), reordered.end(), indices);
+	for (size_t m = firstMeshlet; m < meshlets.size(); m++) {
+		boundMeshlet(meshlets[m], indices, positions);
+	}
+	return meshlets.size() - firstMeshlet;
+}
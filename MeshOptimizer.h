@@ -0,0 +1,107 @@
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#pragma once
+
+// post-transform cache statistics for an index stream, from a simulated FIFO cache;
+// ACMR is transformed vertices per triangle (0.5 is ideal, 3 is no reuse at all),
+// ATVR is transformed vertices per unique vertex (1 is ideal)
+struct VertexCacheStats {
+	unsigned int numTransformed;
+	float acmr;
+	float atvr;
+};
+typedef struct VertexCacheStats VertexCacheStats;
+
+// the FIFO size used for reporting, a typical figure for real hardware
+#define VERTEX_CACHE_REPORT_SIZE 16
+
+VertexCacheStats analyzeVertexCache(const unsigned int* indices, const size_t numIndices, const size_t numVertices,
+	const unsigned int cacheSize);
+
+// reorders the triangles of an indexed triangle list in place (Forsyth's linear-speed algorithm)
+// so consecutive triangles reuse recently transformed vertices
+void optimizeVertexCache(unsigned int* indices, const size_t numIndices, const size_t numVertices);
+
+// how many times each covered pixel gets shaded, averaged over a few axis-aligned orthographic
+// views rendered in index order with a depth test, and with back faces culled or not to match the
+// renderer (1 means no hidden surface was shaded)
+struct OverdrawStats {
+	unsigned int pixelsCovered;
+	unsigned int pixelsShaded;
+	float overdraw;
+};
+typedef struct OverdrawStats OverdrawStats;
+
+OverdrawStats analyzeOverdraw(const unsigned int* indices, const size_t numIndices, const float* positions,
+	const size_t numVertices, const bool cullBackFaces);
+
+// reorders clusters of an already cache-optimised triangle list so that outward-facing surfaces
+// are drawn first; a cluster may be split as long as its ACMR stays within threshold times the
+// input's (1.05 keeps almost all of the vertex cache gains)
+void optimizeOverdraw(unsigned int* indices, const size_t numIndices, const float* positions,
+	const size_t numVertices, const float threshold);
+
+// vertex fetch cost of an index stream, modelled as 64-byte cache lines through a small LRU;
+// overfetch is bytes fetched over the bytes of vertex data the stream actually uses (1 is ideal);
+// 64 bits, as a large mesh fetches more than 4 GB over its index stream
+struct VertexFetchStats {
+	uint64_t bytesFetched;
+	float overfetch;
+};
+typedef struct VertexFetchStats VertexFetchStats;
+
+VertexFetchStats analyzeVertexFetch(const unsigned int* indices, const size_t numIndices, const size_t numVertices,
+	const size_t vertexSize);
+
+// builds the renumbering that puts vertices in order of first use by the index stream, rewriting
+// the indices to match; remap[old] is the new position (unreferenced vertices go last), and the
+// return value is the number of vertices the stream references
+size_t optimizeVertexFetchRemap(unsigned int* indices, const size_t numIndices, const size_t numVertices,
+	std::vector<unsigned int> &remap);
+
+// moves the vertices of one attribute array to the positions given by a remap
+template <typename T>
+void remapVertices(std::vector<T> &vertices, const std::vector<unsigned int> &remap) {
+	std::vector<T> remapped(vertices.size());
+	for (size_t v = 0; v < vertices.size(); v++) {
+		remapped[remap[v]] = vertices[v];
+	}
+	vertices.swap(remapped);
+}
+
+// converts a triangle list into triangle strips separated by restartIndex markers, for drawing with
+// primitive restart, appending them to strip; each triangle keeps its winding, and the next one of
+// a strip is picked from a small window of upcoming triangles, so the vertex cache order mostly
+// survives. Degenerate triangles are dropped. Returns the number of strips.
+size_t stripifyTriangles(const unsigned int* indices, const size_t numIndices, const unsigned int restartIndex,
+	std::vector<unsigned int> &strip);
+
+// the limits buildMeshlets() is usually given: 64 vertices and 124 triangles fill the vertex and
+// primitive budgets of a typical mesh shader workgroup
+#define MESHLET_MAX_VERTICES 64
+#define MESHLET_MAX_TRIANGLES 124
+
+// a range of consecutive triangles of a triangle list, small enough to cull as a whole. The sphere
+// bounds its vertices, and the cone bounds its triangles' normals: every triangle faces away
+// from an eye at e if dot(centre - e, coneAxis) >= coneCutoff * length(centre - e) + radius.
+// A meshlet whose normals spread too wide for that to help has a coneCutoff of 1.
+struct Meshlet {
+	unsigned int firstIndex;
+	unsigned int numIndices;
+	unsigned int numVertices;
+	float centre[3];
+	float radius;
+	float coneAxis[3];
+	float coneCutoff;
+};
+typedef struct Meshlet Meshlet;
+
+// splits a triangle list into meshlets of at most maxVertices unique vertices and maxTriangles
+// triangles, each grown across shared vertices into a compact patch facing one way, and reorders
+// the triangles in place so every meshlet's are consecutive (in their previous relative order,
+// so a vertex cache order mostly survives). Appends the meshlets, with firstIndex counting from
+// indices, and returns how many it appended.
+size_t buildMeshlets(unsigned int* indices, const size_t numIndices, const float* positions,
+	const size_t numVertices, const size_t maxVertices, const size_t maxTriangles, std::vector<Meshlet> &meshlets);
@@ -0,0 +1,466 @@
+#include <vector>
+#include <algorithm>
+#include <cmath>
+
+#include "MeshSimplifier.h"
+#include "PositionBounds.h"
+
+// how strongly a border edge's end resists leaving the edge's line, next to a surface vertex
+// leaving its planes
+static const double borderWeight = 4.0;
+
+// a pass may go past the cost of the cheapest collapses it needs by this factor, so it does not
+// stop early while leaving equally cheap ones for the next pass
+static const double passErrorSlack = 1.5;
+
+// the planes around a position, as a symmetric 4x4 matrix [A b; b c] whose quadratic form sums
+// their weighted squared distances
+struct Quadric {
+	double a00, a01, a02, a11, a12, a22;
+	double b0, b1, b2;
+	double c;
+	double weight;
+};
+typedef struct Quadric Quadric;
+
+// moving position from onto position to, and what that costs
+struct Collapse {
+	unsigned int from;
+	unsigned int to;
+	double cost;
+};
+typedef struct Collapse Collapse;
+
+static void addPlane(Quadric &q, const double* n, const double d, const double w) {
+	q.a00 += w * n[0] * n[0];
+	q.a01 += w * n[0] * n[1];
+	q.a02 += w * n[0] * n[2];
+	q.a11 += w * n[1] * n[1];
+	q.a12 += w * n[1] * n[2];
+	q.a22 += w * n[2] * n[2];
+	q.b0 += w * n[0] * d;
+	q.b1 += w * n[1] * d;
+	q.b2 += w * n[2] * d;
+	q.c += w * d * d;
+	q.weight += w;
+}
+
+static void addQuadric(Quadric &q, const Quadric &other) {
+	q.a00 += other.a00;
+	q.a01 += other.a01;
+	q.a02 += other.a02;
+	q.a11 += other.a11;
+	q.a12 += other.a12;
+	q.a22 += other.a22;
+	q.b0 += other.b0;
+	q.b1 += other.b1;
+	q.b2 += other.b2;
+	q.c += other.c;
+	q.weight += other.weight;
+}
+
+// the weighted mean squared distance of p from the planes of both quadrics
+static double collapseError(const Quadric &q, const Quadric &other, const float* p) {
+	double x = p[0], y = p[1], z = p[2];
+	double a00 = q.a00 + other.a00, a01 = q.a01 + other.a01, a02 = q.a02 + other.a02;
+	double a11 = q.a11 + other.a11, a12 = q.a12 + other.a12, a22 = q.a22 + other.a22;
+	double error = a00 * x * x + a11 * y * y + a22 * z * z + 2.0 * (a01 * x * y + a02 * x * z + a12 * y * z)
+		+ 2.0 * ((q.b0 + other.b0) * x + (q.b1 + other.b1) * y + (q.b2 + other.b2) * z) + q.c + other.c;
+	double weight = q.weight + other.weight;
+	return weight > 0.0 ? fabs(error) / weight : 0.0;
+}
+
+static void cross(const double* a, const double* b, double* result) {
+	result[0] = a[1] * b[2] - a[2] * b[1];
+	result[1] = a[2] * b[0] - a[0] * b[2];
+	result[2] = a[0] * b[1] - a[1] * b[0];
+}
+
+// numbers the distinct positions, and lists the vertices at each: wedges[firstWedge[p]] up to
+// wedges[firstWedge[p + 1]]
+static size_t weldPositions(const float* positions, const size_t numVertices, std::vector<unsigned int> &positionIds,
+	std::vector<unsigned int> &firstWedge, std::vector<unsigned int> &wedges) {
+	wedges.resize(numVertices);
+	for (size_t v = 0; v < numVertices; v++) {
+		wedges[v] = (unsigned int)v;
+	}
+	std::sort(wedges.begin(), wedges.end(), [positions](unsigned int a, unsigned int b) {
+		const float* pa = positions + a * 3;
+		const float* pb = positions + b * 3;
+		if (pa[0] != pb[0]) {
+			return pa[0] < pb[0];
+		}
+		if (pa[1] != pb[1]) {
+			return pa[1] < pb[1];
+		}
+		if (pa[2] != pb[2]) {
+			return pa[2] < pb[2];
+		}
+		return a < b;
+	});
+
+	positionIds.resize(numVertices);
+	firstWedge.clear();
+	for (size_t w = 0; w < numVertices; w++) {
+		const float* p = positions + wedges[w] * 3;
+		const float* previous = w > 0 ? positions + wedges[w - 1] * 3 : nullptr;
+		if (previous == nullptr || p[0] != previous[0] || p[1] != previous[1] || p[2] != previous[2]) {
+			firstWedge.push_back((unsigned int)w);
+		}
+		positionIds[wedges[w]] = (unsigned int)firstWedge.size() - 1;
+	}
+	size_t numPositions = firstWedge.size();
+	firstWedge.push_back((unsigned int)numVertices);
+	return numPositions;
+}
+
+// finds the position of every corner, and lists the triangles around each position:
+// adjacent[firstAdjacent[p]] up to adjacent[firstAdjacent[p + 1]]
+static void buildAdjacency(const std::vector<unsigned int> &triangles, const std::vector<unsigned int> &positionIds,
+	const size_t numPositions, std::vector<unsigned int> &corners, std::vector<unsigned int> &firstAdjacent,
+	std::vector<unsigned int> &adjacent) {
+	corners.resize(triangles.size());
+	for (size_t i = 0; i < triangles.size(); i++) {
+		corners[i] = positionIds[triangles[i]];
+	}
+	firstAdjacent.assign(numPositions + 1, 0);
+	for (size_t i = 0; i < triangles.size(); i++) {
+		firstAdjacent[corners[i] + 1]++;
+	}
+	for (size_t p = 0; p < numPositions; p++) {
+		firstAdjacent[p + 1] += firstAdjacent[p];
+	}
+	adjacent.resize(triangles.size());
+	std::vector<unsigned int> next(firstAdjacent.begin(), firstAdjacent.end() - 1);
+	for (size_t i = 0; i < triangles.size(); i++) {
+		adjacent[next[corners[i]]++] = (unsigned int)(i / 3);
+	}
+}
+
+// whether a triangle, given by the positions of its corners, runs from position from to position to
+static inline bool hasDirectedEdge(const unsigned int* triangle, const unsigned int from, const unsigned int to) {
+	unsigned int a = triangle[0], b = triangle[1], c = triangle[2];
+	return (a == from && b == to) || (b == from && c == to) || (c == from && a == to);
+}
+
+// finds, for the edge starting at each corner, whether a triangle of the same group runs along it
+// the other way (if not, it is a border), and marks the positions on an edge that another triangle
+// runs along the same way, or that more than two triangles share, as complex
+static void classifyEdges(const std::vector<unsigned int> &corners, const std::vector<unsigned int> &triangleGroups,
+	const std::vector<unsigned int> &firstAdjacent, const std::vector<unsigned int> &adjacent,
+	std::vector<unsigned char> &twins, std::vector<unsigned char> &complex) {
+	twins.assign(corners.size(), 0);
+	std::fill(complex.begin(), complex.end(), 0);
+	for (size_t i = 0; i < corners.size(); i++) {
+		size_t t = i / 3;
+		unsigned int from = corners[i];
+		unsigned int to = corners[t * 3 + (i + 1) % 3];
+
+		unsigned int backwards = 0;
+		for (unsigned int a = firstAdjacent[to]; a < firstAdjacent[to + 1]; a++) {
+			unsigned int other = adjacent[a];
+			if (other != t && hasDirectedEdge(&corners[other * 3], to, from)) {
+				backwards++;
+				twins[i] |= triangleGroups[other] == triangleGroups[t] ? 1 : 0;
+			}
+		}
+		bool shared = backwards > 1;
+		for (unsigned int a = firstAdjacent[from]; a < firstAdjacent[from + 1] && !shared; a++) {
+			unsigned int other = adjacent[a];
+			shared = other != t && hasDirectedEdge(&corners[other * 3], from, to);
+		}
+		if (shared) {
+			complex[from] = complex[to] = 1;
+		}
+	}
+}
+
+// whether moving position from onto position to turns any of the triangles around it over
+static bool flipsTriangles(const unsigned int from, const unsigned int to, const std::vector<unsigned int> &corners,
+	const float* positions, const std::vector<unsigned int> &positionVertex, const std::vector<unsigned int> &firstAdjacent,
+	const std::vector<unsigned int> &adjacent) {
+	for (unsigned int a = firstAdjacent[from]; a < firstAdjacent[from + 1]; a++) {
+		const unsigned int* ids = &corners[adjacent[a] * 3];
+		if (ids[0] == to || ids[1] == to || ids[2] == to) {
+			// this one collapses away
+			continue;
+		}
+
+		double corners[3][3], moved[3][3];
+		for (int c = 0; c < 3; c++) {
+			const float* p = positions + positionVertex[ids[c]] * 3;
+			const float* q = positions + positionVertex[ids[c] == from ? to : ids[c]] * 3;
+			for (int axis = 0; axis < 3; axis++) {
+				corners[c][axis] = p[axis];
+				moved[c][axis] = q[axis];
+			}
+		}
+		double e1[3], e2[3], m1[3], m2[3], before[3], after[3];
+		for (int axis = 0; axis < 3; axis++) {
+			e1[axis] = corners[1][axis] - corners[0][axis];
+			e2[axis] = corners[2][axis] - corners[0][axis];
+			m1[axis] = moved[1][axis] - moved[0][axis];
+			m2[axis] = moved[2][axis] - moved[0][axis];
+		}
+		cross(e1, e2, before);
+		cross(m1, m2, after);
+		if (before[0] * after[0] + before[1] * after[1] + before[2] * after[2] <= 0.0) {
+			return true;
+		}
+	}
+	return false;
+}
+
+// the vertex at position to whose attributes are closest to vertex's
+static unsigned int closestWedge(const unsigned int vertex, const unsigned int to, const float* attributes,
+	const size_t attributeSize, const std::vector<unsigned int> &firstWedge, const std::vector<unsigned int> &wedges) {
+	unsigned int best = wedges[firstWedge[to]];
+	if (attributes == nullptr) {
+		return best;
+	}
+	float bestDistance = -1.0f;
+	const float* own = attributes + vertex * attributeSize;
+	for (unsigned int w = firstWedge[to]; w < firstWedge[to + 1]; w++) {
+		const float* other = attributes + wedges[w] * attributeSize;
+		float distance = 0.0f;
+		for (size_t a = 0; a < attributeSize; a++) {
+			distance += (own[a] - other[a]) * (own[a] - other[a]);
+		}
+		if (bestDistance < 0.0f || distance < bestDistance) {
+			bestDistance = distance;
+			best = wedges[w];
+		}
+	}
+	return best;
+}
+
+size_t simplifyMesh(unsigned int* destination, const unsigned int* indices, const size_t numIndices,
+	const float* positions, const float* attributes, const size_t attributeSize, const size_t numVertices,
+	const unsigned int* groups, unsigned int* destinationGroups, const size_t targetIndices, const float targetError,
+	float &error) {
+	error = 0.0f;
+
+	std::vector<unsigned int> positionIds, firstWedge, wedges;
+	size_t numPositions = weldPositions(positions, numVertices, positionIds, firstWedge, wedges);
+	std::vector<unsigned int> positionVertex(numPositions);
+	for (size_t p = 0; p < numPositions; p++) {
+		positionVertex[p] = wedges[firstWedge[p]];
+	}
+
+	// the working triangles, without any that are already degenerate
+	std::vector<unsigned int> triangles;
+	std::vector<unsigned int> triangleGroups;
+	triangles.reserve(numIndices);
+	triangleGroups.reserve(numIndices / 3);
+	for (size_t t = 0; t < numIndices / 3; t++) {
+		const unsigned int* triangle = indices + t * 3;
+		unsigned int a = positionIds[triangle[0]], b = positionIds[triangle[1]], c = positionIds[triangle[2]];
+		if (a != b && b != c && c != a) {
+			triangles.insert(triangles.end(), triangle, triangle + 3);
+			triangleGroups.push_back(groups != nullptr ? groups[t] : 0);
+		}
+	}
+
+	PositionBounds bounds;
+	computePositionBounds(positions, numVertices, bounds);
+	double extent = 0.0;
+	for (int axis = 0; axis < 3; axis++) {
+		extent = std::max(extent, (double)(bounds.max[axis] - bounds.min[axis]));
+	}
+	double errorLimit = (double)targetError * extent * (double)targetError * extent;
+
+	// every position starts with the planes of its triangles, weighted by area, and those through
+	// its border edges at right angles to the surface
+	std::vector<unsigned int> corners, firstAdjacent, adjacent;
+	std::vector<unsigned char> twins;
+	std::vector<unsigned char> border(numPositions), complex(numPositions), locked(numPositions);
+	buildAdjacency(triangles, positionIds, numPositions, corners, firstAdjacent, adjacent);
+	classifyEdges(corners, triangleGroups, firstAdjacent, adjacent, twins, complex);
+	Quadric empty = { 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0 };
+	std::vector<Quadric> quadrics(numPositions, empty);
+	for (size_t t = 0; t < triangles.size() / 3; t++) {
+		double corners[3][3];
+		unsigned int ids[3];
+		for (int c = 0; c < 3; c++) {
+			ids[c] = positionIds[triangles[t * 3 + c]];
+			const float* p = positions + triangles[t * 3 + c] * 3;
+			corners[c][0] = p[0];
+			corners[c][1] = p[1];
+			corners[c][2] = p[2];
+		}
+		double e1[3] = { corners[1][0] - corners[0][0], corners[1][1] - corners[0][1], corners[1][2] - corners[0][2] };
+		double e2[3] = { corners[2][0] - corners[0][0], corners[2][1] - corners[0][1], corners[2][2] - corners[0][2] };
+		double normal[3];
+		cross(e1, e2, normal);
+		double length = sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+		if (length == 0.0) {
+			continue;
+		}
+		for (int axis = 0; axis < 3; axis++) {
+			normal[axis] /= length;
+		}
+		double d = -(normal[0] * corners[0][0] + normal[1] * corners[0][1] + normal[2] * corners[0][2]);
+		for (int c = 0; c < 3; c++) {
+			addPlane(quadrics[ids[c]], normal, d, length * 0.5);
+		}
+
+		for (int c = 0; c < 3; c++) {
+			int next = (c + 1) % 3;
+			if (twins[t * 3 + c]) {
+				continue;
+			}
+			double edge[3] = { corners[next][0] - corners[c][0], corners[next][1] - corners[c][1],
+				corners[next][2] - corners[c][2] };
+			double edgeLengthSquared = edge[0] * edge[0] + edge[1] * edge[1] + edge[2] * edge[2];
+			double side[3];
+			cross(edge, normal, side);
+			double sideLength = sqrt(side[0] * side[0] + side[1] * side[1] + side[2] * side[2]);
+			if (sideLength == 0.0) {
+				continue;
+			}
+			for (int axis = 0; axis < 3; axis++) {
+				side[axis] /= sideLength;
+			}
+			double sideD = -(side[0] * corners[c][0] + side[1] * corners[c][1] + side[2] * corners[c][2]);
+			addPlane(quadrics[ids[c]], side, sideD, edgeLengthSquared * borderWeight);
+			addPlane(quadrics[ids[next]], side, sideD, edgeLengthSquared * borderWeight);
+		}
+	}
+
+	std::vector<unsigned int> collapseTo(numPositions);
+	for (size_t p = 0; p < numPositions; p++) {
+		collapseTo[p] = (unsigned int)p;
+	}
+	std::vector<Collapse> collapses;
+	double reached = 0.0;
+
+	// each pass picks a set of collapses that touch separate triangles, cheapest first, and
+	// applies them all; the positions around each collapse wait for the next pass
+	// the last few collapses to an exact count would each take a whole pass, so close is enough
+	size_t stopIndices = targetIndices + numIndices / 100;
+	for (bool first = true; triangles.size() > stopIndices; first = false) {
+		// a border position only slides along its border, and a complex one stays put
+		if (!first) {
+			buildAdjacency(triangles, positionIds, numPositions, corners, firstAdjacent, adjacent);
+			classifyEdges(corners, triangleGroups, firstAdjacent, adjacent, twins, complex);
+		}
+		std::fill(border.begin(), border.end(), 0);
+		for (size_t i = 0; i < triangles.size(); i++) {
+			if (!twins[i]) {
+				border[corners[i]] = 1;
+				border[corners[i - i % 3 + (i + 1) % 3]] = 1;
+			}
+		}
+
+		// the cheaper allowed direction of every edge; an edge inside a group is seen from both
+		// its triangles, so only one of them offers it
+		collapses.clear();
+		for (size_t t = 0; t < triangles.size() / 3; t++) {
+			for (int c = 0; c < 3; c++) {
+				unsigned int a = corners[t * 3 + c];
+				unsigned int b = corners[t * 3 + (c + 1) % 3];
+				bool twin = twins[t * 3 + c] != 0;
+				if (twin && a > b) {
+					continue;
+				}
+				Collapse best = { 0, 0, -1.0 };
+				for (int direction = 0; direction < 2; direction++) {
+					unsigned int from = direction == 0 ? a : b;
+					unsigned int to = direction == 0 ? b : a;
+					if (complex[from] || (border[from] && twin)) {
+						continue;
+					}
+					double cost = collapseError(quadrics[from], quadrics[to], positions + positionVertex[to] * 3);
+					if (best.cost < 0.0 || cost < best.cost) {
+						best.from = from;
+						best.to = to;
+						best.cost = cost;
+					}
+				}
+				if (best.cost >= 0.0) {
+					collapses.push_back(best);
+				}
+			}
+		}
+		if (collapses.empty()) {
+			break;
+		}
+
+		// a collapse takes about two triangles with it; only the collapses cheap enough for this
+		// pass need sorting
+		size_t goal = (triangles.size() - targetIndices) / 6 + 1;
+		std::vector<Collapse>::iterator goalCollapse = collapses.begin() + (std::min(goal, collapses.size()) - 1);
+		std::nth_element(collapses.begin(), goalCollapse, collapses.end(), [](const Collapse &a, const Collapse &b) {
+			return a.cost < b.cost;
+		});
+		double limit = std::min(errorLimit, goalCollapse->cost * passErrorSlack);
+		std::vector<Collapse>::iterator cheap = std::partition(collapses.begin(), collapses.end(),
+			[limit](const Collapse &collapse) { return collapse.cost <= limit; });
+		std::sort(collapses.begin(), cheap, [](const Collapse &a, const Collapse &b) {
+			return a.cost < b.cost;
+		});
+		collapses.erase(cheap, collapses.end());
+
+		std::fill(locked.begin(), locked.end(), 0);
+		size_t performed = 0;
+		for (size_t i = 0; i < collapses.size() && performed < goal; i++) {
+			const Collapse &collapse = collapses[i];
+			if (collapse.cost > limit) {
+				break;
+			}
+			if (locked[collapse.from] || locked[collapse.to]) {
+				continue;
+			}
+			if (flipsTriangles(collapse.from, collapse.to, corners, positions, positionVertex, firstAdjacent, adjacent)) {
+				continue;
+			}
+
+			collapseTo[collapse.from] = collapse.to;
+			for (unsigned int a = firstAdjacent[collapse.from]; a < firstAdjacent[collapse.from + 1]; a++) {
+				const unsigned int* triangle = &corners[adjacent[a] * 3];
+				locked[triangle[0]] = 1;
+				locked[triangle[1]] = 1;
+				locked[triangle[2]] = 1;
+			}
+			addQuadric(quadrics[collapse.to], quadrics[collapse.from]);
+			reached = std::max(reached, collapse.cost);
+			performed++;
+		}
+		if (performed == 0) {
+			break;
+		}
+
+		// move the corners, and drop the triangles that collapsed
+		size_t kept = 0;
+		for (size_t t = 0; t < triangles.size() / 3; t++) {
+			unsigned int triangle[3];
+			for (int c = 0; c < 3; c++) {
+				unsigned int vertex = triangles[t * 3 + c];
+				unsigned int position = positionIds[vertex];
+				triangle[c] = collapseTo[position] == position ? vertex
+					: closestWedge(vertex, collapseTo[position], attributes, attributeSize, firstWedge, wedges);
+			}
+			unsigned int a = positionIds[triangle[0]], b = positionIds[triangle[1]], c = positionIds[triangle[2]];
+			if (a == b || b == c || c == a) {
+				continue;
+			}
+			triangles[kept * 3 + 0] = triangle[0];
+			triangles[kept * 3 + 1] = triangle[1];
+			triangles[kept * 3 + 2] = triangle[2];
+			triangleGroups[kept] = triangleGroups[t];
+			kept++;
+		}
+		triangles.resize(kept * 3);
+		triangleGroups.resize(kept);
+		for (size_t i = 0; i < collapses.size(); i++) {
+			collapseTo[collapses[i].from] = collapses[i].from;
+		}
+	}
+
+	std::copy(triangles.begin(), triangles.end(), destination);
+	if (destinationGroups != nullptr) {
+		std::copy(triangleGroups.begin(), triangleGroups.end(), destinationGroups);
+	}
+	error = (float)sqrt(reached);
+	return triangles.size();
+}
@@ -0,0 +1,25 @@
+#include <cstddef>
+
+#pragma once
+
+// simplifies an indexed triangle list by collapsing edges, cheapest first by Garland and Heckbert's
+// quadric error metric, and writes the surviving triangles to destination (which must hold
+// numIndices) in their original order, returning how many indices it wrote. A vertex only ever
+// moves onto another existing vertex, so the result indexes the same vertex arrays.
+//
+// Collapses work on positions rather than vertices: the vertices that share a position (an
+// attribute seam) move together, each onto the vertex at the target position whose attributes
+// (attributeSize floats per vertex, e.g. texture coordinates and normal; may be null) are closest.
+// Edges on the border of the surface, or between triangles of different groups (one id per
+// triangle, e.g. the material; may be null), only slide along themselves, so borders and group
+// outlines keep their shape. destinationGroups (numIndices / 3 of them; may be null) receives the
+// group of each surviving triangle.
+//
+// Stops once no more than targetIndices remain (give or take 1% of numIndices), or when the next
+// collapse would move the surface further than targetError, as a fraction of the mesh's largest
+// extent. error reports the quadric estimate of how far the surface moved, in mesh units; the
+// largest true distance tends to be two to three times that.
+size_t simplifyMesh(unsigned int* destination, const unsigned int* indices, const size_t numIndices,
+	const float* positions, const float* attributes, const size_t attributeSize, const size_t numVertices,
+	const unsigned int* groups, unsigned int* destinationGroups, const size_t targetIndices, const float targetError,
+	float &error);
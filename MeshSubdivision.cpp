@@ -0,0 +1,371 @@
+#include <vector>
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+
+#include "MeshSubdivision.h"
+#include "HalfEdgeMesh.h"
+#include "Parallel.h"
+#include "MemoryArena.h"
+
+// triangles and vertices are handed to threads in runs of at least this many
+static const size_t minTrianglesPerThread = 1 << 12;
+static const size_t minVerticesPerThread = 1 << 12;
+
+// how a triangle is split: left alone, in two across one edge, or in four
+static const unsigned char SPLIT_NONE = 0;
+static const unsigned char SPLIT_BISECT = 1;
+static const unsigned char SPLIT_REFINE = 2;
+
+static inline float edgeLength(const float* a, const float* b) {
+	float d[3] = { b[0] - a[0], b[1] - a[1], b[2] - a[2] };
+	return sqrtf(d[0] * d[0] + d[1] * d[1] + d[2] * d[2]);
+}
+
+// a triangle's unit normal, or zero for a degenerate one
+static inline void faceNormal(const float* a, const float* b, const float* c, float* normal) {
+	float ab[3] = { b[0] - a[0], b[1] - a[1], b[2] - a[2] };
+	float ac[3] = { c[0] - a[0], c[1] - a[1], c[2] - a[2] };
+	normal[0] = ab[1] * ac[2] - ab[2] * ac[1];
+	normal[1] = ab[2] * ac[0] - ab[0] * ac[2];
+	normal[2] = ab[0] * ac[1] - ab[1] * ac[0];
+	float length = sqrtf(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+	float inverseLength = length > 0.0f ? 1.0f / length : 0.0f;
+	normal[0] *= inverseLength;
+	normal[1] *= inverseLength;
+	normal[2] *= inverseLength;
+}
+
+// whether the edge of half-edge h is split: its own triangle or the one across it is refined
+static inline bool edgeSplit(const HalfEdgeMesh &halfEdges, const unsigned char* refined, const unsigned int h) {
+	unsigned int twin = halfEdges.twins[h];
+	return refined[h / 3] != 0 || (twin != HALF_EDGE_NONE && refined[twin / 3] != 0);
+}
+
+// whether the two triangles of an edge use the same vertices at both its ends, and so can share
+// the vertex that splits it; across a seam each side gets its own
+static inline bool sharesEdgeVertices(const unsigned int* indices, const unsigned int h, const unsigned int twin) {
+	return indices[h] == indices[nextHalfEdge(twin)] && indices[nextHalfEdge(h)] == indices[twin];
+}
+
+// the running totals of counts, by the same ranges parallelFor() hands out: first[i] becomes the
+// sum of the counts before i, and the grand total is returned
+static size_t prefixSum(const unsigned int threads, const size_t count, const size_t minPerThread, unsigned int* first) {
+	std::vector<size_t> rangeTotals(threads + 1, 0);
+	parallelFor(threads, count, minPerThread, [&](unsigned int thread, size_t begin, size_t end) {
+		size_t total = 0;
+		for (size_t i = begin; i < end; i++) {
+			total += first[i];
+		}
+		rangeTotals[thread + 1] = total;
+	});
+	for (unsigned int t = 0; t < threads; t++) {
+		rangeTotals[t + 1] += rangeTotals[t];
+	}
+	parallelFor(threads, count, minPerThread, [&](unsigned int thread, size_t begin, size_t end) {
+		size_t total = rangeTotals[thread];
+		for (size_t i = begin; i < end; i++) {
+			unsigned int value = first[i];
+			first[i] = (unsigned int)total;
+			total += value;
+		}
+	});
+	return rangeTotals[threads];
+}
+
+// flags in refined (if not null) the triangles whose normal is more than curvatureAngle degrees
+// from a neighbour's and whose longest edge is over minEdgeLength, and returns the longest edge of
+// any triangle that bends that much, whatever its size
+static float findCurvedTriangles(const HalfEdgeMesh &halfEdges, const unsigned int* indices, const float* positions,
+	const size_t numTriangles, const float curvatureAngle, const float minEdgeLength, const unsigned int threads,
+	MemoryArena &arena, unsigned char* refined) {
+	float* faceNormals = arena.allocate<float>(numTriangles * 3);
+	parallelFor(threads, numTriangles, minTrianglesPerThread, [&](unsigned int, size_t begin, size_t end) {
+		for (size_t t = begin; t < end; t++) {
+			faceNormal(positions + (size_t)indices[t * 3] * 3, positions + (size_t)indices[t * 3 + 1] * 3,
+				positions + (size_t)indices[t * 3 + 2] * 3, faceNormals + t * 3);
+		}
+	});
+
+	float minCosine = cosf(curvatureAngle * 3.14159265f / 180.0f);
+	std::vector<float> curvedEdgeLengths(threads, 0.0f);
+	parallelFor(threads, numTriangles, minTrianglesPerThread, [&](unsigned int thread, size_t begin, size_t end) {
+		for (size_t t = begin; t < end; t++) {
+			const float* normal = faceNormals + t * 3;
+			bool curved = false;
+			float longestEdge = 0.0f;
+			for (unsigned int c = 0; c < 3; c++) {
+				unsigned int h = (unsigned int)(t * 3 + c);
+				unsigned int twin = halfEdges.twins[h];
+				// a degenerate triangle, with no normal, bends against nothing
+				if (twin != HALF_EDGE_NONE) {
+					const float* other = faceNormals + (size_t)(twin / 3) * 3;
+					float cosine = normal[0] * other[0] + normal[1] * other[1] + normal[2] * other[2];
+					bool degenerate = (normal[0] == 0.0f && normal[1] == 0.0f && normal[2] == 0.0f)
+						|| (other[0] == 0.0f && other[1] == 0.0f && other[2] == 0.0f);
+					curved = curved || (!degenerate && cosine < minCosine);
+				}
+				float length = edgeLength(positions + (size_t)indices[h] * 3, positions + (size_t)indices[nextHalfEdge(h)] * 3);
+				longestEdge = length > longestEdge ? length : longestEdge;
+			}
+			if (refined != nullptr) {
+				refined[t] = curved && longestEdge > minEdgeLength;
+			}
+			if (curved && longestEdge > curvedEdgeLengths[thread]) {
+				curvedEdgeLengths[thread] = longestEdge;
+			}
+		}
+	});
+	float curvedEdgeLength = 0.0f;
+	for (unsigned int t = 0; t < threads; t++) {
+		curvedEdgeLength = curvedEdgeLengths[t] > curvedEdgeLength ? curvedEdgeLengths[t] : curvedEdgeLength;
+	}
+	return curvedEdgeLength;
+}
+
+void subdivideMesh(const SubdivisionMesh &source, const float curvatureAngle, const float minEdgeLength,
+	const unsigned int numThreads, SubdivisionMesh &destination, SubdivisionStats &stats) {
+	unsigned int threads = resolveThreadCount(numThreads);
+	const unsigned int* indices = source.indices.data();
+	const float* positions = source.positions.data();
+	const float* textureCoords = source.textureCoords.data();
+	const float* normals = source.normals.data();
+	size_t numTriangles = source.indices.size() / 3;
+	size_t numVertices = source.positions.size() / 3;
+	MemoryArena arena;
+
+	HalfEdgeMesh halfEdges;
+	buildHalfEdgeMesh(indices, numTriangles * 3, positions, numVertices, threads, halfEdges);
+
+	// the triangles that bend away from a neighbour by more than the curvature angle, as long as
+	// they are not small enough already
+	unsigned char* refined = arena.allocate<unsigned char>(numTriangles);
+	stats.curvedEdgeLength = findCurvedTriangles(halfEdges, indices, positions, numTriangles, curvatureAngle, minEdgeLength,
+		threads, arena, refined);
+
+	// a triangle with two split edges is refined as well, which may split more edges, until none
+	// is left with two; each round reads one flag array and writes the other
+	unsigned char* promoted = arena.allocate<unsigned char>(numTriangles);
+	std::vector<unsigned char> changed(threads);
+	bool anyChanged = true;
+	while (anyChanged) {
+		std::fill(changed.begin(), changed.end(), 0);
+		parallelFor(threads, numTriangles, minTrianglesPerThread, [&](unsigned int thread, size_t begin, size_t end) {
+			for (size_t t = begin; t < end; t++) {
+				promoted[t] = refined[t];
+				if (refined[t] == 0) {
+					unsigned int numSplit = 0;
+					for (unsigned int c = 0; c < 3; c++) {
+						numSplit += edgeSplit(halfEdges, refined, (unsigned int)(t * 3 + c));
+					}
+					if (numSplit >= 2) {
+						promoted[t] = 1;
+						changed[thread] = 1;
+					}
+				}
+			}
+		});
+		std::swap(refined, promoted);
+		anyChanged = false;
+		for (unsigned int t = 0; t < threads; t++) {
+			anyChanged = anyChanged || changed[t] != 0;
+		}
+	}
+
+	// how each triangle splits, how many vertices it adds (one per split edge it owns: an edge's
+	// lower half-edge owns its vertex when both sides share it, and each side owns its own across
+	// a seam), and how many triangles it becomes
+	unsigned char* splits = arena.allocate<unsigned char>(numTriangles);
+	unsigned int* firstNewVertex = arena.allocate<unsigned int>(numTriangles);
+	unsigned int* firstChild = arena.allocate<unsigned int>(numTriangles);
+	parallelFor(threads, numTriangles, minTrianglesPerThread, [&](unsigned int, size_t begin, size_t end) {
+		for (size_t t = begin; t < end; t++) {
+			unsigned int numSplit = 0;
+			unsigned int numOwned = 0;
+			for (unsigned int c = 0; c < 3; c++) {
+				unsigned int h = (unsigned int)(t * 3 + c);
+				if (!edgeSplit(halfEdges, refined, h)) {
+					continue;
+				}
+				numSplit++;
+				unsigned int twin = halfEdges.twins[h];
+				numOwned += twin == HALF_EDGE_NONE || h < twin || !sharesEdgeVertices(indices, h, twin);
+			}
+			splits[t] = refined[t] != 0 ? SPLIT_REFINE : (numSplit == 1 ? SPLIT_BISECT : SPLIT_NONE);
+			firstNewVertex[t] = numOwned;
+			firstChild[t] = splits[t] == SPLIT_REFINE ? 4 : (splits[t] == SPLIT_BISECT ? 2 : 1);
+		}
+	});
+	size_t numNewVertices = prefixSum(threads, numTriangles, minTrianglesPerThread, firstNewVertex);
+	size_t numChildren = prefixSum(threads, numTriangles, minTrianglesPerThread, firstChild);
+
+	size_t numDestinationVertices = numVertices + numNewVertices;
+	destination.positions.resize(numDestinationVertices * 3);
+	destination.textureCoords.resize(numDestinationVertices * 2);
+	destination.normals.resize(numDestinationVertices * 3);
+	float* newPositions = destination.positions.data();
+	float* newTextureCoords = destination.textureCoords.data();
+	float* newNormals = destination.normals.data();
+
+	// the vertex splitting each split half-edge's edge, made by its owner: Loop's edge mask of the
+	// two ends and the two opposite corners, and the ends' attributes interpolated
+	unsigned int* edgeVertices = arena.allocate<unsigned int>(numTriangles * 3);
+	parallelFor(threads, numTriangles, minTrianglesPerThread, [&](unsigned int, size_t begin, size_t end) {
+		for (size_t t = begin; t < end; t++) {
+			unsigned int next = (unsigned int)numVertices + firstNewVertex[t];
+			for (unsigned int c = 0; c < 3; c++) {
+				unsigned int h = (unsigned int)(t * 3 + c);
+				edgeVertices[h] = HALF_EDGE_NONE;
+				if (!edgeSplit(halfEdges, refined, h)) {
+					continue;
+				}
+				unsigned int twin = halfEdges.twins[h];
+				if (twin != HALF_EDGE_NONE && h > twin && sharesEdgeVertices(indices, h, twin)) {
+					continue;
+				}
+
+				unsigned int v = next++;
+				edgeVertices[h] = v;
+				const float* a = positions + (size_t)indices[h] * 3;
+				const float* b = positions + (size_t)indices[nextHalfEdge(h)] * 3;
+				float* position = newPositions + (size_t)v * 3;
+				if (twin != HALF_EDGE_NONE) {
+					const float* c0 = positions + (size_t)indices[previousHalfEdge(h)] * 3;
+					const float* c1 = positions + (size_t)indices[previousHalfEdge(twin)] * 3;
+					for (int axis = 0; axis < 3; axis++) {
+						position[axis] = 0.375f * (a[axis] + b[axis]) + 0.125f * (c0[axis] + c1[axis]);
+					}
+				} else {
+					for (int axis = 0; axis < 3; axis++) {
+						position[axis] = 0.5f * (a[axis] + b[axis]);
+					}
+				}
+
+				const float* uvA = textureCoords + (size_t)indices[h] * 2;
+				const float* uvB = textureCoords + (size_t)indices[nextHalfEdge(h)] * 2;
+				newTextureCoords[(size_t)v * 2] = 0.5f * (uvA[0] + uvB[0]);
+				newTextureCoords[(size_t)v * 2 + 1] = 0.5f * (uvA[1] + uvB[1]);
+
+				const float* normalA = normals + (size_t)indices[h] * 3;
+				const float* normalB = normals + (size_t)indices[nextHalfEdge(h)] * 3;
+				float* normal = newNormals + (size_t)v * 3;
+				float sum[3] = { normalA[0] + normalB[0], normalA[1] + normalB[1], normalA[2] + normalB[2] };
+				float length = sqrtf(sum[0] * sum[0] + sum[1] * sum[1] + sum[2] * sum[2]);
+				for (int axis = 0; axis < 3; axis++) {
+					normal[axis] = length > 0.0f ? sum[axis] / length : normalA[axis];
+				}
+			}
+		}
+	});
+	// the other side of a shared edge takes its owner's vertex
+	parallelFor(threads, numTriangles * 3, minTrianglesPerThread * 3, [&](unsigned int, size_t begin, size_t end) {
+		for (size_t h = begin; h < end; h++) {
+			unsigned int twin = halfEdges.twins[h];
+			if (edgeVertices[h] == HALF_EDGE_NONE && twin != HALF_EDGE_NONE && edgeSplit(halfEdges, refined, (unsigned int)h)) {
+				edgeVertices[h] = edgeVertices[twin];
+			}
+		}
+	});
+
+	// the old vertices keep their attributes; a position whose closed ring is all refined moves
+	// by Loop's vertex mask, worked out once for the vertex standing for it
+	const unsigned int* positionIds = halfEdges.positionIds.data();
+	memcpy(newTextureCoords, textureCoords, numVertices * 2 * sizeof(float));
+	memcpy(newNormals, normals, numVertices * 3 * sizeof(float));
+	parallelFor(threads, numVertices, minVerticesPerThread, [&](unsigned int, size_t begin, size_t end) {
+		for (size_t v = begin; v < end; v++) {
+			const float* position = positions + v * 3;
+			float* newPosition = newPositions + v * 3;
+			newPosition[0] = position[0];
+			newPosition[1] = position[1];
+			newPosition[2] = position[2];
+
+			unsigned int first = halfEdges.vertexEdges[v];
+			if (first == HALF_EDGE_NONE) {
+				continue;
+			}
+			float sum[3] = { 0.0f, 0.0f, 0.0f };
+			unsigned int valence = 0;
+			bool smooth = true;
+			unsigned int h = first;
+			do {
+				smooth = refined[h / 3] != 0;
+				const float* neighbour = positions + (size_t)indices[nextHalfEdge(h)] * 3;
+				sum[0] += neighbour[0];
+				sum[1] += neighbour[1];
+				sum[2] += neighbour[2];
+				valence++;
+				h = nextRingHalfEdge(halfEdges, h);
+			} while (smooth && h != HALF_EDGE_NONE && h != first);
+
+			if (smooth && h == first && valence >= 3) {
+				float beta = valence == 3 ? 3.0f / 16.0f : 3.0f / (8.0f * valence);
+				float weight = 1.0f - valence * beta;
+				for (int axis = 0; axis < 3; axis++) {
+					newPosition[axis] = weight * position[axis] + beta * sum[axis];
+				}
+			}
+		}
+	});
+	// every vertex at the position follows it, which only reads the ones just written
+	parallelFor(threads, numVertices, minVerticesPerThread, [&](unsigned int, size_t begin, size_t end) {
+		for (size_t v = begin; v < end; v++) {
+			if (positionIds[v] != v) {
+				memcpy(newPositions + v * 3, newPositions + (size_t)positionIds[v] * 3, 3 * sizeof(float));
+			}
+		}
+	});
+
+	// each triangle's children, in its place, wound like it
+	destination.indices.resize(numChildren * 3);
+	destination.groups.resize(numChildren);
+	unsigned int* newIndices = destination.indices.data();
+	unsigned int* newGroups = destination.groups.data();
+	const unsigned int* groups = source.groups.data();
+	parallelFor(threads, numTriangles, minTrianglesPerThread, [&](unsigned int, size_t begin, size_t end) {
+		for (size_t t = begin; t < end; t++) {
+			const unsigned int* corners = indices + t * 3;
+			const unsigned int* middles = edgeVertices + t * 3;
+			unsigned int* child = newIndices + (size_t)firstChild[t] * 3;
+			unsigned int numTriangleChildren;
+			if (splits[t] == SPLIT_REFINE) {
+				unsigned int children[12] = {
+					corners[0], middles[0], middles[2],
+					middles[0], corners[1], middles[1],
+					middles[2], middles[1], corners[2],
+					middles[0], middles[1], middles[2]
+				};
+				memcpy(child, children, sizeof(children));
+				numTriangleChildren = 4;
+			} else if (splits[t] == SPLIT_BISECT) {
+				unsigned int c = middles[0] != HALF_EDGE_NONE ? 0 : (middles[1] != HALF_EDGE_NONE ? 1 : 2);
+				unsigned int from = corners[c], to = corners[(c + 1) % 3], opposite = corners[(c + 2) % 3];
+				unsigned int children[6] = { from, middles[c], opposite, middles[c], to, opposite };
+				memcpy(child, children, sizeof(children));
+				numTriangleChildren = 2;
+			} else {
+				memcpy(child, corners, 3 * sizeof(unsigned int));
+				numTriangleChildren = 1;
+			}
+			for (unsigned int i = 0; i < numTriangleChildren; i++) {
+				newGroups[firstChild[t] + i] = groups[t];
+			}
+		}
+	});
+
+	stats.numRefined = 0;
+	stats.numBisected = 0;
+	for (size_t t = 0; t < numTriangles; t++) {
+		stats.numRefined += splits[t] == SPLIT_REFINE;
+		stats.numBisected += splits[t] == SPLIT_BISECT;
+	}
+}
+
+float measureCurvedEdgeLength(const unsigned int* indices, const size_t numIndices, const float* positions,
+	const size_t numVertices, const float curvatureAngle, const unsigned int numThreads) {
+	unsigned int threads = resolveThreadCount(numThreads);
+	MemoryArena arena;
+	HalfEdgeMesh halfEdges;
+	buildHalfEdgeMesh(indices, numIndices, positions, numVertices, threads, halfEdges);
+	return findCurvedTriangles(halfEdges, indices, positions, numIndices / 3, curvatureAngle, 0.0f, threads, arena, nullptr);
+}
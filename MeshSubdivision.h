@@ -0,0 +1,45 @@
+#include <vector>
+#include <cstddef>
+
+#pragma once
+
+// a triangle mesh as subdivideMesh() reads and writes it: three floats of position, two of
+// texture coordinate and three of normal per vertex, and per triangle a group (e.g. the
+// material) that the triangles it is split into keep
+struct SubdivisionMesh {
+	std::vector<float> positions;
+	std::vector<float> textureCoords;
+	std::vector<float> normals;
+	std::vector<unsigned int> indices;
+	std::vector<unsigned int> groups;
+};
+typedef struct SubdivisionMesh SubdivisionMesh;
+
+// what a subdivideMesh() pass did: how many triangles it split into four, and how many into two
+// next to them, and the longest edge of the source's triangles that bend more than the curvature
+// angle, i.e. what still shows as facets at that level
+struct SubdivisionStats {
+	size_t numRefined;
+	size_t numBisected;
+	float curvedEdgeLength;
+};
+typedef struct SubdivisionStats SubdivisionStats;
+
+// one pass of adaptive Loop subdivision. A triangle is refined (split into four at its edge
+// midpoints) if its normal is more than curvatureAngle degrees from a neighbour's and its longest
+// edge is over minEdgeLength; a triangle with two split edges is refined too, and one with a
+// single split edge is bisected, so the result has no cracks. New edge vertices take Loop's edge
+// mask (the midpoint on a border), and an old vertex whose whole ring is refined takes Loop's
+// vertex mask, so the refined patches approach the smooth limit surface while the rest of the
+// mesh keeps its triangles. Texture coordinates and normals are interpolated, and split where the
+// source splits them, so seams stay seams. Triangles keep their order, each replaced by its
+// children, so ranges of one group stay contiguous. Every step runs on numThreads threads, over
+// ranges of triangles or of vertices, without atomics.
+void subdivideMesh(const SubdivisionMesh &source, const float curvatureAngle, const float minEdgeLength,
+	const unsigned int numThreads, SubdivisionMesh &destination, SubdivisionStats &stats);
+
+// the longest edge of the triangles of an indexed mesh that bend more than curvatureAngle degrees
+// against a neighbour, as a subdivideMesh() pass over it would report in its stats, without
+// building the subdivided mesh
+float measureCurvedEdgeLength(const unsigned int* indices, const size_t numIndices, const float* positions,
+	const size_t numVertices, const float curvatureAngle, const unsigned int numThreads);
@@ -1,224 +1,2489 @@
 #include <iostream>
-#include <fstream>
-#include <sstream>
 #include <string>
 #include <vector>
+#include <unordered_map>
+#include <cstdint>
+#include <climits>
+#include <cstring>
+#include <cmath>
+#include <charconv>
+#include <utility>
 #include <algorithm>
-#include <cstdio>
 
 #include "ObjMesh.h"
+#include "MappedFile.h"
+#include "Parallel.h"
+#include "MeshOptimizer.h"
+#include "MemoryArena.h"
+#include "PositionBounds.h"
+#include "VertexNormals.h"
+#include "MeshSimplifier.h"
+#include "GlbFile.h"
+#include "AssetPack.h"
+#include "HalfEdgeMesh.h"
+#include "MeshSubdivision.h"
 
-struct Triangle {
-	int a, b, c;
+// the whitespace that the line-based parser used to trim and tokenize on
+static inline bool isBlank(char ch) {
+	return ch == ' ' || ch == '\t' || ch == '\r' || ch == '\v' || ch == '\f';
+}
+
+static inline const char* skipBlanks(const char* p, const char* end) {
+	while (p < end && isBlank(*p)) {
+		p++;
+	}
+	return p;
+}
+
+// powers of ten that are exactly representable as floats
+static const float exactPowersOfTen[] = {
+	1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f, 1e6f, 1e7f, 1e8f, 1e9f, 1e10f
+};
+
+// parses a float the way "lineIn >> x" did: leading blanks and an optional '+' are allowed
+static inline const char* parseFloat(const char* p, const char* end, float &value) {
+	p = skipBlanks(p, end);
+	if (p < end && *p == '+') {
+		p++;
+	}
+
+	// fast path for plain "-123.456" numbers: when the digits fit in a float's 24-bit mantissa
+	// and the power of ten is exact, a single division is correctly rounded, so the result is
+	// bit-identical to what from_chars (and the old stream parser) would produce
+	const char* q = p;
+	bool negative = false;
+	if (q < end && *q == '-') {
+		negative = true;
+		q++;
+	}
+	unsigned int mantissa = 0;
+	int numDigits = 0;
+	int numFractionDigits = 0;
+	while (q < end && *q >= '0' && *q <= '9' && numDigits < 9) {
+		mantissa = mantissa * 10 + (*q - '0');
+		numDigits++;
+		q++;
+	}
+	if (q < end && *q == '.') {
+		q++;
+		while (q < end && *q >= '0' && *q <= '9' && numDigits < 9) {
+			mantissa = mantissa * 10 + (*q - '0');
+			numDigits++;
+			numFractionDigits++;
+			q++;
+		}
+	}
+	bool plainNumber = numDigits > 0 && (q == end || isBlank(*q));
+	if (plainNumber && mantissa <= (1u << 24) && numFractionDigits <= 10) {
+		value = (float)mantissa / exactPowersOfTen[numFractionDigits];
+		if (negative) {
+			value = -value;
+		}
+		return q;
+	}
+
+	std::from_chars_result result = std::from_chars(p, end, value);
+	if (result.ec != std::errc()) {
+		value = 0.0f;
+		return end;
+	}
+	return result.ptr;
+}
+
+// parses a face index: an optional sign and at least one digit; returns nullptr if there is none,
+// or if the digits run past what an int holds, rather than wrapping round to some other vertex
+static inline const char* parseIndex(const char* p, const char* end, int &value) {
+	bool negative = false;
+	if (p < end && (*p == '+' || *p == '-')) {
+		negative = (*p == '-');
+		p++;
+	}
+	if (p >= end || *p < '0' || *p > '9') {
+		return nullptr;
+	}
+	unsigned int magnitude = 0;
+	while (p < end && *p >= '0' && *p <= '9') {
+		unsigned int digit = (unsigned int)(*p - '0');
+		if (magnitude > (INT_MAX - digit) / 10) {
+			return nullptr;
+		}
+		magnitude = magnitude * 10 + digit;
+		p++;
+	}
+	value = negative ? -(int)magnitude : (int)magnitude;
+	return p;
+}
+
+// the size of the bounds along their longest axis, which auto-normalization divides by
+static inline float largestExtent(const PositionBounds &bounds) {
+	float maxDimension = bounds.max[0] - bounds.min[0];
+	if (bounds.max[1] - bounds.min[1] > maxDimension) {
+		maxDimension = bounds.max[1] - bounds.min[1];
+	}
+	if (bounds.max[2] - bounds.min[2] > maxDimension) {
+		maxDimension = bounds.max[2] - bounds.min[2];
+	}
+	return maxDimension;
+}
+
+// the kinds of line the parser acts on; anything else is skipped
+enum ObjLineType {
+	OBJ_LINE_OTHER,
+	OBJ_LINE_POSITION,
+	OBJ_LINE_TEXTURE_COORD,
+	OBJ_LINE_NORMAL,
+	OBJ_LINE_FACE,
+	OBJ_LINE_OBJECT,
+	OBJ_LINE_GROUP,
+	OBJ_LINE_USE_MATERIAL,
+	OBJ_LINE_MATERIAL_LIBRARY
+};
+
+// finds the end of the line starting at p and its type identifier [type, body), which is
+// everything up to the first blank after any leading blanks; body is left just past it
+static inline void splitLine(const char* p, const char* end, const char* &type, const char* &body, const char* &lineEnd) {
+	lineEnd = (const char*)memchr(p, '\n', end - p);
+	if (lineEnd == nullptr) {
+		lineEnd = end;
+	}
+
+	type = skipBlanks(p, lineEnd);
+	body = type;
+	while (body < lineEnd && !isBlank(*body)) {
+		body++;
+	}
+}
+
+// whether the type identifier [type, typeEnd) is the given keyword
+static inline bool isKeyword(const char* type, const char* typeEnd, const char* keyword) {
+	size_t length = strlen(keyword);
+	return (size_t)(typeEnd - type) == length && memcmp(type, keyword, length) == 0;
+}
+
+// splits a line, and tells what kind of record is on it
+static inline ObjLineType readLine(const char* p, const char* end, const char* &body, const char* &lineEnd) {
+	const char* type;
+	splitLine(p, end, type, body, lineEnd);
+
+	size_t typeLength = body - type;
+	if (typeLength == 1 && type[0] == 'v') {
+		return OBJ_LINE_POSITION;
+	} else if (typeLength == 2 && type[0] == 'v' && type[1] == 't') {
+		return OBJ_LINE_TEXTURE_COORD;
+	} else if (typeLength == 2 && type[0] == 'v' && type[1] == 'n') {
+		return OBJ_LINE_NORMAL;
+	} else if (typeLength == 1 && type[0] == 'f') {
+		return OBJ_LINE_FACE;
+	} else if (typeLength == 1 && type[0] == 'o') {
+		return OBJ_LINE_OBJECT;
+	} else if (typeLength == 1 && type[0] == 'g') {
+		return OBJ_LINE_GROUP;
+	} else if (isKeyword(type, body, "usemtl")) {
+		return OBJ_LINE_USE_MATERIAL;
+	} else if (isKeyword(type, body, "mtllib")) {
+		return OBJ_LINE_MATERIAL_LIBRARY;
+	}
+	return OBJ_LINE_OTHER;
+}
+
+// the rest of a line as a name, without the blanks around it
+static std::string readName(const char* p, const char* end) {
+	p = skipBlanks(p, end);
+	while (end > p && isBlank(end[-1])) {
+		end--;
+	}
+	return std::string(p, end - p);
+}
+
+static inline void parseVector3(const char* p, const char* end, Vector3 &v) {
+	p = parseFloat(p, end, v.x);
+	p = parseFloat(p, end, v.y);
+	parseFloat(p, end, v.z);
+}
+
+static inline void parseVector2(const char* p, const char* end, Vector2 &v) {
+	p = parseFloat(p, end, v.u);
+	parseFloat(p, end, v.v);
+}
+
+// the layouts a face corner can have: "v", "v/t", "v//n" and "v/t/n"; files almost always use
+// one layout throughout, so it is detected once and the face loops are compiled for each
+enum ObjFaceFormat {
+	OBJ_FACE_UNKNOWN,
+	OBJ_FACE_V,
+	OBJ_FACE_VT,
+	OBJ_FACE_VN,
+	OBJ_FACE_VTN
+};
+
+// a record index that a face corner leaves out, or that is out of range
+static const unsigned int missingIndex = ~0u;
+
+// a face corner's 0-based record indices
+struct ObjCorner {
+	unsigned int position;
+	unsigned int textureCoord;
+	unsigned int normal;
+};
+typedef struct ObjCorner ObjCorner;
+
+// how many of each record a slice of the file holds, or a face has seen so far
+struct ObjCounts {
+	size_t numPositions;
+	size_t numTextureCoords;
+	size_t numNormals;
+	size_t numTriangles;
+};
+typedef struct ObjCounts ObjCounts;
+
+// a group, material or material library statement, and how many triangles came before it
+struct ObjStatement {
+	ObjLineType type;
+	size_t triangle;
+	const char* name;
+	const char* nameEnd;
+};
+typedef struct ObjStatement ObjStatement;
+
+// a run of consecutive triangles in file order that share a part
+struct ObjRun {
+	size_t firstTriangle;
+	unsigned int part;
+};
+typedef struct ObjRun ObjRun;
+
+// the groups and materials that faces were assigned to, as runs of triangles in file order; a
+// part is one (material, group) pair, numbered in order of first use
+struct ObjParts {
+	std::vector<std::string> materialLibraries;
+	std::vector<std::string> materials;
+	std::vector<std::string> groups;
+	std::unordered_map<std::string, unsigned int> materialIds;
+	std::unordered_map<std::string, unsigned int> groupIds;
+	std::vector<std::pair<unsigned int, unsigned int> > parts;
+	std::unordered_map<uint64_t, unsigned int> partIds;
+	std::vector<ObjRun> runs;
+	unsigned int currentMaterial;
+	unsigned int currentGroup;
+};
+typedef struct ObjParts ObjParts;
+
+// starts with every face in the unnamed default group and material
+static void resetParts(ObjParts &parts) {
+	parts = ObjParts();
+	parts.materials.push_back("");
+	parts.materialIds[""] = 0;
+	parts.groups.push_back("");
+	parts.groupIds[""] = 0;
+	parts.parts.push_back(std::make_pair(0u, 0u));
+	parts.partIds[0] = 0;
+	parts.currentMaterial = 0;
+	parts.currentGroup = 0;
+
+	ObjRun run;
+	run.firstTriangle = 0;
+	run.part = 0;
+	parts.runs.push_back(run);
+}
+
+static unsigned int nameId(std::vector<std::string> &names, std::unordered_map<std::string, unsigned int> &ids, const std::string &name) {
+	std::unordered_map<std::string, unsigned int>::iterator found = ids.find(name);
+	if (found != ids.end()) {
+		return found->second;
+	}
+	unsigned int id = (unsigned int)names.size();
+	names.push_back(name);
+	ids[name] = id;
+	return id;
+}
+
+// applies a statement that came after the given number of triangles
+static void applyStatement(ObjParts &parts, ObjLineType type, const std::string &name, size_t triangle) {
+	if (type == OBJ_LINE_MATERIAL_LIBRARY) {
+		parts.materialLibraries.push_back(name);
+		return;
+	} else if (type == OBJ_LINE_USE_MATERIAL) {
+		parts.currentMaterial = nameId(parts.materials, parts.materialIds, name);
+	} else {
+		parts.currentGroup = nameId(parts.groups, parts.groupIds, name);
+	}
+
+	uint64_t key = ((uint64_t)parts.currentMaterial << 32) | parts.currentGroup;
+	std::unordered_map<uint64_t, unsigned int>::iterator found = parts.partIds.find(key);
+	unsigned int part;
+	if (found != parts.partIds.end()) {
+		part = found->second;
+	} else {
+		part = (unsigned int)parts.parts.size();
+		parts.parts.push_back(std::make_pair(parts.currentMaterial, parts.currentGroup));
+		parts.partIds[key] = part;
+	}
+
+	// a statement before any of its triangles just relabels the current run
+	ObjRun &last = parts.runs.back();
+	if (last.firstTriangle == triangle) {
+		last.part = part;
+	} else if (last.part != part) {
+		ObjRun run;
+		run.firstTriangle = triangle;
+		run.part = part;
+		parts.runs.push_back(run);
+	}
+}
+
+// finds the next blank-separated corner of a face, stopping at the end of the line or a comment
+static inline bool nextCorner(const char* &p, const char* end, const char* &cornerEnd) {
+	p = skipBlanks(p, end);
+	if (p >= end || *p == '#') {
+		return false;
+	}
+	cornerEnd = p;
+	while (cornerEnd < end && !isBlank(*cornerEnd)) {
+		cornerEnd++;
+	}
+	return true;
+}
+
+// the layout of a single corner
+static inline ObjFaceFormat detectCornerFormat(const char* p, const char* end) {
+	const char* slash = (const char*)memchr(p, '/', end - p);
+	if (slash == nullptr) {
+		return OBJ_FACE_V;
+	}
+	if (slash + 1 < end && slash[1] == '/') {
+		return OBJ_FACE_VN;
+	}
+	if (memchr(slash + 1, '/', end - slash - 1) != nullptr) {
+		return OBJ_FACE_VTN;
+	}
+	return OBJ_FACE_VT;
+}
+
+// the layout of the first corner of a face line
+static ObjFaceFormat detectFaceFormat(const char* body, const char* lineEnd) {
+	const char* cornerEnd;
+	if (!nextCorner(body, lineEnd, cornerEnd)) {
+		return OBJ_FACE_V;
+	}
+	return detectCornerFormat(body, cornerEnd);
+}
+
+// parses one corner [p, end) laid out as format into raw OBJ indices, where 0 means "not given";
+// returns false if the corner has some other layout
+template <ObjFaceFormat format>
+static inline bool parseCorner(const char* p, const char* end, int index[3]) {
+	index[1] = 0;
+	index[2] = 0;
+
+	p = parseIndex(p, end, index[0]);
+	if (p == nullptr) {
+		return false;
+	}
+	if constexpr (format == OBJ_FACE_VT || format == OBJ_FACE_VTN) {
+		if (p == end || *p != '/') {
+			return false;
+		}
+		p = parseIndex(p + 1, end, index[1]);
+		if (p == nullptr) {
+			return false;
+		}
+	}
+	if constexpr (format == OBJ_FACE_VN) {
+		if (end - p < 2 || p[0] != '/' || p[1] != '/') {
+			return false;
+		}
+		p = parseIndex(p + 2, end, index[2]);
+		if (p == nullptr) {
+			return false;
+		}
+	}
+	if constexpr (format == OBJ_FACE_VTN) {
+		if (p == end || *p != '/') {
+			return false;
+		}
+		p = parseIndex(p + 1, end, index[2]);
+		if (p == nullptr) {
+			return false;
+		}
+	}
+	return p == end;
+}
+
+// the slow path for a corner that does not match the file's layout
+static bool parseAnyCorner(const char* p, const char* end, int index[3]) {
+	switch (detectCornerFormat(p, end)) {
+	case OBJ_FACE_VT:
+		return parseCorner<OBJ_FACE_VT>(p, end, index);
+	case OBJ_FACE_VN:
+		return parseCorner<OBJ_FACE_VN>(p, end, index);
+	case OBJ_FACE_VTN:
+		return parseCorner<OBJ_FACE_VTN>(p, end, index);
+	default:
+		return parseCorner<OBJ_FACE_V>(p, end, index);
+	}
+}
+
+// turns a raw OBJ index into a 0-based one: positive indices count from the start of the file,
+// negative ones back from the last record of that kind seen so far
+static inline unsigned int resolveIndex(int index, size_t numSeen) {
+	if (index > 0) {
+		return (unsigned int)(index - 1);
+	}
+	if (index < 0 && (size_t)(-(long long)index) <= numSeen) {
+		return (unsigned int)(numSeen - (size_t)(-(long long)index));
+	}
+	return missingIndex;
+}
+
+// the number of triangles a face line fans out into, without parsing its corners
+static inline size_t countFaceTriangles(const char* p, const char* end) {
+	size_t numCorners = 0;
+	const char* cornerEnd;
+	while (nextCorner(p, end, cornerEnd)) {
+		numCorners++;
+		p = cornerEnd;
+	}
+	return numCorners > 2 ? numCorners - 2 : 0;
+}
+
+// parses a face, e.g. "f p1/t1/n1 p2/t2/n2 p3/t3/n3 ...", and fans it into triangles, calling
+// emit(corners) for each; a corner that cannot be parsed at all has every index missing, so
+// exactly countFaceTriangles() triangles are emitted. Returns the number of triangles.
+template <ObjFaceFormat format, typename Emit>
+static inline size_t parseFace(const char* p, const char* end, const ObjCounts &seen, Emit emit) {
+	ObjCorner corners[3];
+	size_t numCorners = 0;
+	const char* cornerEnd;
+	while (nextCorner(p, end, cornerEnd)) {
+		int index[3];
+		ObjCorner corner;
+		if (parseCorner<format>(p, cornerEnd, index) || parseAnyCorner(p, cornerEnd, index)) {
+			corner.position = resolveIndex(index[0], seen.numPositions);
+			corner.textureCoord = resolveIndex(index[1], seen.numTextureCoords);
+			corner.normal = resolveIndex(index[2], seen.numNormals);
+		} else {
+			corner.position = missingIndex;
+			corner.textureCoord = missingIndex;
+			corner.normal = missingIndex;
+		}
+		p = cornerEnd;
+
+		// a fan around the first corner
+		if (numCorners == 0) {
+			corners[0] = corner;
+		} else if (numCorners == 1) {
+			corners[2] = corner;
+		} else {
+			corners[1] = corners[2];
+			corners[2] = corner;
+			emit((const ObjCorner*)corners);
+		}
+		numCorners++;
+	}
+	return numCorners > 2 ? numCorners - 2 : 0;
+}
+
+// calls parseFace() with the loop compiled for the given layout
+template <typename Emit>
+static inline size_t parseFaceAs(ObjFaceFormat format, const char* p, const char* end, const ObjCounts &seen, Emit emit) {
+	switch (format) {
+	case OBJ_FACE_VT:
+		return parseFace<OBJ_FACE_VT>(p, end, seen, emit);
+	case OBJ_FACE_VN:
+		return parseFace<OBJ_FACE_VN>(p, end, seen, emit);
+	case OBJ_FACE_VTN:
+		return parseFace<OBJ_FACE_VTN>(p, end, seen, emit);
+	default:
+		return parseFace<OBJ_FACE_V>(p, end, seen, emit);
+	}
+}
+
+// the records that face corners index into
+struct ObjRecordArrays {
+	const Vector3* positions;
+	const Vector2* textureCoords;
+	const Vector3* normals;
+	size_t numPositions;
+	size_t numTextureCoords;
+	size_t numNormals;
+};
+typedef struct ObjRecordArrays ObjRecordArrays;
+
+// the unit normal of a triangle's plane, or zero if it is degenerate
+static inline Vector3 triangleNormal(const Vector3 &a, const Vector3 &b, const Vector3 &c) {
+	float ux = b.x - a.x, uy = b.y - a.y, uz = b.z - a.z;
+	float vx = c.x - a.x, vy = c.y - a.y, vz = c.z - a.z;
+	Vector3 n = { uy * vz - uz * vy, uz * vx - ux * vz, ux * vy - uy * vx };
+	float length = sqrtf(n.x * n.x + n.y * n.y + n.z * n.z);
+	if (length > 0.0f) {
+		n.x /= length;
+		n.y /= length;
+		n.z /= length;
+	}
+	return n;
+}
+
+// expands a triangle's corners from the records; a missing texture coordinate is zero, and a
+// missing normal is the triangle's own (flat) normal
+static inline void gatherTriangle(const ObjRecordArrays &records, const ObjCorner corners[3],
+                                  Vector3* positions, Vector2* textureCoords, Vector3* normals) {
+	const Vector3 zero3 = { 0.0f, 0.0f, 0.0f };
+	const Vector2 zero2 = { 0.0f, 0.0f };
+	bool missingNormal = false;
+	for (int c = 0; c < 3; c++) {
+		positions[c] = corners[c].position < records.numPositions ? records.positions[corners[c].position] : zero3;
+		textureCoords[c] = corners[c].textureCoord < records.numTextureCoords ? records.textureCoords[corners[c].textureCoord] : zero2;
+		if (corners[c].normal < records.numNormals) {
+			normals[c] = records.normals[corners[c].normal];
+		} else {
+			missingNormal = true;
+		}
+	}
+	if (missingNormal) {
+		Vector3 n = triangleNormal(positions[0], positions[1], positions[2]);
+		for (int c = 0; c < 3; c++) {
+			if (corners[c].normal >= records.numNormals) {
+				normals[c] = n;
+			}
+		}
+	}
+}
+
+// the position a corner is smoothed by, or missingIndex if it came with a normal of its own (or
+// has no position), in which case normal generation leaves it alone
+static inline unsigned int smoothingId(const ObjRecordArrays &records, const ObjCorner &corner) {
+	if (corner.normal < records.numNormals || corner.position >= records.numPositions) {
+		return missingIndex;
+	}
+	return corner.position;
+}
+
+// the records parsed from one line-aligned slice of the file
+struct ObjChunk {
+	std::vector<Vector3> vertexPositions;
+	std::vector<Vector2> vertexTextureCoords;
+	std::vector<Vector3> vertexNormals;
+	std::vector<unsigned int> positionIndices;
+	std::vector<unsigned int> textureCoordIndices;
+	std::vector<unsigned int> normalIndices;
+
+	// the corner layout of the first face, once there has been one
+	ObjFaceFormat faceFormat;
+};
+typedef struct ObjChunk ObjChunk;
+
+// files are only split across threads in slices of at least this many bytes
+static const size_t minChunkBytes = 1 << 20;
+
+// appends the records of whole lines in [p, chunkEnd) to the chunk, stopping early once at least
+// maxTriangles triangles have been added; returns where parsing stopped
+static const char* parseLines(const char* p, const char* chunkEnd, ObjChunk &chunk, ObjParts &parts, size_t maxTriangles) {
+	size_t numTriangles = 0;
+
+	while (p < chunkEnd && numTriangles < maxTriangles) {
+		const char* body;
+		const char* lineEnd;
+		ObjLineType type = readLine(p, chunkEnd, body, lineEnd);
+
+		if (type == OBJ_LINE_POSITION) {
+			Vector3 v;
+			parseVector3(body, lineEnd, v);
+			chunk.vertexPositions.push_back(v);
+		} else if (type == OBJ_LINE_TEXTURE_COORD) {
+			Vector2 t;
+			parseVector2(body, lineEnd, t);
+			chunk.vertexTextureCoords.push_back(t);
+		} else if (type == OBJ_LINE_NORMAL) {
+			Vector3 n;
+			parseVector3(body, lineEnd, n);
+			chunk.vertexNormals.push_back(n);
+		} else if (type == OBJ_LINE_FACE) {
+			if (chunk.faceFormat == OBJ_FACE_UNKNOWN) {
+				chunk.faceFormat = detectFaceFormat(body, lineEnd);
+			}
+			ObjCounts seen;
+			seen.numPositions = chunk.vertexPositions.size();
+			seen.numTextureCoords = chunk.vertexTextureCoords.size();
+			seen.numNormals = chunk.vertexNormals.size();
+			numTriangles += parseFaceAs(chunk.faceFormat, body, lineEnd, seen, [&](const ObjCorner* corners) {
+				for (int c = 0; c < 3; c++) {
+					chunk.positionIndices.push_back(corners[c].position);
+					chunk.textureCoordIndices.push_back(corners[c].textureCoord);
+					chunk.normalIndices.push_back(corners[c].normal);
+				}
+			});
+		} else if (type == OBJ_LINE_OBJECT || type == OBJ_LINE_GROUP || type == OBJ_LINE_USE_MATERIAL
+			|| type == OBJ_LINE_MATERIAL_LIBRARY) {
+			applyStatement(parts, type, readName(body, lineEnd), chunk.positionIndices.size() / 3);
+		}
+
+		p = lineEnd + 1;
+	}
+
+	return p < chunkEnd ? p : chunkEnd;
+}
+
+// the counting pass: tallies the records in whole lines of [p, chunkEnd) without parsing them, and
+// keeps the group and material statements to be replayed in file order afterwards
+static void countLines(const char* p, const char* chunkEnd, ObjCounts &counts, std::vector<ObjStatement> &statements) {
+	counts.numPositions = 0;
+	counts.numTextureCoords = 0;
+	counts.numNormals = 0;
+	counts.numTriangles = 0;
+
+	while (p < chunkEnd) {
+		const char* body;
+		const char* lineEnd;
+		ObjLineType type = readLine(p, chunkEnd, body, lineEnd);
+		switch (type) {
+		case OBJ_LINE_POSITION:
+			counts.numPositions++;
+			break;
+		case OBJ_LINE_TEXTURE_COORD:
+			counts.numTextureCoords++;
+			break;
+		case OBJ_LINE_NORMAL:
+			counts.numNormals++;
+			break;
+		case OBJ_LINE_FACE:
+			counts.numTriangles += countFaceTriangles(body, lineEnd);
+			break;
+		case OBJ_LINE_OBJECT:
+		case OBJ_LINE_GROUP:
+		case OBJ_LINE_USE_MATERIAL:
+		case OBJ_LINE_MATERIAL_LIBRARY: {
+			ObjStatement statement;
+			statement.type = type;
+			statement.triangle = counts.numTriangles;
+			statement.name = body;
+			statement.nameEnd = lineEnd;
+			statements.push_back(statement);
+			break;
+		}
+		default:
+			break;
+		}
+		p = lineEnd + 1;
+	}
+}
+
+// the vertex pass: parses the position, texture coordinate and normal records in whole lines of
+// [p, chunkEnd) straight into their place in the exactly sized record arrays
+static void parseVertexLines(const char* p, const char* chunkEnd, Vector3* positions, Vector2* textureCoords,
+                             Vector3* normals) {
+	while (p < chunkEnd) {
+		const char* body;
+		const char* lineEnd;
+		ObjLineType type = readLine(p, chunkEnd, body, lineEnd);
+
+		if (type == OBJ_LINE_POSITION) {
+			parseVector3(body, lineEnd, *positions);
+			positions++;
+		} else if (type == OBJ_LINE_TEXTURE_COORD) {
+			parseVector2(body, lineEnd, *textureCoords);
+			textureCoords++;
+		} else if (type == OBJ_LINE_NORMAL) {
+			parseVector3(body, lineEnd, *normals);
+			normals++;
+		}
+
+		p = lineEnd + 1;
+	}
+}
+
+// where the face pass reads records from, and writes expanded corners to
+struct ObjFaceOutput {
+	ObjRecordArrays records;
+	Vector3* positions;
+	Vector2* textureCoords;
+	Vector3* normals;
+	unsigned int* smoothingIds;
+};
+typedef struct ObjFaceOutput ObjFaceOutput;
+
+// the face pass for a slice whose faces are laid out as format: parses the faces in whole lines of
+// [p, chunkEnd), given the records seen before p, and writes their triangles, expanded from the
+// (already placed) records, straight into the vertex arrays from firstCorner on, in file order
+template <ObjFaceFormat format>
+static void parseFaceLinesAs(const char* p, const char* chunkEnd, ObjCounts seen, size_t firstCorner, const ObjFaceOutput &out) {
+	size_t i = firstCorner;
+	auto emit = [&](const ObjCorner* corners) {
+		gatherTriangle(out.records, corners, out.positions + i, out.textureCoords + i, out.normals + i);
+		for (int c = 0; c < 3; c++) {
+			out.smoothingIds[i + c] = smoothingId(out.records, corners[c]);
+		}
+		i += 3;
+	};
+
+	while (p < chunkEnd) {
+		const char* body;
+		const char* lineEnd;
+		switch (readLine(p, chunkEnd, body, lineEnd)) {
+		case OBJ_LINE_POSITION:
+			seen.numPositions++;
+			break;
+		case OBJ_LINE_TEXTURE_COORD:
+			seen.numTextureCoords++;
+			break;
+		case OBJ_LINE_NORMAL:
+			seen.numNormals++;
+			break;
+		case OBJ_LINE_FACE:
+			parseFace<format>(body, lineEnd, seen, emit);
+			break;
+		default:
+			break;
+		}
+		p = lineEnd + 1;
+	}
+}
+
+// the face pass: finds the slice's first face to learn the corner layout, then hands the rest of
+// the slice to the loop compiled for it
+static void parseFaceLines(const char* p, const char* chunkEnd, ObjCounts seen, size_t firstCorner, const ObjFaceOutput &out) {
+	while (p < chunkEnd) {
+		const char* body;
+		const char* lineEnd;
+		switch (readLine(p, chunkEnd, body, lineEnd)) {
+		case OBJ_LINE_POSITION:
+			seen.numPositions++;
+			break;
+		case OBJ_LINE_TEXTURE_COORD:
+			seen.numTextureCoords++;
+			break;
+		case OBJ_LINE_NORMAL:
+			seen.numNormals++;
+			break;
+		case OBJ_LINE_FACE:
+			switch (detectFaceFormat(body, lineEnd)) {
+			case OBJ_FACE_VT:
+				parseFaceLinesAs<OBJ_FACE_VT>(p, chunkEnd, seen, firstCorner, out);
+				break;
+			case OBJ_FACE_VN:
+				parseFaceLinesAs<OBJ_FACE_VN>(p, chunkEnd, seen, firstCorner, out);
+				break;
+			case OBJ_FACE_VTN:
+				parseFaceLinesAs<OBJ_FACE_VTN>(p, chunkEnd, seen, firstCorner, out);
+				break;
+			default:
+				parseFaceLinesAs<OBJ_FACE_V>(p, chunkEnd, seen, firstCorner, out);
+				break;
+			}
+			return;
+		default:
+			break;
+		}
+		p = lineEnd + 1;
+	}
+}
+
+static ObjRecordArrays recordArrays(const ObjChunk &chunk) {
+	ObjRecordArrays arrays;
+	arrays.positions = chunk.vertexPositions.data();
+	arrays.textureCoords = chunk.vertexTextureCoords.data();
+	arrays.normals = chunk.vertexNormals.data();
+	arrays.numPositions = chunk.vertexPositions.size();
+	arrays.numTextureCoords = chunk.vertexTextureCoords.size();
+	arrays.numNormals = chunk.vertexNormals.size();
+	return arrays;
+}
+
+// the state of a load that is handed out in batches
+struct ObjStream {
+	MappedFile file;
+	const char* cursor;
+	const char* end;
+	std::string filename;
+	std::string cacheFilename;
+	MeshCacheKey key;
+	bool autoCentre;
+	bool autoNormalize;
+	bool fromCache;
+	// load() already built the draw arrays, as it does for a GLB, so endStream() has nothing left to do
+	bool finished;
+
+	// every record so far, kept so endStream() can rebuild the exact load() result
+	ObjChunk records;
+	ObjParts parts;
+
+	// the centre and scale applied to streamed positions, fixed at the first face
+	bool transformFixed;
+	Vector3 centre;
+	float scale;
 };
-typedef struct Triangle Triangle;
+typedef struct ObjStream ObjStream;
 
-static inline void ltrim(std::string &s) {
-	s.erase(s.begin(), find_if(s.begin(), s.end(), [](int ch) {
-		return !isspace(ch);
-	}));
+// the processing options that change the cached arrays, and so are part of the cache key
+static const uint32_t CACHE_FLAG_AUTO_CENTRE = 1 << 0;
+static const uint32_t CACHE_FLAG_AUTO_NORMALIZE = 1 << 1;
+static const uint32_t CACHE_FLAG_WELD_VERTICES = 1 << 2;
+static const uint32_t CACHE_FLAG_OPTIMIZE_VERTEX_CACHE = 1 << 3;
+static const uint32_t CACHE_FLAG_OPTIMIZE_OVERDRAW = 1 << 4;
+static const uint32_t CACHE_FLAG_OPTIMIZE_VERTEX_FETCH = 1 << 5;
+static const uint32_t CACHE_FLAG_GENERATE_LODS = 1 << 6;
+static const uint32_t CACHE_FLAG_GENERATE_MESHLETS = 1 << 7;
+
+// the crease angle that faces without normals are smoothed with unless told otherwise, in degrees
+static const float defaultCreaseAngle = 60.0f;
+
+// how much worse than the cache-optimised order the overdraw pass may make the ACMR
+static const float overdrawCacheThreshold = 1.05f;
+
+// how many levels of detail setGenerateLods() builds beyond the full mesh, the share of the
+// previous level's triangles each aims for, and the share past which a level is not worth keeping
+static const unsigned int maxLods = 5;
+static const float lodReduction = 0.5f;
+static const float minLodReduction = 0.9f;
+
+// how many levels of subdivision getSubdivision() goes to, the curvature angle past which they
+// refine a triangle unless told otherwise, in degrees, and the share of the mesh's largest extent
+// that a triangle's longest edge must exceed to be refined at all
+static const unsigned int maxSubdivisionLevels = 3;
+static const float defaultSubdivisionCurvature = 15.0f;
+static const float minSubdivisionEdge = 1.0f / 500.0f;
+// a level up to four times the size of its source is not built from one of more triangles than this
+static const size_t maxSubdivisionSourceTriangles = 1 << 21;
+
+// the counts and bounds stored alongside the cached arrays
+struct CacheInfo {
+	uint32_t numVertices;
+	uint32_t numTriangles;
+	uint32_t numIndexedVertices;
+	uint32_t numSubmeshes;
+	Vector3 centre;
+	Vector3 dimensions;
+	uint32_t numMaterials;
+	uint32_t numMaterialLibraries;
+	uint32_t numLods;
+	uint32_t numLodRanges;
+	uint32_t numLodIndices;
+	uint32_t numMeshlets;
+};
+typedef struct CacheInfo CacheInfo;
+
+// a submesh as cached; its group name is an offset into the names section, which holds the
+// material names, then the material library names, then the group names, each NUL-terminated
+struct CachedSubmesh {
+	uint32_t firstIndex;
+	uint32_t numIndices;
+	uint32_t material;
+	uint32_t group;
+};
+typedef struct CachedSubmesh CachedSubmesh;
+
+// reads the NUL-terminated name at offset in the names section, failing if it runs off the end
+static bool readCachedName(const char* names, size_t namesSize, size_t offset, std::string &name) {
+	if (offset >= namesSize) {
+		return false;
+	}
+	const char* nameEnd = (const char*)memchr(names + offset, '\0', namesSize - offset);
+	if (nameEnd == nullptr) {
+		return false;
+	}
+	name.assign(names + offset, nameEnd);
+	return true;
+}
+
+ObjMesh::~ObjMesh() {
+}
+
+ObjMesh::ObjMesh() {
+	this->numVertices = 0;
+	this->numTriangles = 0;
+	this->numThreads = 0;
+	this->useCache = false;
+	this->weldVertices = false;
+	this->optimizeVertexCache = false;
+	this->optimizeOverdraw = false;
+	this->optimizeVertexFetch = false;
+	this->creaseAngle = defaultCreaseAngle;
+	this->interleaveVertices = false;
+	this->generateStrips = false;
+	this->generateLods = false;
+	this->generateMeshlets = false;
+	this->assetPack = nullptr;
+	this->subdivisionCurvature = defaultSubdivisionCurvature;
+	this->closedKnown = false;
+	this->closed = false;
+	this->numDrawIndices = 0;
+	this->drawIndexSize = sizeof(unsigned int);
+	this->drawPrimitive = OBJ_TRIANGLES;
+}
+
+void ObjMesh::setNumThreads(unsigned int numThreads) {
+	this->numThreads = numThreads;
+}
+
+void ObjMesh::setUseCache(bool useCache) {
+	this->useCache = useCache;
+}
+
+void ObjMesh::setAssetPack(AssetPack* assetPack) {
+	this->assetPack = assetPack;
+}
+
+void ObjMesh::setWeldVertices(bool weldVertices) {
+	this->weldVertices = weldVertices;
+}
+
+void ObjMesh::setOptimizeVertexCache(bool optimizeVertexCache) {
+	this->optimizeVertexCache = optimizeVertexCache;
+}
+
+void ObjMesh::setOptimizeOverdraw(bool optimizeOverdraw) {
+	this->optimizeOverdraw = optimizeOverdraw;
+}
+
+void ObjMesh::setOptimizeVertexFetch(bool optimizeVertexFetch) {
+	this->optimizeVertexFetch = optimizeVertexFetch;
+}
+
+void ObjMesh::setCreaseAngle(float creaseAngle) {
+	this->creaseAngle = creaseAngle;
+}
+
+void ObjMesh::setInterleaveVertices(bool interleaveVertices) {
+	if (interleaveVertices == this->interleaveVertices) {
+		return;
+	}
+	this->interleaveVertices = interleaveVertices;
+	// a finished mesh gets its copy built or freed now; otherwise load() or endStream() sees to it
+	if (!this->stream && this->numVertices > 0) {
+		this->interleave();
+	}
+}
+
+void ObjMesh::setGenerateStrips(bool generateStrips) {
+	this->generateStrips = generateStrips;
+}
+
+void ObjMesh::setGenerateLods(bool generateLods) {
+	this->generateLods = generateLods;
+}
+
+void ObjMesh::setGenerateMeshlets(bool generateMeshlets) {
+	this->generateMeshlets = generateMeshlets;
+}
+
+// the contents of a file from the asset pack, or else mapped into fileIn; a packed file keeps the
+// time of the loose file it was packed from, so caches built from either match it
+bool ObjMesh::openSource(const std::string filename, const bool copyOnWrite, MappedFile &fileIn, const char* &data,
+                         size_t &size, long long &modifiedTime) {
+	const AssetEntry* asset = this->assetPack != nullptr ? this->assetPack->find(filename) : nullptr;
+	if (asset != nullptr && asset->format == ASSET_RAW) {
+		data = asset->data;
+		size = asset->size;
+		modifiedTime = asset->sourceTime;
+		return true;
+	}
+
+	if (!fileIn.open(filename, copyOnWrite)) {
+		return false;
+	}
+	data = fileIn.getData();
+	size = fileIn.getSize();
+	modifiedTime = fileIn.getModifiedTime();
+	return true;
+}
+
+MeshCacheKey ObjMesh::makeCacheKey(const char* data, const size_t size, const long long modifiedTime,
+                                   const bool autoCentre, const bool autoNormalize) {
+	// the cache is only reused for the same source contents processed the same way
+	MeshCacheKey key;
+	key.sourceSize = size;
+	key.sourceTime = modifiedTime;
+	key.sourceHash = MeshCache::hashContents(data, size);
+	key.flags = (autoCentre ? CACHE_FLAG_AUTO_CENTRE : 0) | (autoNormalize ? CACHE_FLAG_AUTO_NORMALIZE : 0)
+		| (this->weldVertices ? CACHE_FLAG_WELD_VERTICES : 0)
+		| (this->optimizeVertexCache ? CACHE_FLAG_OPTIMIZE_VERTEX_CACHE : 0)
+		| (this->optimizeOverdraw ? CACHE_FLAG_OPTIMIZE_OVERDRAW : 0)
+		| (this->optimizeVertexFetch ? CACHE_FLAG_OPTIMIZE_VERTEX_FETCH : 0)
+		| (this->generateLods ? CACHE_FLAG_GENERATE_LODS : 0)
+		| (this->generateMeshlets ? CACHE_FLAG_GENERATE_MESHLETS : 0);
+	memcpy(&key.options, &this->creaseAngle, sizeof(key.options));
+	return key;
+}
+
+void ObjMesh::clear() {
+	this->numVertices = 0;
+	this->numTriangles = 0;
+	this->numIndexedVertices = 0;
+	this->indexedPositions.assign(std::vector<Vector3>());
+	this->indexedTextureCoords.assign(std::vector<Vector2>());
+	this->indexedNormals.assign(std::vector<Vector3>());
+	this->indexedTangents.assign(std::vector<Vector4>());
+	std::vector<unsigned char>().swap(this->interleavedVertices);
+	this->triangleIndices.assign(std::vector<unsigned int>());
+	this->materials.clear();
+	this->submeshes.clear();
+	this->drawRanges.clear();
+	std::vector<unsigned short>().swap(this->shortDrawIndices);
+	std::vector<unsigned int>().swap(this->longDrawIndices);
+	this->drawLods.clear();
+	this->lodIndices.assign(std::vector<unsigned int>());
+	this->lodRanges.clear();
+	this->lods.clear();
+	this->meshlets.clear();
+	this->numDrawIndices = 0;
+	this->drawIndexSize = sizeof(unsigned int);
+	this->drawPrimitive = OBJ_TRIANGLES;
+	this->subdivisions.clear();
+	this->subdivisionEdgeLengths.clear();
+	this->closedKnown = false;
+	this->cache.close();
+	this->sourceFile.reset();
+}
+
+bool ObjMesh::load(const std::string filename, const bool autoCentre = false, const bool autoNormalize = false) {
+	std::cout << "Loading " << filename.c_str() << "..." << std::endl;
+	this->subdivisions.clear();
+	this->subdivisionEdgeLengths.clear();
+	this->closedKnown = false;
+
+	// a GLB stays mapped for as long as arrays point into it; copy-on-write, so that centring can
+	// move the positions in place
+	bool glb = isGlbFilename(filename);
+	std::unique_ptr<MappedFile> glbFile(glb ? new MappedFile() : nullptr);
+	MappedFile objFile;
+	MappedFile &fileIn = glb ? *glbFile : objFile;
+
+	const char* fileData;
+	size_t fileSize;
+	long long modifiedTime;
+	if (!this->openSource(filename, glb, fileIn, fileData, fileSize, modifiedTime)) {
+		return false;
+	}
+
+	MeshCacheKey key;
+	std::string cacheFilename = filename + ".cache";
+	if (this->useCache) {
+		key = this->makeCacheKey(fileData, fileSize, modifiedTime, autoCentre, autoNormalize);
+
+		if (this->loadCache(filename, cacheFilename, key)) {
+			std::cout << "Using cached mesh " << cacheFilename.c_str() << std::endl;
+			this->sourceFile.reset();
+			this->interleave();
+			this->compactIndices();
+			return true;
+		}
+	}
+
+	// from here a failure empties the mesh: a cache that missed has let go of the previous one,
+	// which the old arrays may have pointed into
+	std::vector<std::string> materialLibraries;
+	if (glb) {
+		GlbContents contents;
+		std::string error;
+		std::vector<std::string> materialNames;
+		// a GLB in the pack is shared with whatever else reads it, so it must not be written through
+		bool packed = !fileIn.isOpen();
+		if (!readGlb(fileData, fileSize, contents, error)) {
+			std::cout << "Could not read " << filename.c_str() << ": " << error.c_str() << std::endl;
+			this->clear();
+			return false;
+		}
+		if (!this->parseGlb(contents, autoCentre, autoNormalize, packed, materialNames)) {
+			std::cout << "Could not read " << filename.c_str() << ": too many vertices" << std::endl;
+			this->clear();
+			return false;
+		}
+		// only now is the previous file, which the old arrays may have pointed into, let go
+		this->sourceFile = packed ? nullptr : std::move(glbFile);
+		this->loadMaterials(filename, materialNames, materialLibraries);
+	} else {
+		ObjParts parts;
+		this->parse(fileData, fileSize, parts, autoCentre, autoNormalize);
+		this->sourceFile.reset();
+		this->loadMaterials(filename, parts.materials, parts.materialLibraries);
+		materialLibraries = parts.materialLibraries;
+	}
+	this->postProcess();
+
+	if (this->useCache) {
+		this->saveCache(cacheFilename, key, materialLibraries);
+	}
+	this->interleave();
+	this->compactIndices();
+	return true;
+}
+
+void ObjMesh::postProcess() {
+	this->closedKnown = false;
+	if (this->weldVertices) {
+		this->weld();
+	}
+	if (this->optimizeVertexCache || this->optimizeOverdraw) {
+		this->optimizeCache();
+	}
+	// meshlets regroup the triangles, keeping most of the cache order, so the vertex fetch order follows them
+	this->meshlets.clear();
+	if (this->generateMeshlets) {
+		this->partitionMeshlets();
+	}
+	if (this->optimizeVertexFetch) {
+		this->optimizeFetch();
+	}
+	// tangents go last, once the vertices are final
+	this->computeTangents();
+	if (this->generateLods) {
+		this->generateLevelsOfDetail();
+	} else {
+		this->lodIndices.assign(std::vector<unsigned int>());
+		this->lodRanges.clear();
+		this->lods.clear();
+	}
+}
+
+bool ObjMesh::beginStream(const std::string filename, const bool autoCentre, const bool autoNormalize) {
+	std::cout << "Streaming " << filename.c_str() << "..." << std::endl;
+	this->subdivisions.clear();
+	this->subdivisionEdgeLengths.clear();
+	this->closedKnown = false;
+
+	this->stream.reset(new ObjStream());
+	ObjStream &stream = *this->stream;
+
+	const char* fileData;
+	size_t fileSize;
+	long long modifiedTime;
+	if (!this->openSource(filename, false, stream.file, fileData, fileSize, modifiedTime)) {
+		this->stream.reset();
+		return false;
+	}
+
+	stream.cursor = fileData;
+	stream.end = stream.cursor + fileSize;
+	stream.filename = filename;
+	stream.cacheFilename = filename + ".cache";
+	stream.autoCentre = autoCentre;
+	stream.autoNormalize = autoNormalize;
+	stream.fromCache = false;
+	stream.finished = false;
+	stream.transformFixed = false;
+	stream.records.faceFormat = OBJ_FACE_UNKNOWN;
+	resetParts(stream.parts);
+
+	// a GLB is binary already, and loads whole faster than it could be streamed
+	if (isGlbFilename(filename)) {
+		stream.file.close();
+		stream.fromCache = true;
+		stream.finished = true;
+		if (!this->load(filename, autoCentre, autoNormalize)) {
+			this->stream.reset();
+			return false;
+		}
+		return true;
+	}
+
+	if (this->useCache) {
+		stream.key = this->makeCacheKey(fileData, fileSize, modifiedTime, autoCentre, autoNormalize);
+		if (this->loadCache(filename, stream.cacheFilename, stream.key)) {
+			std::cout << "Using cached mesh " << stream.cacheFilename.c_str() << std::endl;
+			stream.fromCache = true;
+			return true;
+		}
+	}
+
+	this->clear();
+
+	return true;
+}
+
+bool ObjMesh::streamBatch(const unsigned int maxTriangles, ObjMeshBatch &batch) {
+	batch.firstVertex = this->numVertices;
+	batch.numVertices = 0;
+	batch.firstIndex = this->numIndexedVertices;
+	batch.numIndices = 0;
+
+	if (!this->stream) {
+		return false;
+	}
+	ObjStream &stream = *this->stream;
+
+	// a cached mesh is complete already, so it all arrives as the first batch
+	if (stream.fromCache) {
+		if (stream.cursor == stream.end) {
+			return false;
+		}
+		stream.cursor = stream.end;
+		batch.firstVertex = 0;
+		batch.numVertices = this->numVertices;
+		batch.firstIndex = 0;
+		batch.numIndices = this->numIndexedVertices;
+		return true;
+	}
+
+	if (stream.cursor == stream.end) {
+		return false;
+	}
+
+	ObjChunk &records = stream.records;
+	size_t firstCorner = records.positionIndices.size();
+	stream.cursor = parseLines(stream.cursor, stream.end, records, stream.parts, maxTriangles);
+	size_t numCorners = records.positionIndices.size();
+
+	if (numCorners > firstCorner && !stream.transformFixed) {
+		// exporters write positions before the faces that use them, so the vertices seen so far
+		// give the same centre and size that load() computes from the whole file
+		PositionBounds bounds;
+		computePositionBounds((const float*)records.vertexPositions.data(), records.vertexPositions.size(), bounds);
+		stream.centre.x = bounds.centroid[0];
+		stream.centre.y = bounds.centroid[1];
+		stream.centre.z = bounds.centroid[2];
+		stream.scale = largestExtent(bounds);
+		stream.transformFixed = true;
+	}
+
+	// append the new corners, expanded, to the indexed arrays
+	std::vector<Vector3> &positions = this->indexedPositions.edit();
+	std::vector<Vector2> &textureCoords = this->indexedTextureCoords.edit();
+	std::vector<Vector3> &normals = this->indexedNormals.edit();
+	std::vector<unsigned int> &indices = this->triangleIndices.edit();
+
+	positions.resize(numCorners);
+	textureCoords.resize(numCorners);
+	normals.resize(numCorners);
+	indices.resize(numCorners);
+
+	ObjRecordArrays arrays = recordArrays(records);
+	for (size_t i = firstCorner; i < numCorners; i += 3) {
+		ObjCorner corners[3];
+		for (int c = 0; c < 3; c++) {
+			corners[c].position = records.positionIndices[i + c];
+			corners[c].textureCoord = records.textureCoordIndices[i + c];
+			corners[c].normal = records.normalIndices[i + c];
+			indices[i + c] = (unsigned int)(i + c);
+		}
+		gatherTriangle(arrays, corners, &positions[i], &textureCoords[i], &normals[i]);
+
+		if (stream.autoCentre) {
+			for (int c = 0; c < 3; c++) {
+				Vector3 &position = positions[i + c];
+				position.x -= stream.centre.x;
+				position.y -= stream.centre.y;
+				position.z -= stream.centre.z;
+				if (stream.autoNormalize) {
+					position.x /= stream.scale;
+					position.y /= stream.scale;
+					position.z /= stream.scale;
+				}
+			}
+		}
+	}
+
+	// the new corners are vertices of their own, so their tangents only depend on the batch
+	std::vector<Vector4> &tangents = this->indexedTangents.edit();
+	tangents.resize(numCorners);
+	std::vector<unsigned int> batchIndices(numCorners - firstCorner);
+	for (size_t i = 0; i < batchIndices.size(); i++) {
+		batchIndices[i] = (unsigned int)i;
+	}
+	generateVertexTangents((const float*)(positions.data() + firstCorner), (const float*)(textureCoords.data() + firstCorner),
+		(const float*)(normals.data() + firstCorner), batchIndices.size(), batchIndices.data(), batchIndices.size(), 1,
+		(float*)(tangents.data() + firstCorner));
+
+	this->numIndexedVertices = (unsigned int)numCorners;
+	this->numVertices = this->numIndexedVertices;
+	this->numTriangles = this->numIndexedVertices / 3;
+
+	batch.numVertices = (unsigned int)(numCorners - firstCorner);
+	batch.numIndices = batch.numVertices;
+	return true;
+}
+
+void ObjMesh::endStream() {
+	if (!this->stream) {
+		return;
+	}
+	ObjStream &stream = *this->stream;
+
+	if (!stream.fromCache) {
+		// finish whatever was not streamed, then rebuild the arrays exactly as load() would
+		stream.cursor = parseLines(stream.cursor, stream.end, stream.records, stream.parts, (size_t)-1);
+		this->expand(stream.records, stream.parts, stream.autoCentre, stream.autoNormalize);
+		this->loadMaterials(stream.filename, stream.parts.materials, stream.parts.materialLibraries);
+		this->postProcess();
+
+		if (this->useCache) {
+			this->saveCache(stream.cacheFilename, stream.key, stream.parts.materialLibraries);
+		}
+	}
+	if (!stream.finished) {
+		this->interleave();
+		this->compactIndices();
+	}
+
+	this->stream.reset();
+}
+
+void ObjMesh::parse(const char* fileData, const size_t fileSize, ObjParts &parts, const bool autoCentre,
+                    const bool autoNormalize) {
+	unsigned int numThreads = resolveThreadCount(this->numThreads);
+
+	// every temporary of the load comes from here, and all of it goes at once at the end
+	MemoryArena arena;
+
+	// split the file into one slice per thread, moving each split point forward to a line start
+	size_t numChunks = fileSize / minChunkBytes;
+	if (numChunks > numThreads) {
+		numChunks = numThreads;
+	}
+	if (numChunks < 1) {
+		numChunks = 1;
+	}
+	const char** chunkStarts = arena.allocate<const char*>(numChunks + 1);
+	chunkStarts[0] = fileData;
+	chunkStarts[numChunks] = fileData + fileSize;
+	for (size_t c = 1; c < numChunks; c++) {
+		const char* split = fileData + fileSize * c / numChunks;
+		if (split < chunkStarts[c - 1]) {
+			split = chunkStarts[c - 1];
+		}
+		const char* lineEnd = (const char*)memchr(split, '\n', chunkStarts[numChunks] - split);
+		chunkStarts[c] = lineEnd != nullptr ? lineEnd + 1 : chunkStarts[numChunks];
+	}
+
+	// count the records in every slice, so each array can be allocated once at its exact size
+	ObjCounts* offsets = arena.allocate<ObjCounts>(numChunks + 1);
+	std::vector<std::vector<ObjStatement> > statements(numChunks);
+	parallelFor(numThreads, numChunks, 1, [&](unsigned int, size_t begin, size_t end) {
+		for (size_t c = begin; c < end; c++) {
+			countLines(chunkStarts[c], chunkStarts[c + 1], offsets[c + 1], statements[c]);
+		}
+	});
+
+	// prefix sums over the counts give each slice's place in the arrays
+	offsets[0].numPositions = 0;
+	offsets[0].numTextureCoords = 0;
+	offsets[0].numNormals = 0;
+	offsets[0].numTriangles = 0;
+	for (size_t c = 0; c < numChunks; c++) {
+		offsets[c + 1].numPositions += offsets[c].numPositions;
+		offsets[c + 1].numTextureCoords += offsets[c].numTextureCoords;
+		offsets[c + 1].numNormals += offsets[c].numNormals;
+		offsets[c + 1].numTriangles += offsets[c].numTriangles;
+	}
+	const ObjCounts &totals = offsets[numChunks];
+
+	// group and material statements carry across slices, so they are replayed in file order
+	resetParts(parts);
+	for (size_t c = 0; c < numChunks; c++) {
+		for (size_t i = 0; i < statements[c].size(); i++) {
+			const ObjStatement &statement = statements[c][i];
+			applyStatement(parts, statement.type, readName(statement.name, statement.nameEnd),
+				offsets[c].numTriangles + statement.triangle);
+		}
+	}
+
+	// parse the vertex records of every slice into place
+	Vector3* vertexPositions = arena.allocate<Vector3>(totals.numPositions);
+	Vector2* vertexTextureCoords = arena.allocate<Vector2>(totals.numTextureCoords);
+	Vector3* vertexNormals = arena.allocate<Vector3>(totals.numNormals);
+
+	parallelFor(numThreads, numChunks, 1, [&](unsigned int, size_t begin, size_t end) {
+		for (size_t c = begin; c < end; c++) {
+			parseVertexLines(chunkStarts[c], chunkStarts[c + 1], vertexPositions + offsets[c].numPositions,
+				vertexTextureCoords + offsets[c].numTextureCoords, vertexNormals + offsets[c].numNormals);
+		}
+	});
+	this->placeVertices(vertexPositions, totals.numPositions, autoCentre, autoNormalize);
+
+	// then parse the faces of every slice, writing their corners straight into the final arrays
+	this->numTriangles = (unsigned int)totals.numTriangles;
+	this->numIndexedVertices = this->numTriangles * 3;
+	this->numVertices = this->numIndexedVertices;
+
+	std::vector<Vector3> indexedPositions(this->numIndexedVertices);
+	std::vector<Vector2> indexedTextureCoords(this->numIndexedVertices);
+	std::vector<Vector3> indexedNormals(this->numIndexedVertices);
+	std::vector<unsigned int> vertexIndices(this->numIndexedVertices);
+	unsigned int* smoothingIds = arena.allocate<unsigned int>(this->numIndexedVertices);
+
+	ObjFaceOutput out;
+	out.records.positions = vertexPositions;
+	out.records.textureCoords = vertexTextureCoords;
+	out.records.normals = vertexNormals;
+	out.records.numPositions = totals.numPositions;
+	out.records.numTextureCoords = totals.numTextureCoords;
+	out.records.numNormals = totals.numNormals;
+	out.positions = indexedPositions.data();
+	out.textureCoords = indexedTextureCoords.data();
+	out.normals = indexedNormals.data();
+	out.smoothingIds = smoothingIds;
+
+	parallelFor(numThreads, numChunks, 1, [&](unsigned int, size_t begin, size_t end) {
+		for (size_t c = begin; c < end; c++) {
+			parseFaceLines(chunkStarts[c], chunkStarts[c + 1], offsets[c], offsets[c].numTriangles * 3, out);
+		}
+	});
+
+	// faces without normals were given flat ones; smooth them across the faces they share positions with
+	generateVertexNormals((const float*)indexedPositions.data(), smoothingIds, this->numIndexedVertices,
+		totals.numPositions, this->creaseAngle, numThreads, (float*)indexedNormals.data());
+
+	size_t meshBytes = (size_t)this->numIndexedVertices * (sizeof(Vector3) + sizeof(Vector2) + sizeof(Vector3) + sizeof(unsigned int));
+	size_t peakBytes = arena.getPeak() + meshBytes;
+	std::cout << "Load memory: peak " << peakBytes / 1024 << " KB for a " << meshBytes / 1024 << " KB mesh ("
+		<< (meshBytes > 0 ? float(peakBytes) / float(meshBytes) : 0.0f) << "x), process peak RSS "
+		<< getPeakResidentBytes() / 1024 << " KB" << std::endl;
+
+	this->buildSubmeshes(parts, vertexIndices);
+
+	this->indexedPositions.assign(std::move(indexedPositions));
+	this->indexedTextureCoords.assign(std::move(indexedTextureCoords));
+	this->indexedNormals.assign(std::move(indexedNormals));
+	this->triangleIndices.assign(std::move(vertexIndices));
+}
+
+void ObjMesh::placeVertices(Vector3* vertexPositions, const size_t numPositions, const bool autoCentre,
+                            const bool autoNormalize) {
+	// for auto-centering and auto-normalization
+	PositionBounds bounds;
+	computePositionBounds((const float*)vertexPositions, numPositions, bounds);
+
+	this->centre.x = bounds.centroid[0];
+	this->centre.y = bounds.centroid[1];
+	this->centre.z = bounds.centroid[2];
+	this->dimensions.x = bounds.max[0] - bounds.min[0];
+	this->dimensions.y = bounds.max[1] - bounds.min[1];
+	this->dimensions.z = bounds.max[2] - bounds.min[2];
+
+	// re-centre this object, if requested, and normalize these coordinates to keep the mesh
+	// between -1 and 1 in all axes, if requested
+	if (autoCentre) {
+		float scale = autoNormalize ? largestExtent(bounds) : 1.0f;
+		transformPositions((float*)vertexPositions, numPositions, bounds.centroid, scale);
+	}
+}
+
+void ObjMesh::expand(ObjChunk &records, const ObjParts &parts, const bool autoCentre, const bool autoNormalize) {
+	unsigned int numThreads = resolveThreadCount(this->numThreads);
+	std::vector<Vector3> &vertexPositions = records.vertexPositions;
+	std::vector<unsigned int> &positionIndices = records.positionIndices;
+	std::vector<unsigned int> &textureCoordIndices = records.textureCoordIndices;
+	std::vector<unsigned int> &normalIndices = records.normalIndices;
+
+	this->numTriangles = (unsigned int)(positionIndices.size() / 3);
+	this->numIndexedVertices = this->numTriangles * 3;
+	this->numVertices = this->numIndexedVertices;
+
+	this->placeVertices(vertexPositions.data(), vertexPositions.size(), autoCentre, autoNormalize);
+
+	// collect the vertex positions, texture coordinates, and normals for each face
+	std::vector<Vector3> indexedPositions(this->numIndexedVertices);
+	std::vector<Vector2> indexedTextureCoords(this->numIndexedVertices);
+	std::vector<Vector3> indexedNormals(this->numIndexedVertices);
+	std::vector<unsigned int> vertexIndices(this->numIndexedVertices);
+	std::vector<unsigned int> smoothingIds(this->numIndexedVertices);
+
+	ObjRecordArrays arrays = recordArrays(records);
+	parallelFor(numThreads, this->numTriangles, 1 << 14, [&](unsigned int, size_t begin, size_t end) {
+		for (size_t t = begin; t < end; t++) {
+			ObjCorner corners[3];
+			for (int c = 0; c < 3; c++) {
+				corners[c].position = positionIndices[t * 3 + c];
+				corners[c].textureCoord = textureCoordIndices[t * 3 + c];
+				corners[c].normal = normalIndices[t * 3 + c];
+				smoothingIds[t * 3 + c] = smoothingId(arrays, corners[c]);
+			}
+			gatherTriangle(arrays, corners, &indexedPositions[t * 3], &indexedTextureCoords[t * 3], &indexedNormals[t * 3]);
+		}
+	});
+	generateVertexNormals((const float*)indexedPositions.data(), smoothingIds.data(), this->numIndexedVertices,
+		vertexPositions.size(), this->creaseAngle, numThreads, (float*)indexedNormals.data());
+	this->buildSubmeshes(parts, vertexIndices);
+
+	this->indexedPositions.assign(std::move(indexedPositions));
+	this->indexedTextureCoords.assign(std::move(indexedTextureCoords));
+	this->indexedNormals.assign(std::move(indexedNormals));
+	this->triangleIndices.assign(std::move(vertexIndices));
+}
+
+void ObjMesh::buildSubmeshes(const ObjParts &parts, std::vector<unsigned int> &indices) {
+	// parts sorted by material, then group, both in order of first use
+	std::vector<unsigned int> order(parts.parts.size());
+	for (unsigned int i = 0; i < order.size(); i++) {
+		order[i] = i;
+	}
+	std::sort(order.begin(), order.end(), [&](unsigned int a, unsigned int b) {
+		return parts.parts[a] < parts.parts[b];
+	});
+
+	// how many triangles each part has, then where each part's range starts
+	std::vector<size_t> partTriangles(parts.parts.size(), 0);
+	for (size_t r = 0; r < parts.runs.size(); r++) {
+		size_t runEnd = r + 1 < parts.runs.size() ? parts.runs[r + 1].firstTriangle : this->numTriangles;
+		partTriangles[parts.runs[r].part] += runEnd - parts.runs[r].firstTriangle;
+	}
+	std::vector<size_t> partStarts(parts.parts.size(), 0);
+	size_t start = 0;
+	this->submeshes.clear();
+	for (size_t i = 0; i < order.size(); i++) {
+		unsigned int part = order[i];
+		partStarts[part] = start;
+		if (partTriangles[part] > 0) {
+			ObjSubmesh submesh;
+			submesh.group = parts.groups[parts.parts[part].second];
+			submesh.material = parts.parts[part].first;
+			submesh.firstIndex = (unsigned int)(start * 3);
+			submesh.numIndices = (unsigned int)(partTriangles[part] * 3);
+			this->submeshes.push_back(submesh);
+		}
+		start += partTriangles[part];
+	}
+
+	// the vertices are in file order, so the index buffer alone is sorted: a stable counting sort
+	// of the triangles by part
+	for (size_t r = 0; r < parts.runs.size(); r++) {
+		size_t runEnd = r + 1 < parts.runs.size() ? parts.runs[r + 1].firstTriangle : this->numTriangles;
+		size_t &next = partStarts[parts.runs[r].part];
+		for (size_t t = parts.runs[r].firstTriangle; t < runEnd; t++, next++) {
+			indices[next * 3 + 0] = (unsigned int)(t * 3 + 0);
+			indices[next * 3 + 1] = (unsigned int)(t * 3 + 1);
+			indices[next * 3 + 2] = (unsigned int)(t * 3 + 2);
+		}
+	}
 }
 
-static inline void rtrim(std::string &s) {
-	s.erase(find_if(s.rbegin(), s.rend(), [](int ch) {
-		return !isspace(ch);
-	}).base(), s.end());
+// whether an accessor holds exactly the array the mesh keeps, tightly packed aligned floats
+static bool isPackedFloats(const GlbAccessor &accessor, const unsigned int components) {
+	return accessor.data != nullptr && accessor.componentType == GLB_FLOAT && accessor.components == components
+		&& accessor.stride == components * sizeof(float) && (uintptr_t)accessor.data % alignof(float) == 0;
 }
 
-static inline void trim(std::string &s) {
-	ltrim(s);
-	rtrim(s);
+// gives each included vertex the id of the first included vertex with exactly the same position,
+// so corners on either side of a texture seam share one; the others get missingIndex
+static void groupPositions(const Vector3* positions, const unsigned char* included, const size_t numVertices,
+	std::vector<unsigned int> &ids) {
+	size_t tableSize = 1;
+	while (tableSize < numVertices * 2) {
+		tableSize *= 2;
+	}
+	std::vector<unsigned int> table(tableSize, missingIndex);
+	ids.assign(numVertices, missingIndex);
+	for (size_t v = 0; v < numVertices; v++) {
+		if (!included[v]) {
+			continue;
+		}
+		uint32_t words[3];
+		memcpy(words, &positions[v], sizeof(words));
+		uint32_t hash = ((words[0] * 73856093u) ^ (words[1] * 19349663u) ^ (words[2] * 83492791u));
+		size_t slot = (hash ^ (hash >> 15)) & (tableSize - 1);
+		while (table[slot] != missingIndex && memcmp(&positions[table[slot]], &positions[v], sizeof(Vector3)) != 0) {
+			slot = (slot + 1) & (tableSize - 1);
+		}
+		if (table[slot] == missingIndex) {
+			table[slot] = (unsigned int)v;
+		}
+		ids[v] = table[slot];
+	}
 }
 
-ObjMesh::ObjMesh() {
-	this->numVertices = 0;
-	this->numTriangles = 0;
+// the name material m of a GLB goes by: its own, unless that is empty or taken by an earlier one
+static std::string glbMaterialName(const std::vector<GlbMaterial> &materials, const size_t m) {
+	bool taken = materials[m].name.empty();
+	for (size_t earlier = 0; !taken && earlier < m; earlier++) {
+		taken = materials[earlier].name == materials[m].name;
+	}
+	return taken ? materials[m].name + "#" + std::to_string(m) : materials[m].name;
 }
 
-void ObjMesh::load(const std::string filename, const bool autoCentre = false, const bool autoNormalize = false) {
-	std::cout << "Loading " << filename.c_str() << "..." << std::endl;
+bool ObjMesh::parseGlb(const GlbContents &contents, const bool autoCentre, const bool autoNormalize,
+                       const bool sharedSource, std::vector<std::string> &materialNames) {
+	const std::vector<GlbPrimitive> &primitives = contents.primitives;
 
-	std::ifstream fileIn(filename);
+	// material 0 is the default, for primitives without one, and GLB material m is material m + 1
+	materialNames.assign(1, std::string());
+	for (size_t m = 0; m < contents.materials.size(); m++) {
+		materialNames.push_back(glbMaterialName(contents.materials, m));
+	}
 
-	if (!fileIn.is_open()) {
-		return;
+	// the primitives in material order, so each material's triangles are one range
+	std::vector<size_t> order(primitives.size());
+	for (size_t i = 0; i < order.size(); i++) {
+		order[i] = i;
 	}
+	std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+		return primitives[a].material < primitives[b].material;
+	});
 
-	std::vector<Vector3> vertexPositions;
-	std::vector<Vector2> vertexTextureCoords;
-	std::vector<Vector3> vertexNormals;
-	std::vector<unsigned int> positionIndices;
-	std::vector<unsigned int> textureCoordIndices;
-	std::vector<unsigned int> normalIndices;
+	size_t numVertices = 0;
+	size_t numIndices = 0;
+	for (size_t i = 0; i < primitives.size(); i++) {
+		size_t corners = primitives[i].indices.data != nullptr ? primitives[i].indices.count : primitives[i].positions.count;
+		numVertices += primitives[i].positions.count;
+		numIndices += corners - corners % 3;
+	}
+	if (numVertices >= (size_t)missingIndex || numIndices >= (size_t)missingIndex) {
+		return false;
+	}
+	this->numVertices = (unsigned int)numVertices;
+	this->numIndexedVertices = (unsigned int)numIndices;
+	this->numTriangles = this->numIndexedVertices / 3;
 
-	numTriangles = 0;
-
-	// for auto-centering
-	float totalX = 0.0f;
-	float totalY = 0.0f;
-	float totalZ = 0.0f;
-
-	float minX = std::numeric_limits<float>::max();
-	float maxX = std::numeric_limits<float>::min();
-	float minY = std::numeric_limits<float>::max();
-	float maxY = std::numeric_limits<float>::min();
-	float minZ = std::numeric_limits<float>::max();
-	float maxZ = std::numeric_limits<float>::min();
-
-	std::string line;
-	while (getline(fileIn, line)) {
-		trim(line);
-		if (line.size() > 0) {
-			// skip empty lines
-			std::stringstream lineIn(line);
-
-			std::string typeIdentifier;
-			lineIn >> typeIdentifier;
-
-			if (typeIdentifier == "v") {
-				// a vertex position
-				float x, y, z;
-				lineIn >> x >> y >> z;
-
-				Vector3 v;
-				v.x = x;
-				v.y = y;
-				v.z = z;
-
-				// for auto-centering
-				totalX += x;
-				totalY += y;
-				totalZ += z;
-
-				// for auto-normalization
-				if (x < minX) {
-					minX = x;
-				}
-				if (x > maxX) {
-					maxX = x;
-				}
-				if (y < minY) {
-					minY = y;
-				}
-				if (y > maxY) {
-					maxY = y;
+	// a lone primitive's arrays that are already in the mesh's format are used where they lie,
+	// except positions that centring would move in a source others read too
+	const GlbPrimitive* only = primitives.size() == 1 ? &primitives[0] : nullptr;
+	bool mapPositions = only != nullptr && isPackedFloats(only->positions, 3) && !(sharedSource && autoCentre);
+	bool mapTextureCoords = only != nullptr && isPackedFloats(only->textureCoords, 2);
+	bool mapNormals = only != nullptr && isPackedFloats(only->normals, 3);
+	bool mapIndices = only != nullptr && only->indices.data != nullptr && only->indices.componentType == GLB_UNSIGNED_INT
+		&& only->indices.stride == sizeof(unsigned int) && (uintptr_t)only->indices.data % alignof(unsigned int) == 0
+		&& only->indices.count % 3 == 0;
+
+	std::vector<Vector3> positions(mapPositions ? 0 : numVertices);
+	std::vector<Vector2> textureCoords(mapTextureCoords ? 0 : numVertices);
+	std::vector<Vector3> normals(mapNormals ? 0 : numVertices);
+	std::vector<unsigned int> indices(mapIndices ? 0 : numIndices);
+	std::vector<unsigned char> needsNormals;
+	this->submeshes.clear();
+
+	size_t firstVertex = 0;
+	size_t firstIndex = 0;
+	for (size_t o = 0; o < order.size(); o++) {
+		const GlbPrimitive &primitive = primitives[order[o]];
+		size_t count = primitive.positions.count;
+		for (size_t v = 0; v < count; v++) {
+			if (!mapPositions) {
+				readGlbFloats(primitive.positions, v, (float*)&positions[firstVertex + v]);
+			}
+			if (!mapTextureCoords) {
+				textureCoords[firstVertex + v] = { 0.0f, 0.0f };
+				if (primitive.textureCoords.data != nullptr) {
+					readGlbFloats(primitive.textureCoords, v, (float*)&textureCoords[firstVertex + v]);
 				}
-				if (z < minZ) {
-					minZ = z;
+			}
+			if (!mapNormals) {
+				normals[firstVertex + v] = { 0.0f, 0.0f, 0.0f };
+				if (primitive.normals.data != nullptr) {
+					readGlbFloats(primitive.normals, v, (float*)&normals[firstVertex + v]);
 				}
-				if (z > maxZ) {
-					maxZ = z;
+			}
+		}
+		if (primitive.normals.data == nullptr) {
+			needsNormals.resize(numVertices, 0);
+			std::fill(needsNormals.begin() + firstVertex, needsNormals.begin() + firstVertex + count, 1);
+		}
+
+		size_t corners = primitive.indices.data != nullptr ? primitive.indices.count : count;
+		corners -= corners % 3;
+		for (size_t c = 0; !mapIndices && c < corners; c++) {
+			size_t index = primitive.indices.data != nullptr ? readGlbIndex(primitive.indices, c) : c;
+			indices[firstIndex + c] = (unsigned int)(firstVertex + index);
+		}
+		if (corners > 0) {
+			ObjSubmesh submesh;
+			submesh.group = primitive.mesh;
+			submesh.material = (unsigned int)(primitive.material + 1);
+			submesh.firstIndex = (unsigned int)firstIndex;
+			submesh.numIndices = (unsigned int)corners;
+			this->submeshes.push_back(submesh);
+		}
+		firstVertex += count;
+		firstIndex += corners;
+	}
+
+	// the mapping is copy-on-write, so the arrays may be written through like owned ones
+	if (mapPositions) {
+		this->indexedPositions.map((Vector3*)only->positions.data, numVertices);
+	} else {
+		this->indexedPositions.assign(std::move(positions));
+	}
+	if (mapTextureCoords) {
+		this->indexedTextureCoords.map((Vector2*)only->textureCoords.data, numVertices);
+	} else {
+		this->indexedTextureCoords.assign(std::move(textureCoords));
+	}
+	if (mapNormals) {
+		this->indexedNormals.map((Vector3*)only->normals.data, numVertices);
+	} else {
+		this->indexedNormals.assign(std::move(normals));
+	}
+	if (mapIndices) {
+		this->triangleIndices.map((unsigned int*)only->indices.data, numIndices);
+	} else {
+		this->triangleIndices.assign(std::move(indices));
+	}
+
+	this->placeVertices(this->indexedPositions.data(), numVertices, autoCentre, autoNormalize);
+
+	// primitives without normals get smooth ones, across the seams where their vertices split by
+	// texture coordinates; the corners of the other vertices take no part
+	if (!needsNormals.empty()) {
+		const unsigned int* triangleIndices = this->triangleIndices.data();
+		const Vector3* vertexPositions = this->indexedPositions.data();
+		std::vector<unsigned int> vertexPositionIds;
+		groupPositions(vertexPositions, needsNormals.data(), numVertices, vertexPositionIds);
+		std::vector<Vector3> cornerPositions(numIndices);
+		std::vector<Vector3> cornerNormals(numIndices, Vector3{ 0.0f, 0.0f, 0.0f });
+		std::vector<unsigned int> positionIds(numIndices);
+		for (size_t c = 0; c < numIndices; c++) {
+			cornerPositions[c] = vertexPositions[triangleIndices[c]];
+			positionIds[c] = vertexPositionIds[triangleIndices[c]];
+		}
+		generateVertexNormals((const float*)cornerPositions.data(), positionIds.data(), numIndices, numVertices,
+			this->creaseAngle, resolveThreadCount(this->numThreads), (float*)cornerNormals.data());
+
+		// a crease can give the corners of one vertex different normals, and each different one
+		// needs a copy of the vertex of its own
+		Vector3* vertexNormals = this->indexedNormals.data();
+		std::vector<unsigned char> assigned(numVertices, 0);
+		std::vector<unsigned int> firstCopy(numVertices, missingIndex);
+		std::vector<unsigned int> copyOf, nextCopy;
+		std::vector<Vector3> copyNormals;
+		std::vector<std::pair<size_t, unsigned int>> movedCorners;
+		for (size_t c = 0; c < numIndices; c++) {
+			if (positionIds[c] == missingIndex) {
+				continue;
+			}
+			unsigned int v = triangleIndices[c];
+			if (!assigned[v]) {
+				vertexNormals[v] = cornerNormals[c];
+				assigned[v] = 1;
+				continue;
+			}
+			if (memcmp(&vertexNormals[v], &cornerNormals[c], sizeof(Vector3)) == 0) {
+				continue;
+			}
+			unsigned int copy = firstCopy[v];
+			while (copy != missingIndex && memcmp(&copyNormals[copy], &cornerNormals[c], sizeof(Vector3)) != 0) {
+				copy = nextCopy[copy];
+			}
+			if (copy == missingIndex) {
+				copy = (unsigned int)copyOf.size();
+				copyOf.push_back(v);
+				copyNormals.push_back(cornerNormals[c]);
+				nextCopy.push_back(firstCopy[v]);
+				firstCopy[v] = copy;
+			}
+			movedCorners.push_back(std::make_pair(c, (unsigned int)(numVertices + copy)));
+		}
+
+		if (!copyOf.empty()) {
+			if (numVertices + copyOf.size() >= (size_t)missingIndex) {
+				return false;
+			}
+			std::vector<Vector3> &positions = this->indexedPositions.edit();
+			std::vector<Vector2> &textureCoords = this->indexedTextureCoords.edit();
+			std::vector<Vector3> &normals = this->indexedNormals.edit();
+			std::vector<unsigned int> &indices = this->triangleIndices.edit();
+			positions.reserve(numVertices + copyOf.size());
+			textureCoords.reserve(numVertices + copyOf.size());
+			for (size_t copy = 0; copy < copyOf.size(); copy++) {
+				positions.push_back(positions[copyOf[copy]]);
+				textureCoords.push_back(textureCoords[copyOf[copy]]);
+			}
+			normals.insert(normals.end(), copyNormals.begin(), copyNormals.end());
+			for (size_t m = 0; m < movedCorners.size(); m++) {
+				indices[movedCorners[m].first] = movedCorners[m].second;
+			}
+			this->numVertices = (unsigned int)positions.size();
+		}
+	}
+	return true;
+}
+
+// the directory part of a path, with its trailing separator, or "" for a bare filename
+static std::string directoryOf(const std::string &filename) {
+	size_t separator = filename.find_last_of("/\\");
+	return separator == std::string::npos ? std::string() : filename.substr(0, separator + 1);
+}
+
+void ObjMesh::loadMaterials(const std::string filename, const std::vector<std::string> &materialNames,
+                            const std::vector<std::string> &materialLibraries) {
+	// every material that faces use, with the defaults until a library defines it
+	std::unordered_map<std::string, unsigned int> materialIds;
+	this->materials.resize(materialNames.size());
+	for (unsigned int m = 0; m < materialNames.size(); m++) {
+		ObjMaterial &material = this->materials[m];
+		material.name = materialNames[m];
+		material.ambient = { 0.0f, 0.0f, 0.0f };
+		material.diffuse = { 1.0f, 1.0f, 1.0f };
+		material.specular = { 0.0f, 0.0f, 0.0f };
+		material.shininess = 0.0f;
+		material.opacity = 1.0f;
+		material.diffuseTexture.clear();
+		materialIds[material.name] = m;
+	}
+
+	// a GLB carries its own materials, which are read again every time like a library
+	if (isGlbFilename(filename)) {
+		this->loadGlbMaterials(filename);
+		return;
+	}
+
+	// libraries are named relative to the OBJ file
+	std::string directory = directoryOf(filename);
+	for (size_t l = 0; l < materialLibraries.size(); l++) {
+		std::string libraryFilename = directory + materialLibraries[l];
+		MappedFile libraryIn;
+		const char* libraryData;
+		size_t librarySize;
+		long long libraryTime;
+		if (!this->openSource(libraryFilename, false, libraryIn, libraryData, librarySize, libraryTime)) {
+			std::cout << "Could not open material library " << libraryFilename.c_str() << ", using default materials" << std::endl;
+			continue;
+		}
+
+		// only the materials in use are kept
+		ObjMaterial* material = nullptr;
+		const char* p = libraryData;
+		const char* end = p + librarySize;
+		while (p < end) {
+			const char* type;
+			const char* body;
+			const char* lineEnd;
+			splitLine(p, end, type, body, lineEnd);
+
+			if (isKeyword(type, body, "newmtl")) {
+				std::unordered_map<std::string, unsigned int>::iterator found = materialIds.find(readName(body, lineEnd));
+				material = found != materialIds.end() ? &this->materials[found->second] : nullptr;
+			} else if (material != nullptr) {
+				if (isKeyword(type, body, "Ka")) {
+					parseVector3(body, lineEnd, material->ambient);
+				} else if (isKeyword(type, body, "Kd")) {
+					parseVector3(body, lineEnd, material->diffuse);
+				} else if (isKeyword(type, body, "Ks")) {
+					parseVector3(body, lineEnd, material->specular);
+				} else if (isKeyword(type, body, "Ns")) {
+					parseFloat(body, lineEnd, material->shininess);
+				} else if (isKeyword(type, body, "d")) {
+					parseFloat(body, lineEnd, material->opacity);
+				} else if (isKeyword(type, body, "Tr")) {
+					float transparency;
+					parseFloat(body, lineEnd, transparency);
+					material->opacity = 1.0f - transparency;
+				} else if (isKeyword(type, body, "map_Kd")) {
+					material->diffuseTexture = readName(body, lineEnd);
 				}
+			}
+
+			p = lineEnd + 1;
+		}
+	}
+}
 
-				vertexPositions.push_back(v);
-			} else if (typeIdentifier == "vt") {
-				// a vertex texture coordinate
-				float u, v;
-				lineIn >> u >> v;
-
-				Vector2 t;
-				t.u = u;
-				t.v = v;
-
-				vertexTextureCoords.push_back(t);
-			} else if (typeIdentifier == "vn") {
-				// a vertex normal
-				float x, y, z;
-				lineIn >> x >> y >> z;
-
-				Vector3 n;
-				n.x = x;
-				n.y = y;
-				n.z = z;
-
-				vertexNormals.push_back(n);
-			} else if (typeIdentifier == "f") {
-				// a face
-				unsigned int p1, t1, n1, p2, t2, n2, p3, t3, n3;
-				sscanf(line.c_str(),
-					     "f %d/%d/%d %d/%d/%d %d/%d/%d",
-				       &p1, &t1, &n1,
-				       &p2, &t2, &n2,
-				       &p3, &t3, &n3);
-
-				positionIndices.push_back(p1 - 1);
- 				positionIndices.push_back(p2 - 1);
- 				positionIndices.push_back(p3 - 1);
-
-				textureCoordIndices.push_back(t1 - 1);
-				textureCoordIndices.push_back(t2 - 1);
-				textureCoordIndices.push_back(t3 - 1);
-
-				normalIndices.push_back(n1 - 1);
-				normalIndices.push_back(n2 - 1);
-				normalIndices.push_back(n3 - 1);
-
-				this->numTriangles++;
+void ObjMesh::loadGlbMaterials(const std::string filename) {
+	MappedFile fileIn;
+	const char* fileData;
+	size_t fileSize;
+	long long modifiedTime;
+	GlbContents contents;
+	std::string error;
+	if (!this->openSource(filename, false, fileIn, fileData, fileSize, modifiedTime)
+		|| !readGlb(fileData, fileSize, contents, error)) {
+		std::cout << "Could not read the materials of " << filename.c_str() << ", using default materials" << std::endl;
+		return;
+	}
+
+	// the base colour stands in for the diffuse colour; like map_Kd, the texture is named
+	// relative to the file
+	for (size_t m = 0; m < contents.materials.size(); m++) {
+		std::string name = glbMaterialName(contents.materials, m);
+		for (size_t i = 1; i < this->materials.size(); i++) {
+			ObjMaterial &material = this->materials[i];
+			if (material.name != name) {
+				continue;
 			}
+			const GlbMaterial &glbMaterial = contents.materials[m];
+			material.diffuse = { glbMaterial.baseColour[0], glbMaterial.baseColour[1], glbMaterial.baseColour[2] };
+			material.opacity = glbMaterial.baseColour[3];
+			material.diffuseTexture = glbMaterial.baseColourTexture;
 		}
 	}
-	this->numIndexedVertices = this->numTriangles * 3;
+}
 
-	// for auto-centering
-	this->centre.x = totalX / float(vertexPositions.size());
-	this->centre.y = totalY / float(vertexPositions.size());
-	this->centre.z = totalZ / float(vertexPositions.size());
+// the exact bits of one expanded vertex, so only truly identical corners are merged
+struct WeldKey {
+	uint32_t words[8];
+};
+typedef struct WeldKey WeldKey;
 
-	// for auto-normalization
-	this->dimensions.x = maxX - minX;
-	this->dimensions.y = maxY - minY;
-	this->dimensions.z = maxZ - minZ;
+static inline WeldKey makeWeldKey(const Vector3 &position, const Vector2 &textureCoord, const Vector3 &normal) {
+	WeldKey key;
+	memcpy(&key.words[0], &position, sizeof(Vector3));
+	memcpy(&key.words[3], &textureCoord, sizeof(Vector2));
+	memcpy(&key.words[5], &normal, sizeof(Vector3));
+	return key;
+}
 
-	// re-centre this object, if requested
-	if (autoCentre) {
-		totalX = 0.0f;
-		totalY = 0.0f;
-		totalZ = 0.0f;
-		for (unsigned int i = 0; i < vertexPositions.size(); i++) {
-			vertexPositions[i].x -= this->centre.x;
-			vertexPositions[i].y -= this->centre.y;
-			vertexPositions[i].z -= this->centre.z;
-		}
-
-		// normalize these coordinates to keep the mesh between -1 and 1 in all axes, if requested
-		if (autoNormalize) {
-			float maxDimension = this->dimensions.x;
-			if (this->dimensions.y > maxDimension) {
-				maxDimension = this->dimensions.y;
+static inline uint32_t hashWeldKey(const WeldKey &key) {
+	uint32_t hash = 2166136261u;
+	for (int i = 0; i < 8; i++) {
+		hash = (hash ^ key.words[i]) * 16777619u;
+	}
+	return hash ^ (hash >> 15);
+}
+
+void ObjMesh::weld() {
+	std::vector<Vector3> &positions = this->indexedPositions.edit();
+	std::vector<Vector2> &textureCoords = this->indexedTextureCoords.edit();
+	std::vector<Vector3> &normals = this->indexedNormals.edit();
+	std::vector<unsigned int> &indices = this->triangleIndices.edit();
+
+	// an open-addressing table from vertex contents to the first vertex that had them; an OBJ's
+	// vertices are still one per corner here, while a GLB's are already indexed
+	size_t numCorners = positions.size();
+	size_t tableSize = 1;
+	while (tableSize < numCorners * 2) {
+		tableSize *= 2;
+	}
+	const unsigned int empty = ~0u;
+	std::vector<unsigned int> table(tableSize, empty);
+
+	// unique vertices are kept in order of first use; a vertex is never moved past itself,
+	// so the arrays can be compacted in place
+	std::vector<unsigned int> remap(numCorners);
+	unsigned int numUnique = 0;
+	for (size_t i = 0; i < numCorners; i++) {
+		WeldKey key = makeWeldKey(positions[i], textureCoords[i], normals[i]);
+		size_t slot = hashWeldKey(key) & (tableSize - 1);
+
+		while (table[slot] != empty) {
+			unsigned int candidate = table[slot];
+			WeldKey other = makeWeldKey(positions[candidate], textureCoords[candidate], normals[candidate]);
+			if (memcmp(&key, &other, sizeof(WeldKey)) == 0) {
+				break;
+			}
+			slot = (slot + 1) & (tableSize - 1);
+		}
+
+		if (table[slot] == empty) {
+			positions[numUnique] = positions[i];
+			textureCoords[numUnique] = textureCoords[i];
+			normals[numUnique] = normals[i];
+			table[slot] = numUnique++;
+		}
+		remap[i] = table[slot];
+	}
+	for (size_t i = 0; i < indices.size(); i++) {
+		indices[i] = remap[indices[i]];
+	}
+
+	positions.resize(numUnique);
+	positions.shrink_to_fit();
+	textureCoords.resize(numUnique);
+	textureCoords.shrink_to_fit();
+	normals.resize(numUnique);
+	normals.shrink_to_fit();
+
+	this->numVertices = numUnique;
+
+	float reuseRatio = numUnique > 0 ? float(numCorners) / float(numUnique) : 0.0f;
+	std::cout << "Welded " << numCorners << " corners into " << numUnique
+		<< " vertices (reuse ratio " << reuseRatio << ")" << std::endl;
+}
+
+void ObjMesh::optimizeCache() {
+	std::vector<unsigned int> &indices = this->triangleIndices.edit();
+
+	// each submesh is reordered on its own, so the material ranges stay intact
+	VertexCacheStats before = analyzeVertexCache(indices.data(), indices.size(), this->numVertices, VERTEX_CACHE_REPORT_SIZE);
+	for (size_t s = 0; s < this->submeshes.size(); s++) {
+		const ObjSubmesh &submesh = this->submeshes[s];
+		::optimizeVertexCache(indices.data() + submesh.firstIndex, submesh.numIndices, this->numVertices);
+	}
+	VertexCacheStats after = analyzeVertexCache(indices.data(), indices.size(), this->numVertices, VERTEX_CACHE_REPORT_SIZE);
+
+	std::cout << "Vertex cache: ACMR " << before.acmr << " -> " << after.acmr
+		<< ", ATVR " << before.atvr << " -> " << after.atvr << std::endl;
+
+	if (this->optimizeOverdraw) {
+		const float* positions = (const float*)this->indexedPositions.data();
+
+		// measured the way the renderer draws it, which only culls back faces on a closed mesh
+		bool cullBackFaces = this->isClosed();
+		OverdrawStats overdrawBefore = analyzeOverdraw(indices.data(), indices.size(), positions, this->numVertices, cullBackFaces);
+		for (size_t s = 0; s < this->submeshes.size(); s++) {
+			const ObjSubmesh &submesh = this->submeshes[s];
+			::optimizeOverdraw(indices.data() + submesh.firstIndex, submesh.numIndices, positions, this->numVertices,
+				overdrawCacheThreshold);
+		}
+		OverdrawStats overdrawAfter = analyzeOverdraw(indices.data(), indices.size(), positions, this->numVertices, cullBackFaces);
+		VertexCacheStats cacheAfter = analyzeVertexCache(indices.data(), indices.size(), this->numVertices, VERTEX_CACHE_REPORT_SIZE);
+
+		std::cout << "Overdraw: " << overdrawBefore.overdraw << " -> " << overdrawAfter.overdraw
+			<< " (ACMR " << cacheAfter.acmr << ")" << std::endl;
+	}
+}
+
+// fetch statistics over the three separate attribute arrays together
+static VertexFetchStats analyzeAttributeFetch(const unsigned int* indices, const size_t numIndices, const size_t numVertices) {
+	const size_t attributeSizes[3] = { sizeof(Vector3), sizeof(Vector2), sizeof(Vector3) };
+
+	VertexFetchStats total;
+	total.bytesFetched = 0;
+	double bytesUsed = 0.0;
+	for (int i = 0; i < 3; i++) {
+		VertexFetchStats stats = analyzeVertexFetch(indices, numIndices, numVertices, attributeSizes[i]);
+		total.bytesFetched += stats.bytesFetched;
+		if (stats.overfetch > 0.0f) {
+			bytesUsed += (double)stats.bytesFetched / stats.overfetch;
+		}
+	}
+	total.overfetch = bytesUsed > 0.0 ? (float)(total.bytesFetched / bytesUsed) : 0.0f;
+	return total;
+}
+
+void ObjMesh::optimizeFetch() {
+	std::vector<unsigned int> &indices = this->triangleIndices.edit();
+
+	VertexFetchStats before = analyzeAttributeFetch(indices.data(), indices.size(), this->numVertices);
+
+	std::vector<unsigned int> remap;
+	optimizeVertexFetchRemap(indices.data(), indices.size(), this->numVertices, remap);
+	remapVertices(this->indexedPositions.edit(), remap);
+	remapVertices(this->indexedTextureCoords.edit(), remap);
+	remapVertices(this->indexedNormals.edit(), remap);
+
+	VertexFetchStats after = analyzeAttributeFetch(indices.data(), indices.size(), this->numVertices);
+
+	std::cout << "Vertex fetch: overfetch " << before.overfetch << " -> " << after.overfetch
+		<< " (" << before.bytesFetched << " -> " << after.bytesFetched << " bytes)" << std::endl;
+}
+
+void ObjMesh::computeTangents() {
+	std::vector<Vector4> tangents(this->numVertices);
+	generateVertexTangents((const float*)this->indexedPositions.data(), (const float*)this->indexedTextureCoords.data(),
+		(const float*)this->indexedNormals.data(), this->numVertices, this->triangleIndices.data(),
+		this->numIndexedVertices, resolveThreadCount(this->numThreads), (float*)tangents.data());
+	this->indexedTangents.assign(std::move(tangents));
+}
+
+// builds up to maxLods coarser index lists over the same vertices, each simplified to about half the
+// one before, with the error each added up to so that a distance can be mapped to a level
+void ObjMesh::generateLevelsOfDetail() {
+	// collapses pick the vertex whose texture coordinates and normal are closest to the one that moves
+	const unsigned int attributeSize = 5;
+	std::vector<float> attributes(this->numVertices * attributeSize);
+	for (size_t v = 0; v < this->numVertices; v++) {
+		const Vector2 &textureCoord = this->indexedTextureCoords.data()[v];
+		const Vector3 &normal = this->indexedNormals.data()[v];
+		float* attribute = &attributes[v * attributeSize];
+		attribute[0] = textureCoord.u;
+		attribute[1] = textureCoord.v;
+		attribute[2] = normal.x;
+		attribute[3] = normal.y;
+		attribute[4] = normal.z;
+	}
+
+	// every triangle keeps its material, and the outlines between materials keep their shape
+	std::vector<unsigned int> groups(this->numIndexedVertices / 3, 0);
+	for (size_t s = 0; s < this->submeshes.size(); s++) {
+		const ObjSubmesh &submesh = this->submeshes[s];
+		std::fill(groups.begin() + submesh.firstIndex / 3, groups.begin() + (submesh.firstIndex + submesh.numIndices) / 3,
+			submesh.material);
+	}
+
+	// each level simplifies the one before, so their errors add up
+	std::vector<unsigned int> level(this->triangleIndices.data(), this->triangleIndices.data() + this->numIndexedVertices);
+	std::vector<unsigned int> simplified(level.size());
+	std::vector<unsigned int> simplifiedGroups(groups.size());
+	std::vector<unsigned int> indices;
+	std::vector<ObjDrawRange> ranges;
+	std::vector<ObjLod> levels;
+	const float* positions = (const float*)this->indexedPositions.data();
+	float error = 0.0f;
+
+	std::cout << "Levels of detail: " << level.size() / 3;
+	for (unsigned int l = 0; l < maxLods; l++) {
+		size_t targetIndices = (size_t)((float)level.size() * lodReduction) / 3 * 3;
+		float levelError;
+		size_t numIndices = simplifyMesh(simplified.data(), level.data(), level.size(), positions, attributes.data(),
+			attributeSize, this->numVertices, groups.data(), simplifiedGroups.data(), targetIndices, 1.0f, levelError);
+		if (numIndices == 0 || (float)numIndices > (float)level.size() * minLodReduction) {
+			break;
+		}
+		error += levelError;
+
+		// the triangles keep their order, so each material's are still adjacent
+		ObjLod lod = { error, (unsigned int)ranges.size(), 0 };
+		for (size_t t = 0; t < numIndices / 3; t++) {
+			if (lod.numRanges == 0 || ranges.back().material != simplifiedGroups[t]) {
+				ObjDrawRange range = { simplifiedGroups[t], (unsigned int)(indices.size() + t * 3), 0 };
+				ranges.push_back(range);
+				lod.numRanges++;
 			}
-			if (this->dimensions.z > maxDimension) {
-				maxDimension = this->dimensions.z;
+			ranges.back().numIndices += 3;
+		}
+		if (this->optimizeVertexCache || this->optimizeOverdraw) {
+			for (unsigned int r = lod.firstRange; r < lod.firstRange + lod.numRanges; r++) {
+				::optimizeVertexCache(simplified.data() + (ranges[r].firstIndex - indices.size()), ranges[r].numIndices,
+					this->numVertices);
 			}
-			for (unsigned int i = 0; i < vertexPositions.size(); i++) {
-				vertexPositions[i].x /= maxDimension;
-				vertexPositions[i].y /= maxDimension;
-				vertexPositions[i].z /= maxDimension;
+		}
+		indices.insert(indices.end(), simplified.begin(), simplified.begin() + numIndices);
+		levels.push_back(lod);
+		std::cout << " -> " << numIndices / 3 << " (error " << error << ")";
+
+		level.assign(simplified.begin(), simplified.begin() + numIndices);
+		groups.assign(simplifiedGroups.begin(), simplifiedGroups.begin() + numIndices / 3);
+	}
+	std::cout << " triangles" << std::endl;
+
+	this->lodIndices.assign(std::move(indices));
+	this->lodRanges.swap(ranges);
+	this->lods.swap(levels);
+}
+
+void ObjMesh::partitionMeshlets() {
+	std::vector<unsigned int> &indices = this->triangleIndices.edit();
+	const float* positions = (const float*)this->indexedPositions.data();
+
+	// each submesh is split on its own, so no meshlet straddles two materials
+	for (size_t s = 0; s < this->submeshes.size(); s++) {
+		const ObjSubmesh &submesh = this->submeshes[s];
+		size_t first = this->meshlets.size();
+		buildMeshlets(indices.data() + submesh.firstIndex, submesh.numIndices, positions, this->numVertices,
+			MESHLET_MAX_VERTICES, MESHLET_MAX_TRIANGLES, this->meshlets);
+		for (size_t m = first; m < this->meshlets.size(); m++) {
+			this->meshlets[m].firstIndex += submesh.firstIndex;
+		}
+	}
+	if (this->submeshes.empty()) {
+		buildMeshlets(indices.data(), indices.size(), positions, this->numVertices, MESHLET_MAX_VERTICES,
+			MESHLET_MAX_TRIANGLES, this->meshlets);
+	}
+	VertexCacheStats stats = analyzeVertexCache(indices.data(), indices.size(), this->numVertices, VERTEX_CACHE_REPORT_SIZE);
+
+	size_t numConed = 0;
+	size_t numMeshletVertices = 0;
+	for (size_t m = 0; m < this->meshlets.size(); m++) {
+		numConed += this->meshlets[m].coneCutoff < 1.0f ? 1 : 0;
+		numMeshletVertices += this->meshlets[m].numVertices;
+	}
+	float numMeshlets = (float)std::max((size_t)1, this->meshlets.size());
+	std::cout << "Meshlets: " << this->meshlets.size() << ", " << (float)numMeshletVertices / numMeshlets
+		<< " vertices and " << (float)this->numTriangles / numMeshlets << " triangles each, " << numConed
+		<< " with a usable normal cone (ACMR " << stats.acmr << ")" << std::endl;
+}
+
+void ObjMesh::subdivide() {
+	// the first level refines the mesh itself, each triangle grouped by its material
+	SubdivisionMesh base;
+	const SubdivisionMesh* source = &base;
+	if (this->subdivisions.empty()) {
+		const float* positions = (const float*)this->indexedPositions.data();
+		const float* textureCoords = (const float*)this->indexedTextureCoords.data();
+		const float* normals = (const float*)this->indexedNormals.data();
+		const unsigned int* indices = this->triangleIndices.data();
+		base.positions.assign(positions, positions + (size_t)this->numVertices * 3);
+		base.textureCoords.assign(textureCoords, textureCoords + (size_t)this->numVertices * 2);
+		base.normals.assign(normals, normals + (size_t)this->numVertices * 3);
+		base.indices.assign(indices, indices + this->numIndexedVertices);
+		base.groups.assign(this->numTriangles, 0);
+		for (size_t s = 0; s < this->submeshes.size(); s++) {
+			const ObjSubmesh &submesh = this->submeshes[s];
+			std::fill(base.groups.begin() + submesh.firstIndex / 3, base.groups.begin() + (submesh.firstIndex + submesh.numIndices) / 3,
+				submesh.material);
+		}
+	} else {
+		source = &this->subdivisions.back()->mesh;
+	}
+
+	PositionBounds bounds;
+	computePositionBounds(source->positions.data(), source->positions.size() / 3, bounds);
+	unsigned int numThreads = resolveThreadCount(this->numThreads);
+	std::unique_ptr<ObjSubdivision> level(new ObjSubdivision());
+	SubdivisionStats stats;
+	subdivideMesh(*source, this->subdivisionCurvature, minSubdivisionEdge * largestExtent(bounds), numThreads, level->mesh, stats);
+
+	SubdivisionMesh &mesh = level->mesh;
+	size_t numVertices = mesh.positions.size() / 3;
+	level->tangents.resize(numVertices);
+	generateVertexTangents(mesh.positions.data(), mesh.textureCoords.data(), mesh.normals.data(), numVertices,
+		mesh.indices.data(), mesh.indices.size(), numThreads, (float*)level->tangents.data());
+
+	// the children keep their triangles' places, so each material is still one range
+	for (size_t t = 0; t < mesh.groups.size(); t++) {
+		if (!level->drawRanges.empty() && level->drawRanges.back().material == mesh.groups[t]) {
+			level->drawRanges.back().numIndices += 3;
+		} else {
+			ObjDrawRange range = { mesh.groups[t], (unsigned int)(t * 3), 3 };
+			level->drawRanges.push_back(range);
+		}
+	}
+
+	std::cout << "Subdivision level " << this->subdivisions.size() + 1 << ": " << source->indices.size() / 3 << " -> "
+		<< mesh.indices.size() / 3 << " triangles, " << stats.numRefined << " refined and " << stats.numBisected
+		<< " bisected" << std::endl;
+	// the source's curved edges come with the pass, unless they were measured already
+	if (this->subdivisionEdgeLengths.size() == this->subdivisions.size()) {
+		this->subdivisionEdgeLengths.push_back(stats.curvedEdgeLength);
+	}
+	this->subdivisions.push_back(std::move(level));
+}
+
+// interleaving is left out of the cache, which would otherwise hold every vertex twice; it is
+// cheap next to a parse
+void ObjMesh::interleave() {
+	if (!this->interleaveVertices) {
+		std::vector<unsigned char>().swap(this->interleavedVertices);
+		return;
+	}
+
+	VertexLayout layout = floatVertexLayout();
+	const void* attributes[VERTEX_NUM_ATTRIBUTES];
+	attributes[VERTEX_POSITION] = this->indexedPositions.data();
+	attributes[VERTEX_TEXTURE_COORDS] = this->indexedTextureCoords.data();
+	attributes[VERTEX_NORMAL] = this->indexedNormals.data();
+	attributes[VERTEX_TANGENT] = this->indexedTangents.data();
+
+	std::vector<unsigned char> interleaved((size_t)this->numVertices * layout.stride);
+	::interleaveVertices(layout, attributes, this->numVertices, interleaved.data());
+	this->interleavedVertices = std::move(interleaved);
+}
+
+// like interleaving, the draw indices are rebuilt rather than cached, as they are quick to derive
+void ObjMesh::compactIndices() {
+	// level 0 is one range per material; the submeshes are sorted by material, so each material's are adjacent
+	this->drawRanges.clear();
+	for (size_t s = 0; s < this->submeshes.size(); s++) {
+		const ObjSubmesh &submesh = this->submeshes[s];
+		if (!this->drawRanges.empty() && this->drawRanges.back().material == submesh.material) {
+			this->drawRanges.back().numIndices = submesh.firstIndex + submesh.numIndices - this->drawRanges.back().firstIndex;
+		} else if (submesh.numIndices > 0) {
+			ObjDrawRange range = { submesh.material, submesh.firstIndex, submesh.numIndices };
+			this->drawRanges.push_back(range);
+		}
+	}
+	if (this->submeshes.empty() && this->numIndexedVertices > 0) {
+		ObjDrawRange range = { 0, 0, this->numIndexedVertices };
+		this->drawRanges.push_back(range);
+	}
+	if (!this->meshlets.empty()) {
+		// or one per meshlet, each inside one of those
+		std::vector<ObjDrawRange> materialRanges;
+		materialRanges.swap(this->drawRanges);
+		size_t r = 0;
+		for (size_t m = 0; m < this->meshlets.size(); m++) {
+			const Meshlet &meshlet = this->meshlets[m];
+			while (r + 1 < materialRanges.size()
+				&& materialRanges[r].firstIndex + materialRanges[r].numIndices <= meshlet.firstIndex) {
+				r++;
 			}
+			ObjDrawRange range = { materialRanges[r].material, meshlet.firstIndex, meshlet.numIndices };
+			this->drawRanges.push_back(range);
 		}
 	}
+	this->drawLods.clear();
+	ObjLod fullLod = { 0.0f, 0, (unsigned int)this->drawRanges.size() };
+	this->drawLods.push_back(fullLod);
 
-	// collect the vertex positions, texture coordinates, and normals for each face
-	std::vector<Vector3> indexedPositions;
-	std::vector<Vector2> indexedTextureCoords;
-	std::vector<Vector3> indexedNormals;
-	std::vector<unsigned int> vertexIndices;
+	// the coarser levels' indices follow the full mesh's, so every level is a range of one list
+	const unsigned int* list = this->triangleIndices.data();
+	size_t listSize = this->numIndexedVertices;
+	std::vector<unsigned int> levels;
+	if (!this->lods.empty()) {
+		levels.reserve(this->numIndexedVertices + this->lodIndices.size());
+		levels.insert(levels.end(), this->triangleIndices.data(), this->triangleIndices.data() + this->numIndexedVertices);
+		levels.insert(levels.end(), this->lodIndices.data(), this->lodIndices.data() + this->lodIndices.size());
+		list = levels.data();
+		listSize = levels.size();
+	}
+	for (size_t l = 0; l < this->lods.size(); l++) {
+		ObjLod lod = { this->lods[l].error, (unsigned int)this->drawRanges.size(), this->lods[l].numRanges };
+		for (unsigned int r = 0; r < lod.numRanges; r++) {
+			ObjDrawRange range = this->lodRanges[this->lods[l].firstRange + r];
+			range.firstIndex += this->numIndexedVertices;
+			this->drawRanges.push_back(range);
+		}
+		this->drawLods.push_back(lod);
+	}
+
+	// 16 bits whenever every vertex fits below the restart index
+	bool shortIndices = this->numVertices <= 0xffff;
+	this->drawIndexSize = shortIndices ? sizeof(unsigned short) : sizeof(unsigned int);
+	this->drawPrimitive = OBJ_TRIANGLES;
+	std::vector<unsigned int>().swap(this->longDrawIndices);
+
+	std::vector<unsigned int> strips;
+	if (this->generateStrips) {
+		// each range is drawn on its own, so its strips start afresh
+		std::vector<ObjDrawRange> stripRanges(this->drawRanges);
+		size_t numStrips = 0;
+		for (size_t r = 0; r < stripRanges.size(); r++) {
+			stripRanges[r].firstIndex = (unsigned int)strips.size();
+			numStrips += stripifyTriangles(list + this->drawRanges[r].firstIndex, this->drawRanges[r].numIndices,
+				this->getRestartIndex(), strips);
+			stripRanges[r].numIndices = (unsigned int)strips.size() - stripRanges[r].firstIndex;
+		}
+
+		if (strips.size() < listSize) {
+			std::cout << "Triangle strips: " << numStrips << " strips, " << listSize << " -> "
+				<< strips.size() << " indices" << std::endl;
+			this->drawRanges.swap(stripRanges);
+			this->drawPrimitive = OBJ_TRIANGLE_STRIP;
+		} else {
+			std::cout << "Triangle strips: " << strips.size() << " indices, no shorter than the list; keeping the list"
+				<< std::endl;
+			std::vector<unsigned int>().swap(strips);
+		}
+	}
+
+	const unsigned int* source = this->drawPrimitive == OBJ_TRIANGLE_STRIP ? strips.data() : list;
+	this->numDrawIndices = this->drawPrimitive == OBJ_TRIANGLE_STRIP ? (unsigned int)strips.size() : (unsigned int)listSize;
+	if (shortIndices) {
+		// the 32-bit restart marker narrows to the 16-bit one
+		std::vector<unsigned short> narrowed(this->numDrawIndices);
+		for (size_t i = 0; i < narrowed.size(); i++) {
+			narrowed[i] = (unsigned short)source[i];
+		}
+		this->shortDrawIndices.swap(narrowed);
+	} else {
+		std::vector<unsigned short>().swap(this->shortDrawIndices);
+		// a plain list of the full mesh alone is drawn straight from triangleIndices
+		this->longDrawIndices.swap(this->drawPrimitive == OBJ_TRIANGLE_STRIP ? strips : levels);
+	}
+
+	std::cout << "Draw indices: " << listSize * sizeof(unsigned int) << " -> "
+		<< this->numDrawIndices * this->drawIndexSize << " bytes" << std::endl;
+}
+
+bool ObjMesh::loadCache(const std::string filename, const std::string cacheFilename, const MeshCacheKey &key) {
+	// a cache in the pack is used where it lies, like a mapped one; a stale one falls back to the loose cache
+	const AssetEntry* packed = this->assetPack != nullptr ? this->assetPack->find(cacheFilename) : nullptr;
+	bool opened = packed != nullptr && packed->format == ASSET_RAW && this->cache.open(packed->data, packed->size, key);
+	if (!opened && !this->cache.open(cacheFilename, key)) {
+		return false;
+	}
+
+	size_t infoSize, positionsSize, textureCoordsSize, normalsSize, tangentsSize, indicesSize, submeshesSize, namesSize;
+	size_t lodsSize, lodRangesSize, lodIndicesSize, meshletsSize;
+	CacheInfo* info = (CacheInfo*)this->cache.getSection(CACHE_INFO, infoSize);
+	Vector3* positions = (Vector3*)this->cache.getSection(CACHE_POSITIONS, positionsSize);
+	Vector2* textureCoords = (Vector2*)this->cache.getSection(CACHE_TEXTURE_COORDS, textureCoordsSize);
+	Vector3* normals = (Vector3*)this->cache.getSection(CACHE_NORMALS, normalsSize);
+	Vector4* tangents = (Vector4*)this->cache.getSection(CACHE_TANGENTS, tangentsSize);
+	unsigned int* indices = (unsigned int*)this->cache.getSection(CACHE_TRIANGLE_INDICES, indicesSize);
+	CachedSubmesh* submeshes = (CachedSubmesh*)this->cache.getSection(CACHE_SUBMESHES, submeshesSize);
+	const char* names = (const char*)this->cache.getSection(CACHE_NAMES, namesSize);
+	ObjLod* lods = (ObjLod*)this->cache.getSection(CACHE_LODS, lodsSize);
+	ObjDrawRange* lodRanges = (ObjDrawRange*)this->cache.getSection(CACHE_LOD_RANGES, lodRangesSize);
+	unsigned int* lodIndices = (unsigned int*)this->cache.getSection(CACHE_LOD_INDICES, lodIndicesSize);
+	Meshlet* meshlets = (Meshlet*)this->cache.getSection(CACHE_MESHLETS, meshletsSize);
+
+	bool valid = info != nullptr && infoSize == sizeof(CacheInfo)
+		&& positionsSize == info->numVertices * sizeof(Vector3)
+		&& textureCoordsSize == info->numVertices * sizeof(Vector2)
+		&& normalsSize == info->numVertices * sizeof(Vector3)
+		&& tangentsSize == info->numVertices * sizeof(Vector4)
+		&& indicesSize == info->numTriangles * 3 * sizeof(unsigned int)
+		&& submeshesSize == info->numSubmeshes * sizeof(CachedSubmesh)
+		&& lodsSize == info->numLods * sizeof(ObjLod)
+		&& lodRangesSize == info->numLodRanges * sizeof(ObjDrawRange)
+		&& lodIndicesSize == info->numLodIndices * sizeof(unsigned int)
+		&& meshletsSize == info->numMeshlets * sizeof(Meshlet);
+
+	// the names of the materials, their libraries and the submeshes' groups
+	std::vector<std::string> materialNames;
+	std::vector<std::string> materialLibraries;
+	std::vector<ObjSubmesh> cachedSubmeshes;
+	size_t offset = 0;
+	for (uint32_t i = 0; valid && i < info->numMaterials + info->numMaterialLibraries; i++) {
+		std::string name;
+		valid = readCachedName(names, namesSize, offset, name);
+		offset += name.size() + 1;
+		(i < info->numMaterials ? materialNames : materialLibraries).push_back(name);
+	}
+	for (uint32_t s = 0; valid && s < info->numSubmeshes; s++) {
+		ObjSubmesh submesh;
+		submesh.material = submeshes[s].material;
+		submesh.firstIndex = submeshes[s].firstIndex;
+		submesh.numIndices = submeshes[s].numIndices;
+		valid = readCachedName(names, namesSize, submeshes[s].group, submesh.group)
+			&& submesh.material < info->numMaterials
+			&& (uint64_t)submesh.firstIndex + submesh.numIndices <= (uint64_t)info->numTriangles * 3;
+		cachedSubmeshes.push_back(submesh);
+	}
+	for (uint32_t l = 0; valid && l < info->numLods; l++) {
+		valid = (uint64_t)lods[l].firstRange + lods[l].numRanges <= info->numLodRanges;
+	}
+	for (uint32_t r = 0; valid && r < info->numLodRanges; r++) {
+		valid = lodRanges[r].material < info->numMaterials
+			&& (uint64_t)lodRanges[r].firstIndex + lodRanges[r].numIndices <= info->numLodIndices;
+	}
+	for (uint32_t m = 0; valid && m < info->numMeshlets; m++) {
+		valid = (uint64_t)meshlets[m].firstIndex + meshlets[m].numIndices <= (uint64_t)info->numTriangles * 3;
+	}
+	if (!valid) {
+		this->cache.close();
+		return false;
+	}
+
+	this->numVertices = info->numVertices;
+	this->numTriangles = info->numTriangles;
+	this->numIndexedVertices = info->numIndexedVertices;
+	this->centre = info->centre;
+	this->dimensions = info->dimensions;
+
+	this->indexedPositions.map(positions, info->numVertices);
+	this->indexedTextureCoords.map(textureCoords, info->numVertices);
+	this->indexedNormals.map(normals, info->numVertices);
+	this->indexedTangents.map(tangents, info->numVertices);
+	this->triangleIndices.map(indices, info->numTriangles * 3);
+	this->lodIndices.map(lodIndices, info->numLodIndices);
+	this->lodRanges.assign(lodRanges, lodRanges + info->numLodRanges);
+	this->lods.assign(lods, lods + info->numLods);
+	this->meshlets.assign(meshlets, meshlets + info->numMeshlets);
+
+	// material definitions are read from their libraries every time, so edits to them show
+	this->submeshes = cachedSubmeshes;
+	this->loadMaterials(filename, materialNames, materialLibraries);
 
-	for (unsigned int i = 0; i < this->numIndexedVertices; i++) {
-		unsigned int positionIndex = positionIndices[i];
-		unsigned int textureCoordIndex = textureCoordIndices[i];
-		unsigned int normalIndex = normalIndices[i];
+	return true;
+}
 
-		indexedPositions.push_back(vertexPositions[positionIndex]);
-		indexedTextureCoords.push_back(vertexTextureCoords[textureCoordIndex]);
-		indexedNormals.push_back(vertexNormals[normalIndex]);
+void ObjMesh::saveCache(const std::string cacheFilename, const MeshCacheKey &key, const std::vector<std::string> &materialLibraries) {
+	// any previous mapping of this file must go before it is replaced
+	this->cache.close();
 
-		vertexIndices.push_back(i);
+	std::string names;
+	for (size_t m = 0; m < this->materials.size(); m++) {
+		names.append(this->materials[m].name).push_back('\0');
+	}
+	for (size_t l = 0; l < materialLibraries.size(); l++) {
+		names.append(materialLibraries[l]).push_back('\0');
 	}
+	std::vector<CachedSubmesh> submeshes(this->submeshes.size());
+	for (size_t s = 0; s < this->submeshes.size(); s++) {
+		submeshes[s].firstIndex = this->submeshes[s].firstIndex;
+		submeshes[s].numIndices = this->submeshes[s].numIndices;
+		submeshes[s].material = this->submeshes[s].material;
+		submeshes[s].group = (uint32_t)names.size();
+		names.append(this->submeshes[s].group).push_back('\0');
+	}
+
+	CacheInfo info;
+	info.numVertices = this->numVertices;
+	info.numTriangles = this->numTriangles;
+	info.numIndexedVertices = this->numIndexedVertices;
+	info.numSubmeshes = (uint32_t)this->submeshes.size();
+	info.centre = this->centre;
+	info.dimensions = this->dimensions;
+	info.numMaterials = (uint32_t)this->materials.size();
+	info.numMaterialLibraries = (uint32_t)materialLibraries.size();
+	info.numLods = (uint32_t)this->lods.size();
+	info.numLodRanges = (uint32_t)this->lodRanges.size();
+	info.numLodIndices = (uint32_t)this->lodIndices.size();
+	info.numMeshlets = (uint32_t)this->meshlets.size();
 
-	this->indexedPositions = indexedPositions;
-	this->indexedTextureCoords = indexedTextureCoords;
-	this->indexedNormals = indexedNormals;
-	this->triangleIndices = vertexIndices;
+	this->cache.addSection(CACHE_INFO, &info, sizeof(info));
+	this->cache.addSection(CACHE_POSITIONS, this->indexedPositions.data(), this->indexedPositions.size() * sizeof(Vector3));
+	this->cache.addSection(CACHE_TEXTURE_COORDS, this->indexedTextureCoords.data(), this->indexedTextureCoords.size() * sizeof(Vector2));
+	this->cache.addSection(CACHE_NORMALS, this->indexedNormals.data(), this->indexedNormals.size() * sizeof(Vector3));
+	this->cache.addSection(CACHE_TANGENTS, this->indexedTangents.data(), this->indexedTangents.size() * sizeof(Vector4));
+	this->cache.addSection(CACHE_TRIANGLE_INDICES, this->triangleIndices.data(), this->triangleIndices.size() * sizeof(unsigned int));
+	this->cache.addSection(CACHE_SUBMESHES, submeshes.data(), submeshes.size() * sizeof(CachedSubmesh));
+	this->cache.addSection(CACHE_NAMES, names.data(), names.size());
+	this->cache.addSection(CACHE_LODS, this->lods.data(), this->lods.size() * sizeof(ObjLod));
+	this->cache.addSection(CACHE_LOD_RANGES, this->lodRanges.data(), this->lodRanges.size() * sizeof(ObjDrawRange));
+	this->cache.addSection(CACHE_LOD_INDICES, this->lodIndices.data(), this->lodIndices.size() * sizeof(unsigned int));
+	this->cache.addSection(CACHE_MESHLETS, this->meshlets.data(), this->meshlets.size() * sizeof(Meshlet));
+
+	if (!this->cache.save(cacheFilename, key)) {
+		std::cout << "Could not write mesh cache " << cacheFilename.c_str() << std::endl;
+	}
 }
 
 Vector3 ObjMesh::getCentre() {
@@ -245,6 +2510,18 @@ Vector3* ObjMesh::getIndexedNormals() {
 	return this->indexedNormals.data();
 }
 
+Vector4* ObjMesh::getIndexedTangents() {
+	return this->indexedTangents.data();
+}
+
+unsigned char* ObjMesh::getInterleavedVertices() {
+	return this->interleavedVertices.empty() ? nullptr : this->interleavedVertices.data();
+}
+
+VertexLayout ObjMesh::getVertexLayout() {
+	return floatVertexLayout();
+}
+
 unsigned int ObjMesh::getNumTriangles() {
 	return this->numTriangles;
 }
@@ -256,3 +2533,137 @@ unsigned int ObjMesh::getNumIndexedVertices() {
 unsigned int* ObjMesh::getTriangleIndices() {
 	return this->triangleIndices.data();
 }
+
+void* ObjMesh::getDrawIndices() {
+	if (this->drawIndexSize == sizeof(unsigned short)) {
+		return this->shortDrawIndices.data();
+	}
+	// a 32-bit list of the full mesh alone is the triangle list itself
+	return this->longDrawIndices.empty() ? this->triangleIndices.data() : this->longDrawIndices.data();
+}
+
+unsigned int ObjMesh::getNumDrawIndices() {
+	return this->numDrawIndices;
+}
+
+unsigned int ObjMesh::getDrawIndexSize() {
+	return this->drawIndexSize;
+}
+
+ObjPrimitive ObjMesh::getDrawPrimitive() {
+	return this->drawPrimitive;
+}
+
+unsigned int ObjMesh::getRestartIndex() {
+	return this->drawIndexSize == sizeof(unsigned short) ? 0xffff : 0xffffffff;
+}
+
+unsigned int ObjMesh::getNumDrawRanges() {
+	return (unsigned int)this->drawRanges.size();
+}
+
+ObjDrawRange* ObjMesh::getDrawRanges() {
+	return this->drawRanges.data();
+}
+
+unsigned int ObjMesh::getNumLods() {
+	return (unsigned int)this->drawLods.size();
+}
+
+ObjLod* ObjMesh::getLods() {
+	return this->drawLods.data();
+}
+
+void ObjMesh::setSubdivisionCurvature(float degrees) {
+	this->subdivisionCurvature = degrees;
+	this->subdivisions.clear();
+	this->subdivisionEdgeLengths.clear();
+}
+
+unsigned int ObjMesh::getMaxSubdivisionLevel() {
+	return maxSubdivisionLevels;
+}
+
+ObjSubdivision* ObjMesh::getSubdivision(unsigned int level) {
+	if (level == 0 || level > maxSubdivisionLevels || this->numIndexedVertices == 0) {
+		return nullptr;
+	}
+	while (this->subdivisions.size() < level) {
+		size_t numSourceTriangles = this->subdivisions.empty() ? this->numTriangles
+			: this->subdivisions.back()->mesh.indices.size() / 3;
+		if (numSourceTriangles > maxSubdivisionSourceTriangles) {
+			return nullptr;
+		}
+		this->subdivide();
+	}
+	return this->subdivisions[level - 1].get();
+}
+
+float ObjMesh::getSubdivisionEdgeLength(unsigned int level) {
+	if (level >= maxSubdivisionLevels || this->numIndexedVertices == 0 || (level > 0 && this->getSubdivision(level) == nullptr)) {
+		return 0.0f;
+	}
+	const SubdivisionMesh* source = level > 0 ? &this->subdivisions[level - 1]->mesh : nullptr;
+	size_t numTriangles = source != nullptr ? source->indices.size() / 3 : this->numTriangles;
+	if (numTriangles > maxSubdivisionSourceTriangles) {
+		return 0.0f;
+	}
+
+	// the levels up to this one are built, and each building pass measured the level before, so
+	// only this level itself can be left to measure
+	if (this->subdivisionEdgeLengths.size() <= level) {
+		unsigned int numThreads = resolveThreadCount(this->numThreads);
+		float length = source != nullptr
+			? measureCurvedEdgeLength(source->indices.data(), source->indices.size(), source->positions.data(),
+				source->positions.size() / 3, this->subdivisionCurvature, numThreads)
+			: measureCurvedEdgeLength(this->triangleIndices.data(), this->numIndexedVertices,
+				(const float*)this->indexedPositions.data(), this->numVertices, this->subdivisionCurvature, numThreads);
+		this->subdivisionEdgeLengths.push_back(length);
+	}
+	return this->subdivisionEdgeLengths[level];
+}
+
+unsigned int ObjMesh::getNumMeshlets() {
+	return (unsigned int)this->meshlets.size();
+}
+
+Meshlet* ObjMesh::getMeshlets() {
+	return this->meshlets.data();
+}
+
+void ObjMesh::buildHalfEdges(HalfEdgeMesh &halfEdges) {
+	buildHalfEdgeMesh(this->triangleIndices.data(), this->numIndexedVertices, (const float*)this->indexedPositions.data(),
+		this->numVertices, resolveThreadCount(this->numThreads), halfEdges);
+
+	size_t bytes = getHalfEdgeMemory(halfEdges);
+	std::cout << "Half-edges: " << this->numTriangles << " triangles over " << halfEdges.numPositions << " positions, "
+		<< halfEdges.numBorderEdges << " border edges, " << halfEdges.numNonManifoldHalfEdges << " non-manifold half-edges; "
+		<< bytes << " bytes (" << (this->numTriangles > 0 ? (float)bytes / this->numTriangles : 0.0f) << " per triangle)" << std::endl;
+}
+
+bool ObjMesh::isClosed() {
+	if (!this->closedKnown) {
+		HalfEdgeMesh halfEdges;
+		buildHalfEdgeMesh(this->triangleIndices.data(), this->numIndexedVertices, (const float*)this->indexedPositions.data(),
+			this->numVertices, resolveThreadCount(this->numThreads), halfEdges);
+		this->closed = this->numTriangles > 0 && halfEdges.numBorderEdges == 0 && halfEdges.numNonManifoldHalfEdges == 0;
+		this->closedKnown = true;
+	}
+	return this->closed;
+}
+
+unsigned int ObjMesh::getNumMaterials() {
+	return (unsigned int)this->materials.size();
+}
+
+ObjMaterial* ObjMesh::getMaterials() {
+	return this->materials.data();
+}
+
+unsigned int ObjMesh::getNumSubmeshes() {
+	return (unsigned int)this->submeshes.size();
+}
+
+ObjSubmesh* ObjMesh::getSubmeshes() {
+	return this->submeshes.data();
+}
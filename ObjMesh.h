@@ -1,5 +1,12 @@
 #include <string>
 #include <vector>
+#include <memory>
+
+#include "MeshBuffer.h"
+#include "MeshCache.h"
+#include "VertexLayout.h"
+#include "MeshOptimizer.h"
+#include "MeshSubdivision.h"
 
 #pragma once
 
@@ -14,33 +21,318 @@ struct Vector2 {
 	float v;
 };
 
+struct Vector4 {
+	float x;
+	float y;
+	float z;
+	float w;
+};
+
+// the part of the indexed arrays that a streamBatch() call added
+struct ObjMeshBatch {
+	unsigned int firstVertex;
+	unsigned int numVertices;
+	unsigned int firstIndex;
+	unsigned int numIndices;
+};
+typedef struct ObjMeshBatch ObjMeshBatch;
+
+// a surface description from a .mtl material library; a material that is used but not defined
+// in any library keeps these defaults: white, no specular highlight, and opaque
+struct ObjMaterial {
+	std::string name;
+	Vector3 ambient;
+	Vector3 diffuse;
+	Vector3 specular;
+	float shininess;
+	float opacity;
+	std::string diffuseTexture;
+};
+typedef struct ObjMaterial ObjMaterial;
+
+// a contiguous range of triangleIndices whose faces share a group (o/g) and a material; all the
+// submeshes of a material are adjacent, so each material is one contiguous range
+struct ObjSubmesh {
+	std::string group;
+	unsigned int material;
+	unsigned int firstIndex;
+	unsigned int numIndices;
+};
+typedef struct ObjSubmesh ObjSubmesh;
+
+// the primitive getDrawIndices() holds: a triangle list, or triangle strips separated by
+// getRestartIndex() markers for primitive restart
+enum ObjPrimitive {
+	OBJ_TRIANGLES,
+	OBJ_TRIANGLE_STRIP
+};
+
+// a range of getDrawIndices() that draws all the faces of one material
+struct ObjDrawRange {
+	unsigned int material;
+	unsigned int firstIndex;
+	unsigned int numIndices;
+};
+typedef struct ObjDrawRange ObjDrawRange;
+
+// a level of detail of the whole mesh: numRanges draw ranges from firstRange on, and error, how
+// far its surface may stray from the full mesh's, in mesh units (0 for the full mesh itself)
+struct ObjLod {
+	float error;
+	unsigned int firstRange;
+	unsigned int numRanges;
+};
+typedef struct ObjLod ObjLod;
+
+// a level of adaptive subdivision of the finished mesh (see getSubdivision()): vertex arrays of
+// its own, a tangent per vertex like getIndexedTangents(), and a 32-bit triangle list in
+// mesh.indices, drawn with one draw range per material
+struct ObjSubdivision {
+	SubdivisionMesh mesh;
+	std::vector<Vector4> tangents;
+	std::vector<ObjDrawRange> drawRanges;
+};
+typedef struct ObjSubdivision ObjSubdivision;
+
+struct ObjChunk;
+struct ObjParts;
+struct ObjStream;
+struct GlbContents;
+struct HalfEdgeMesh;
+class AssetPack;
+
 class ObjMesh {
 private:
 	unsigned int numVertices;
 	unsigned int numTriangles;
 	unsigned int numIndexedVertices;
-	std::vector<unsigned int> triangleIndices;
-	std::vector<Vector3> indexedPositions;
-	std::vector<Vector2> indexedTextureCoords;
-	std::vector<Vector3> indexedNormals;
+	MeshBuffer<unsigned int> triangleIndices;
+	MeshBuffer<Vector3> indexedPositions;
+	MeshBuffer<Vector2> indexedTextureCoords;
+	MeshBuffer<Vector3> indexedNormals;
+	MeshBuffer<Vector4> indexedTangents;
+	std::vector<unsigned char> interleavedVertices;
+	std::vector<ObjMaterial> materials;
+	std::vector<ObjSubmesh> submeshes;
+	std::vector<ObjDrawRange> drawRanges;
+	std::vector<unsigned short> shortDrawIndices;
+	std::vector<unsigned int> longDrawIndices;
+	std::vector<ObjLod> drawLods;
+	MeshBuffer<unsigned int> lodIndices;
+	std::vector<ObjDrawRange> lodRanges;
+	std::vector<ObjLod> lods;
+	std::vector<Meshlet> meshlets;
+	float subdivisionCurvature;
+	bool closedKnown;
+	bool closed;
+	std::vector<std::unique_ptr<ObjSubdivision> > subdivisions;
+	std::vector<float> subdivisionEdgeLengths;
+	unsigned int numDrawIndices;
+	unsigned int drawIndexSize;
+	ObjPrimitive drawPrimitive;
 	Vector3 centre;
 	Vector3 dimensions;
+	unsigned int numThreads;
+	bool useCache;
+	bool weldVertices;
+	bool optimizeVertexCache;
+	bool optimizeOverdraw;
+	bool optimizeVertexFetch;
+	float creaseAngle;
+	bool interleaveVertices;
+	bool generateStrips;
+	bool generateLods;
+	bool generateMeshlets;
+	MeshCache cache;
+	AssetPack* assetPack;
+	std::unique_ptr<ObjStream> stream;
+	// the GLB file that arrays of a GLB mesh may still point into, as they would into the cache
+	std::unique_ptr<MappedFile> sourceFile;
+
+	// empties the mesh and lets go of the files its arrays may point into
+	void clear();
+	bool openSource(const std::string filename, const bool copyOnWrite, MappedFile &fileIn, const char* &data,
+	                size_t &size, long long &modifiedTime);
+	MeshCacheKey makeCacheKey(const char* data, const size_t size, const long long modifiedTime, const bool autoCentre,
+	                          const bool autoNormalize);
+	void parse(const char* fileData, const size_t fileSize, ObjParts &parts, const bool autoCentre,
+	           const bool autoNormalize);
+	void placeVertices(Vector3* vertexPositions, const size_t numPositions, const bool autoCentre,
+	                   const bool autoNormalize);
+	void expand(ObjChunk &records, const ObjParts &parts, const bool autoCentre, const bool autoNormalize);
+	void buildSubmeshes(const ObjParts &parts, std::vector<unsigned int> &indices);
+	bool parseGlb(const GlbContents &contents, const bool autoCentre, const bool autoNormalize, const bool sharedSource,
+	              std::vector<std::string> &materialNames);
+	void loadGlbMaterials(const std::string filename);
+	void loadMaterials(const std::string filename, const std::vector<std::string> &materialNames,
+	                   const std::vector<std::string> &materialLibraries);
+	void postProcess();
+	void weld();
+	void optimizeCache();
+	void optimizeFetch();
+	void computeTangents();
+	void generateLevelsOfDetail();
+	void partitionMeshlets();
+	void subdivide();
+	void interleave();
+	void compactIndices();
+	bool loadCache(const std::string filename, const std::string cacheFilename, const MeshCacheKey &key);
+	void saveCache(const std::string cacheFilename, const MeshCacheKey &key, const std::vector<std::string> &materialLibraries);
+
+	ObjMesh(const ObjMesh&) = delete;
+	ObjMesh& operator=(const ObjMesh&) = delete;
 
 public:
 	ObjMesh();
-	
-	void load(const std::string filename, const bool autoCentre, const bool autoNormalize);
+	~ObjMesh();
+
+	// the number of threads load() parses with; 0 (the default) uses every hardware thread
+	void setNumThreads(unsigned int numThreads);
+
+	// keep a binary sidecar (<filename>.cache) of the loaded mesh, and map it instead of parsing
+	// when it is still up to date; the arrays then point straight into the mapped cache
+	void setUseCache(bool useCache);
+
+	// read the mesh, its cache and its material libraries out of a pack when it has them, and
+	// from loose files otherwise; the pack must stay open while the mesh may point into it
+	void setAssetPack(AssetPack* assetPack);
+
+	// merge corners with identical position, texture coordinate and normal into shared vertices,
+	// so the index buffer really indexes; off by default, which keeps one vertex per corner
+	void setWeldVertices(bool weldVertices);
+
+	// reorder triangleIndices for the GPU's post-transform vertex cache; only pays off when welded
+	void setOptimizeVertexCache(bool optimizeVertexCache);
+
+	// after the vertex cache pass, reorder triangle clusters so outward-facing surfaces draw first
+	// and hide what is behind them before it is shaded; implies setOptimizeVertexCache(true). It
+	// costs some of the vertex cache order, so it pays mostly on closed meshes, whose back faces
+	// are culled (see isClosed()); it is logged with the ACMR it leaves
+	void setOptimizeOverdraw(bool optimizeOverdraw);
+
+	// renumber the vertex arrays in order of first use by triangleIndices, after any index
+	// reordering, so fetches walk memory forwards
+	void setOptimizeVertexFetch(bool optimizeVertexFetch);
+
+	// face corners without a vn normal get a smooth one, averaged over the faces around their
+	// position that meet their own at no more than creaseAngle degrees (60 by default); 0 keeps
+	// them flat. Streamed batches show flat normals until endStream().
+	void setCreaseAngle(float creaseAngle);
+
+	// also keep the finished vertices interleaved in one array, in getVertexLayout(), so a vertex
+	// fetch reads one stride of memory instead of one element of each attribute array; the
+	// separate arrays stay available. Off by default, as it doubles the vertex memory. On a finished
+	// mesh the copy is built or freed straight away.
+	void setInterleaveVertices(bool interleaveVertices);
+
+	// also turn the finished triangle list into triangle strips joined by primitive restart, for
+	// getDrawIndices(); kept as a list if the strips come out no shorter. Off by default, as
+	// primitive restart needs OpenGL 3.1.
+	void setGenerateStrips(bool generateStrips);
+
+	// also build up to five coarser levels of detail by edge collapse, each with about half the
+	// triangles of the one before, drawn from the same vertices through their own draw ranges
+	// (see getLods()). Off by default, as it costs about as long as the rest of the processing.
+	void setGenerateLods(bool generateLods);
+
+	// also split the full mesh into meshlets of up to 64 vertices and 124 triangles, each within
+	// one material, with the bounds to cull them by (see Meshlet); level 0 of getLods() then has
+	// a draw range per meshlet. Off by default.
+	void setGenerateMeshlets(bool generateMeshlets);
+
+	// loads an OBJ file, or a glTF binary when the name ends in .glb: its triangle primitives
+	// become one submesh each, drawn with the base colour of their material. A lone primitive's
+	// tightly packed float attributes and 32-bit indices are used straight from the mapped file,
+	// so unless processing changes them they go to the GPU without ever being copied. Returns
+	// whether it succeeded: a file that cannot be opened leaves the mesh as it was, and one that
+	// cannot be read leaves it empty.
+	bool load(const std::string filename, const bool autoCentre, const bool autoNormalize);
+
+	// a load that hands out triangles as they are parsed, so they can be drawn before the whole
+	// file is in: each streamBatch() appends up to maxTriangles expanded triangles to the indexed
+	// arrays and reports the new range, returning false once the file is exhausted. endStream()
+	// then rebuilds the arrays exactly as load() would (welding, reordering, caching), after which
+	// they must be uploaded again. A cached mesh, or a GLB, arrives whole, as the first batch.
+	bool beginStream(const std::string filename, const bool autoCentre, const bool autoNormalize);
+	bool streamBatch(const unsigned int maxTriangles, ObjMeshBatch &batch);
+	void endStream();
 
 	Vector3* getIndexedPositions();
 	Vector2* getIndexedTextureCoords();
 	Vector3* getIndexedNormals();
 
+	// a tangent per vertex for normal mapping (MikkTSpace conventions): xyz is the unit tangent,
+	// and the bitangent is cross(normal, tangent) * w
+	Vector4* getIndexedTangents();
+
+	// the vertices interleaved as getVertexLayout() describes, once load() or endStream() finished;
+	// null unless setInterleaveVertices(true)
+	unsigned char* getInterleavedVertices();
+	VertexLayout getVertexLayout();
+
+	// the number of vertices in the indexed arrays, and the number of indices that refer to them
 	unsigned int getNumVertices();
 	unsigned int getNumIndexedVertices();
 	unsigned int getNumTriangles();
 
 	unsigned int* getTriangleIndices();
 
+	// the indices to draw the finished mesh with, once load() or endStream() finished: 16 bits
+	// wide (getDrawIndexSize() 2) when every vertex fits, else 32, as a list or strips; draw each
+	// range with its material. The restart index is the largest value of the width, which no
+	// vertex uses.
+	void* getDrawIndices();
+	unsigned int getNumDrawIndices();
+	unsigned int getDrawIndexSize();
+	ObjPrimitive getDrawPrimitive();
+	unsigned int getRestartIndex();
+	unsigned int getNumDrawRanges();
+	ObjDrawRange* getDrawRanges();
+
+	// the levels of detail, finest first: level 0 is the full mesh, and every level draws its own
+	// draw ranges. Only level 0 without setGenerateLods(true).
+	unsigned int getNumLods();
+	ObjLod* getLods();
+
+	// the meshlets of the full mesh, as ranges of getTriangleIndices(); meshlet i is drawn by draw
+	// range i. None without setGenerateMeshlets(true).
+	unsigned int getNumMeshlets();
+	Meshlet* getMeshlets();
+
+	// the connectivity of the finished mesh as half-edges over getTriangleIndices() (see
+	// HalfEdgeMesh), for the topology queries an index list cannot answer; built on the load's
+	// threads on every call, reporting what it costs per triangle. Any mesh works, as vertices are
+	// joined by position, but a welded one leaves fewer to join.
+	void buildHalfEdges(HalfEdgeMesh &halfEdges);
+
+	// whether every edge of the finished mesh joins exactly two triangles wound opposite ways, so
+	// the back faces are always hidden behind front ones and can be culled; worked out from the
+	// half-edges the first time it is asked, and kept until the next load
+	bool isClosed();
+
+	// adaptive Loop subdivision of the finished mesh, for close-ups: each level refines the
+	// triangles of the one before that bend more than the curvature angle (15 degrees by default)
+	// against a neighbour, and leaves flat regions as they are (see subdivideMesh()). A level is
+	// built, on the load's threads, the first time it or a finer one is asked for, and kept until
+	// the next load or a change of the angle.
+	void setSubdivisionCurvature(float degrees);
+	unsigned int getMaxSubdivisionLevel();
+	// level 1 up to getMaxSubdivisionLevel(); level 0 is the mesh itself. Null past a level too
+	// large to refine again
+	ObjSubdivision* getSubdivision(unsigned int level);
+	// the longest edge of the triangles at a level (0 being the mesh itself) that still bend
+	// more than the curvature angle, in mesh units, which is how large the facets the next level
+	// would smooth appear; 0 at the last level. Builds the level itself if need be, but never the
+	// next one, so level 0 costs only a measuring pass over the mesh.
+	float getSubdivisionEdgeLength(unsigned int level);
+
+	// the materials used by the faces (material 0 is the default for faces before any usemtl),
+	// and the ranges of triangleIndices to draw with each, sorted by material
+	unsigned int getNumMaterials();
+	ObjMaterial* getMaterials();
+	unsigned int getNumSubmeshes();
+	ObjSubmesh* getSubmeshes();
+
 	Vector3 getCentre();
 	Vector3 getDimensions();
 };
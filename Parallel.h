@@ -0,0 +1,43 @@
+#include <thread>
+#include <vector>
+#include <cstddef>
+
+#pragma once
+
+// resolves a user-facing thread count knob, where 0 means "one per hardware thread"
+static inline unsigned int resolveThreadCount(unsigned int numThreads) {
+	if (numThreads == 0) {
+		numThreads = std::thread::hardware_concurrency();
+	}
+	return numThreads > 0 ? numThreads : 1;
+}
+
+// splits [0, count) into one contiguous range per thread and calls fn(thread, begin, end) for each;
+// the calling thread takes the first range, and ranges are never smaller than minPerThread
+template <typename Fn>
+void parallelFor(unsigned int numThreads, size_t count, size_t minPerThread, Fn fn) {
+	if (minPerThread == 0) {
+		minPerThread = 1;
+	}
+	size_t maxThreads = (count + minPerThread - 1) / minPerThread;
+	if (numThreads > maxThreads) {
+		numThreads = (unsigned int)maxThreads;
+	}
+	if (numThreads <= 1) {
+		fn(0u, (size_t)0, count);
+		return;
+	}
+
+	std::vector<std::thread> workers;
+	workers.reserve(numThreads - 1);
+	for (unsigned int t = 1; t < numThreads; t++) {
+		size_t begin = count * t / numThreads;
+		size_t end = count * (t + 1) / numThreads;
+		workers.emplace_back([=]() { fn(t, begin, end); });
+	}
+	fn(0u, (size_t)0, count / numThreads);
+
+	for (unsigned int t = 0; t < workers.size(); t++) {
+		workers[t].join();
+	}
+}
@@ -0,0 +1,333 @@
+#include <limits>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#  define POSITION_KERNELS_X86
+#  include <immintrin.h>
+#  ifdef _MSC_VER
+#    include <intrin.h>
+#  endif
+#endif
+
+// MSVC always allows every intrinsic; GCC and Clang need the functions that use them marked
+#if defined(__GNUC__)
+#  define TARGET_SSE2 __attribute__((target("sse2")))
+#  define TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#  define TARGET_SSE2
+#  define TARGET_AVX2
+#endif
+
+#include "PositionBounds.h"
+
+// packed xyz positions repeat every 3 floats, so a group of 24 floats (4 SSE or 3 AVX registers'
+// worth of 8, rounded to whole vertices) always puts the same axis in the same lane: lane j holds
+// axis j % 3. The kernels accumulate per lane, and the lanes are folded into axes at the end.
+static const int numLanes = 24;
+
+// float lanes are flushed into the double sums this often, to keep the centroid accurate
+static const size_t sumBlockVertices = 4096;
+
+// per-lane running state shared by every kernel
+struct BoundsLanes {
+	float min[numLanes];
+	float max[numLanes];
+	double sum[numLanes];
+};
+typedef struct BoundsLanes BoundsLanes;
+
+// each kernel handles a prefix of the vertices (a whole number of its register groups) and
+// returns how many it did; the caller finishes the rest with scalar code
+typedef size_t (*BoundsKernel)(const float* positions, size_t numVertices, BoundsLanes &lanes);
+typedef size_t (*TransformKernel)(float* positions, size_t numVertices, const float* offsetLanes, const float* scaleLanes);
+
+static size_t boundsNone(const float*, size_t, BoundsLanes&) {
+	return 0;
+}
+
+static size_t transformNone(float*, size_t, const float*, const float*) {
+	return 0;
+}
+
+#ifdef POSITION_KERNELS_X86
+// 4 vertices, in 3 registers, per step
+TARGET_SSE2 static size_t boundsSSE2(const float* positions, size_t numVertices, BoundsLanes &lanes) {
+	size_t numSteps = numVertices / 4;
+	__m128 min[3], max[3];
+	for (int r = 0; r < 3; r++) {
+		min[r] = _mm_loadu_ps(lanes.min + r * 4);
+		max[r] = _mm_loadu_ps(lanes.max + r * 4);
+	}
+
+	size_t step = 0;
+	while (step < numSteps) {
+		size_t blockEnd = step + sumBlockVertices / 4;
+		if (blockEnd > numSteps) {
+			blockEnd = numSteps;
+		}
+
+		__m128 sum[3] = { _mm_setzero_ps(), _mm_setzero_ps(), _mm_setzero_ps() };
+		for (; step < blockEnd; step++) {
+			const float* p = positions + step * 12;
+			for (int r = 0; r < 3; r++) {
+				__m128 v = _mm_loadu_ps(p + r * 4);
+				// the new value goes first, so a NaN is skipped the way the scalar compare skips it
+				min[r] = _mm_min_ps(v, min[r]);
+				max[r] = _mm_max_ps(v, max[r]);
+				sum[r] = _mm_add_ps(sum[r], v);
+			}
+		}
+
+		float blockSum[12];
+		for (int r = 0; r < 3; r++) {
+			_mm_storeu_ps(blockSum + r * 4, sum[r]);
+		}
+		for (int j = 0; j < 12; j++) {
+			lanes.sum[j] += blockSum[j];
+		}
+	}
+
+	for (int r = 0; r < 3; r++) {
+		_mm_storeu_ps(lanes.min + r * 4, min[r]);
+		_mm_storeu_ps(lanes.max + r * 4, max[r]);
+	}
+	return numSteps * 4;
+}
+
+TARGET_SSE2 static size_t transformSSE2(float* positions, size_t numVertices, const float* offsetLanes, const float* scaleLanes) {
+	size_t numSteps = numVertices / 4;
+	__m128 offset[3], scale[3];
+	for (int r = 0; r < 3; r++) {
+		offset[r] = _mm_loadu_ps(offsetLanes + r * 4);
+		scale[r] = _mm_loadu_ps(scaleLanes + r * 4);
+	}
+
+	for (size_t step = 0; step < numSteps; step++) {
+		float* p = positions + step * 12;
+		for (int r = 0; r < 3; r++) {
+			// a true division, so the result matches the scalar code bit for bit
+			__m128 v = _mm_loadu_ps(p + r * 4);
+			_mm_storeu_ps(p + r * 4, _mm_div_ps(_mm_sub_ps(v, offset[r]), scale[r]));
+		}
+	}
+	return numSteps * 4;
+}
+
+// 8 vertices, in 3 registers, per step
+TARGET_AVX2 static size_t boundsAVX2(const float* positions, size_t numVertices, BoundsLanes &lanes) {
+	size_t numSteps = numVertices / 8;
+	__m256 min[3], max[3];
+	for (int r = 0; r < 3; r++) {
+		min[r] = _mm256_loadu_ps(lanes.min + r * 8);
+		max[r] = _mm256_loadu_ps(lanes.max + r * 8);
+	}
+
+	size_t step = 0;
+	while (step < numSteps) {
+		size_t blockEnd = step + sumBlockVertices / 8;
+		if (blockEnd > numSteps) {
+			blockEnd = numSteps;
+		}
+
+		__m256 sum[3] = { _mm256_setzero_ps(), _mm256_setzero_ps(), _mm256_setzero_ps() };
+		for (; step < blockEnd; step++) {
+			const float* p = positions + step * 24;
+			for (int r = 0; r < 3; r++) {
+				__m256 v = _mm256_loadu_ps(p + r * 8);
+				min[r] = _mm256_min_ps(v, min[r]);
+				max[r] = _mm256_max_ps(v, max[r]);
+				sum[r] = _mm256_add_ps(sum[r], v);
+			}
+		}
+
+		float blockSum[24];
+		for (int r = 0; r < 3; r++) {
+			_mm256_storeu_ps(blockSum + r * 8, sum[r]);
+		}
+		for (int j = 0; j < 24; j++) {
+			lanes.sum[j] += blockSum[j];
+		}
+	}
+
+	for (int r = 0; r < 3; r++) {
+		_mm256_storeu_ps(lanes.min + r * 8, min[r]);
+		_mm256_storeu_ps(lanes.max + r * 8, max[r]);
+	}
+	_mm256_zeroupper();
+	return numSteps * 8;
+}
+
+TARGET_AVX2 static size_t transformAVX2(float* positions, size_t numVertices, const float* offsetLanes, const float* scaleLanes) {
+	size_t numSteps = numVertices / 8;
+	__m256 offset[3], scale[3];
+	for (int r = 0; r < 3; r++) {
+		offset[r] = _mm256_loadu_ps(offsetLanes + r * 8);
+		scale[r] = _mm256_loadu_ps(scaleLanes + r * 8);
+	}
+
+	for (size_t step = 0; step < numSteps; step++) {
+		float* p = positions + step * 24;
+		for (int r = 0; r < 3; r++) {
+			__m256 v = _mm256_loadu_ps(p + r * 8);
+			_mm256_storeu_ps(p + r * 8, _mm256_div_ps(_mm256_sub_ps(v, offset[r]), scale[r]));
+		}
+	}
+	_mm256_zeroupper();
+	return numSteps * 8;
+}
+
+static bool cpuHasSSE2() {
+#if defined(_M_X64) || defined(__x86_64__)
+	return true;
+#elif defined(_MSC_VER)
+	int info[4];
+	__cpuid(info, 1);
+	return (info[3] & (1 << 26)) != 0;
+#else
+	return __builtin_cpu_supports("sse2");
+#endif
+}
+
+static bool cpuHasAVX2() {
+#if defined(_MSC_VER)
+	int info[4];
+	__cpuid(info, 0);
+	if (info[0] < 7) {
+		return false;
+	}
+	// the OS must also save the upper halves of the AVX registers
+	__cpuid(info, 1);
+	if ((info[2] & (1 << 27)) == 0 || (_xgetbv(0) & 6) != 6) {
+		return false;
+	}
+	__cpuidex(info, 7, 0);
+	return (info[1] & (1 << 5)) != 0;
+#else
+	return __builtin_cpu_supports("avx2");
+#endif
+}
+#endif
+
+// the kernels for this CPU, picked once on first use
+struct PositionKernels {
+	BoundsKernel bounds;
+	TransformKernel transform;
+	const char* name;
+};
+typedef struct PositionKernels PositionKernels;
+
+static PositionKernels selectKernels() {
+	PositionKernels kernels = { boundsNone, transformNone, "scalar" };
+#ifdef POSITION_KERNELS_X86
+	if (cpuHasAVX2()) {
+		kernels.bounds = boundsAVX2;
+		kernels.transform = transformAVX2;
+		kernels.name = "AVX2";
+	} else if (cpuHasSSE2()) {
+		kernels.bounds = boundsSSE2;
+		kernels.transform = transformSSE2;
+		kernels.name = "SSE2";
+	}
+#endif
+	return kernels;
+}
+
+static PositionKernels& getKernels() {
+	static PositionKernels kernels = selectKernels();
+	return kernels;
+}
+
+void computePositionBounds(const float* positions, size_t numVertices, PositionBounds &bounds) {
+	BoundsLanes lanes;
+	for (int j = 0; j < numLanes; j++) {
+		lanes.min[j] = std::numeric_limits<float>::max();
+		lanes.max[j] = std::numeric_limits<float>::lowest();
+		lanes.sum[j] = 0.0;
+	}
+
+	// the kernel takes whole register groups, and the scalar loop the rest; lanes 0-2 are x, y, z
+	size_t done = getKernels().bounds(positions, numVertices, lanes);
+	for (size_t i = done; i < numVertices; i++) {
+		for (int axis = 0; axis < 3; axis++) {
+			float v = positions[i * 3 + axis];
+			if (v < lanes.min[axis]) {
+				lanes.min[axis] = v;
+			}
+			if (v > lanes.max[axis]) {
+				lanes.max[axis] = v;
+			}
+			lanes.sum[axis] += v;
+		}
+	}
+
+	double sum[3] = { 0.0, 0.0, 0.0 };
+	for (int axis = 0; axis < 3; axis++) {
+		bounds.min[axis] = lanes.min[axis];
+		bounds.max[axis] = lanes.max[axis];
+	}
+	for (int j = 0; j < numLanes; j++) {
+		int axis = j % 3;
+		if (lanes.min[j] < bounds.min[axis]) {
+			bounds.min[axis] = lanes.min[j];
+		}
+		if (lanes.max[j] > bounds.max[axis]) {
+			bounds.max[axis] = lanes.max[j];
+		}
+		sum[axis] += lanes.sum[j];
+	}
+
+	for (int axis = 0; axis < 3; axis++) {
+		if (numVertices == 0) {
+			bounds.min[axis] = 0.0f;
+			bounds.max[axis] = 0.0f;
+			bounds.centroid[axis] = 0.0f;
+		} else {
+			bounds.centroid[axis] = (float)(sum[axis] / (double)numVertices);
+		}
+	}
+}
+
+void transformPositions(float* positions, size_t numVertices, const float offset[3], float scale) {
+	float offsetLanes[numLanes];
+	float scaleLanes[numLanes];
+	for (int j = 0; j < numLanes; j++) {
+		offsetLanes[j] = offset[j % 3];
+		scaleLanes[j] = scale;
+	}
+
+	size_t done = getKernels().transform(positions, numVertices, offsetLanes, scaleLanes);
+	for (size_t i = done; i < numVertices; i++) {
+		for (int axis = 0; axis < 3; axis++) {
+			positions[i * 3 + axis] = (positions[i * 3 + axis] - offset[axis]) / scale;
+		}
+	}
+}
+
+const char* getPositionKernelName() {
+	return getKernels().name;
+}
+
+bool usePositionKernel(const char* name) {
+	PositionKernels kernels = { boundsNone, transformNone, "scalar" };
+	if (strcmp(name, "scalar") == 0) {
+		getKernels() = kernels;
+		return true;
+	}
+#ifdef POSITION_KERNELS_X86
+	if (strcmp(name, "AVX2") == 0 && cpuHasAVX2()) {
+		kernels.bounds = boundsAVX2;
+		kernels.transform = transformAVX2;
+		kernels.name = "AVX2";
+		getKernels() = kernels;
+		return true;
+	}
+	if (strcmp(name, "SSE2") == 0 && cpuHasSSE2()) {
+		kernels.bounds = boundsSSE2;
+		kernels.transform = transformSSE2;
+		kernels.name = "SSE2";
+		getKernels() = kernels;
+		return true;
+	}
+#endif
+	return false;
+}
@@ -0,0 +1,27 @@
+#include <cstddef>
+
+#pragma once
+
+// the axis-aligned box and centroid of a set of positions
+struct PositionBounds {
+	float min[3];
+	float max[3];
+	float centroid[3];
+};
+typedef struct PositionBounds PositionBounds;
+
+// computes the bounds of numVertices packed xyz positions in one pass; an empty set has a zero box
+// and centroid. Uses AVX2 or SSE2 when the CPU has them, so the centroid may differ from a serial
+// float sum in the last bits (it is summed in blocks, and the blocks in double)
+void computePositionBounds(const float* positions, size_t numVertices, PositionBounds &bounds);
+
+// replaces every packed xyz position p with (p - offset) / scale, also vectorised
+void transformPositions(float* positions, size_t numVertices, const float offset[3], float scale);
+
+// the instruction set the two functions above run with on this CPU, e.g. "AVX2"
+const char* getPositionKernelName();
+
+// makes the two functions above run with the named instruction set ("scalar", "SSE2" or "AVX2")
+// in place of the best one, for comparing them; false, changing nothing, if this CPU lacks it.
+// Not to be called while either function runs on another thread.
+bool usePositionKernel(const char* name);
@@ -1,14 +1,24 @@
 #include "ShaderProgram.h"
+#include "AssetPack.h"
 
 ShaderProgram::ShaderProgram() {
 	this->vertexShaderId = -1;
+	this->tessControlShaderId = -1;
+	this->tessEvaluationShaderId = -1;
 	this->fragmentShaderId = -1;
 	this->programId = -1;
+	this->assetPack = nullptr;
+}
+
+void ShaderProgram::setAssetPack(AssetPack* assetPack) {
+	this->assetPack = assetPack;
 }
 
 std::string ShaderProgram::getVertexShaderCode() { return this->vertexShaderCode; }
 std::string ShaderProgram::getFragmentShaderCode() { return this->fragmentShaderCode; }
 GLuint ShaderProgram::getVertexShaderId() { return this->vertexShaderId; }
+GLuint ShaderProgram::getTessControlShaderId() { return this->tessControlShaderId; }
+GLuint ShaderProgram::getTessEvaluationShaderId() { return this->tessEvaluationShaderId; }
 GLuint ShaderProgram::getFragmentShaderId() { return this->fragmentShaderId; }
 GLuint ShaderProgram::getProgramId() { return this->programId; }
 
@@ -17,36 +27,73 @@ GLuint ShaderProgram::loadShaders(const std::string vertexShaderFilename, const
 	this->vertexShaderId = this->loadShader(GL_VERTEX_SHADER, vertexShaderFilename);
 	this->fragmentShaderId = this->loadShader(GL_FRAGMENT_SHADER, fragmentShaderFilename);
 
+	GLuint shaderIds[] = { this->vertexShaderId, this->fragmentShaderId };
+	return this->linkShaders(shaderIds, 2);
+}
+
+GLuint ShaderProgram::loadShaders(const std::string vertexShaderFilename, const std::string tessControlShaderFilename,
+	const std::string tessEvaluationShaderFilename, const std::string fragmentShaderFilename) {
+	// create and compile a shader for each stage
+	this->vertexShaderId = this->loadShader(GL_VERTEX_SHADER, vertexShaderFilename);
+	this->tessControlShaderId = this->loadShader(GL_TESS_CONTROL_SHADER, tessControlShaderFilename);
+	this->tessEvaluationShaderId = this->loadShader(GL_TESS_EVALUATION_SHADER, tessEvaluationShaderFilename);
+	this->fragmentShaderId = this->loadShader(GL_FRAGMENT_SHADER, fragmentShaderFilename);
+
+	GLuint shaderIds[] = { this->vertexShaderId, this->tessControlShaderId, this->tessEvaluationShaderId, this->fragmentShaderId };
+	return this->linkShaders(shaderIds, 4);
+}
+
+GLuint ShaderProgram::linkShaders(const GLuint* shaderIds, const int numShaders) {
 	// create and link the shaders into a program
 	this->programId = glCreateProgram();
-	glAttachShader(this->programId, this->vertexShaderId);
-	glAttachShader(this->programId, this->fragmentShaderId);
+	for (int i = 0; i < numShaders; i++) {
+		glAttachShader(this->programId, shaderIds[i]);
+	}
 	glLinkProgram(this->programId);
 	glValidateProgram(this->programId);
 
 	// delete the shaders
-	glDetachShader(this->programId, this->vertexShaderId);
-	glDetachShader(this->programId, this->fragmentShaderId);
-	glDeleteShader(this->vertexShaderId);
-	glDeleteShader(this->fragmentShaderId);
+	for (int i = 0; i < numShaders; i++) {
+		glDetachShader(this->programId, shaderIds[i]);
+		glDeleteShader(shaderIds[i]);
+	}
+
+	// check if there were any link errors, e.g. a shader that did not compile
+	int result;
+	glGetProgramiv(this->programId, GL_LINK_STATUS, &result);
+	if (result == GL_FALSE) {
+		int errorLength;
+		glGetProgramiv(this->programId, GL_INFO_LOG_LENGTH, &errorLength);
+		std::string errorMessage(errorLength > 0 ? errorLength : 1, '\0');
+		glGetProgramInfoLog(this->programId, (GLsizei)errorMessage.size(), nullptr, &errorMessage[0]);
+		std::cout << "Shader linking failed: " << errorMessage.c_str() << std::endl;
+
+		glDeleteProgram(this->programId);
+		this->programId = 0;
+	}
 
 	return this->programId;
 }
 
 GLuint ShaderProgram::loadShader(const GLenum shaderType, const std::string shaderFilename) {
-	// load the contents of the specified text file
-	std::ifstream fileIn(shaderFilename);
-
-	if (!fileIn.is_open()) {
-		return -1;
-	}
-
-	// load the shader code into a string
+	// load the shader code into a string, from the pack if it has the file
 	std::string shaderSource;
-	std::string line;
-	while (getline(fileIn, line)) {
-		shaderSource.append(line);
-		shaderSource.append("\n");
+	const AssetEntry* asset = this->assetPack != nullptr ? this->assetPack->find(shaderFilename) : nullptr;
+	if (asset != nullptr && asset->format == ASSET_RAW) {
+		shaderSource.assign(asset->data, asset->size);
+	} else {
+		// load the contents of the specified text file
+		std::ifstream fileIn(shaderFilename);
+
+		if (!fileIn.is_open()) {
+			return -1;
+		}
+
+		std::string line;
+		while (getline(fileIn, line)) {
+			shaderSource.append(line);
+			shaderSource.append("\n");
+		}
 	}
 
 	const char* sourceCode = shaderSource.c_str();
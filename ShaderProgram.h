@@ -5,22 +5,38 @@
 #include <GL/glew.h>
 
 #pragma once
+
+class AssetPack;
+
 class ShaderProgram {
 private:
 	std::string vertexShaderCode;
 	std::string fragmentShaderCode;
 	GLuint vertexShaderId;
+	GLuint tessControlShaderId;
+	GLuint tessEvaluationShaderId;
 	GLuint fragmentShaderId;
 	GLuint programId;
+	AssetPack* assetPack;
 
 	GLuint loadShader(const GLenum shaderType, const std::string shaderFilename);
+	GLuint linkShaders(const GLuint* shaderIds, const int numShaders);
 
 public:
 	ShaderProgram();
+	// read shaders out of a pack when it has them, and from loose files otherwise
+	void setAssetPack(AssetPack* assetPack);
 	GLuint loadShaders(const std::string vertexShaderFilename, const std::string fragmentShaderFilename);
+	// a program with tessellation control and evaluation shaders between the vertex and fragment
+	// ones, drawn with GL_PATCHES; needs OpenGL 4.0 (or ARB_tessellation_shader). Either returns
+	// 0 if the program does not link.
+	GLuint loadShaders(const std::string vertexShaderFilename, const std::string tessControlShaderFilename,
+		const std::string tessEvaluationShaderFilename, const std::string fragmentShaderFilename);
 	std::string getVertexShaderCode();
 	std::string getFragmentShaderCode();
 	GLuint getVertexShaderId();
+	GLuint getTessControlShaderId();
+	GLuint getTessEvaluationShaderId();
 	GLuint getFragmentShaderId();
 	GLuint getProgramId();
 };
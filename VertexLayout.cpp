@@ -0,0 +1,70 @@
+#include <cstring>
+
+#include "VertexLayout.h"
+
+void initVertexLayout(VertexLayout &layout) {
+	layout.stride = 0;
+	for (int a = 0; a < VERTEX_NUM_ATTRIBUTES; a++) {
+		layout.attributes[a].components = 0;
+		layout.attributes[a].type = VERTEX_FLOAT;
+		layout.attributes[a].size = 0;
+		layout.attributes[a].offset = 0;
+	}
+}
+
+void addVertexAttribute(VertexLayout &layout, const VertexAttribute attribute, const unsigned int components,
+	const VertexComponentType type, const unsigned int size) {
+	VertexAttributeFormat &format = layout.attributes[attribute];
+	format.components = components;
+	format.type = type;
+	format.size = size;
+	format.offset = layout.stride;
+	layout.stride += size;
+}
+
+VertexLayout floatVertexLayout() {
+	VertexLayout layout;
+	initVertexLayout(layout);
+	addVertexAttribute(layout, VERTEX_POSITION, 3, VERTEX_FLOAT, 3 * sizeof(float));
+	addVertexAttribute(layout, VERTEX_TEXTURE_COORDS, 2, VERTEX_FLOAT, 2 * sizeof(float));
+	addVertexAttribute(layout, VERTEX_NORMAL, 3, VERTEX_FLOAT, 3 * sizeof(float));
+	addVertexAttribute(layout, VERTEX_TANGENT, 4, VERTEX_FLOAT, 4 * sizeof(float));
+	return layout;
+}
+
+// copies one attribute of every vertex into its slot of the interleaved vertices; a constant size
+// lets the compiler turn each copy into a few moves
+template <size_t Size>
+static void scatterAttribute(const unsigned char* source, const size_t numVertices, unsigned char* destination,
+	const size_t stride) {
+	for (size_t v = 0; v < numVertices; v++) {
+		memcpy(destination + v * stride, source + v * Size, Size);
+	}
+}
+
+static void scatterAttribute(const unsigned char* source, const size_t size, const size_t numVertices,
+	unsigned char* destination, const size_t stride) {
+	switch (size) {
+	case 4: scatterAttribute<4>(source, numVertices, destination, stride); break;
+	case 8: scatterAttribute<8>(source, numVertices, destination, stride); break;
+	case 12: scatterAttribute<12>(source, numVertices, destination, stride); break;
+	case 16: scatterAttribute<16>(source, numVertices, destination, stride); break;
+	default:
+		for (size_t v = 0; v < numVertices; v++) {
+			memcpy(destination + v * stride, source + v * size, size);
+		}
+	}
+}
+
+void interleaveVertices(const VertexLayout &layout, const void* const* attributes, const size_t numVertices,
+	void* interleaved) {
+	// one attribute at a time, so each pass reads one array forwards and writes with a fixed stride
+	for (int a = 0; a < VERTEX_NUM_ATTRIBUTES; a++) {
+		const VertexAttributeFormat &format = layout.attributes[a];
+		if (format.size == 0) {
+			continue;
+		}
+		scatterAttribute((const unsigned char*)attributes[a], format.size, numVertices,
+			(unsigned char*)interleaved + format.offset, layout.stride);
+	}
+}
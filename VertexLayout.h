@@ -0,0 +1,56 @@
+#include <cstddef>
+
+#pragma once
+
+// the attributes a vertex carries, in the order an interleaved vertex stores them
+enum VertexAttribute {
+	VERTEX_POSITION = 0,
+	VERTEX_TEXTURE_COORDS = 1,
+	VERTEX_NORMAL = 2,
+	VERTEX_TANGENT = 3,
+	VERTEX_NUM_ATTRIBUTES = 4
+};
+
+// how an attribute's components are stored
+enum VertexComponentType {
+	VERTEX_FLOAT,
+	VERTEX_HALF_FLOAT,
+	VERTEX_UNSIGNED_SHORT,
+	VERTEX_SHORT
+};
+
+// one attribute of a vertex: the number of components the shader reads, their type, and the bytes
+// the attribute takes in the buffer, which may include padding after the components; offset is
+// where it starts within an interleaved vertex. An attribute the layout lacks has size 0.
+struct VertexAttributeFormat {
+	unsigned int components;
+	VertexComponentType type;
+	unsigned int size;
+	unsigned int offset;
+};
+typedef struct VertexAttributeFormat VertexAttributeFormat;
+
+// the format of every attribute, and the stride of one interleaved vertex; the same formats
+// describe separate attribute arrays too, each with a stride of its attribute's size
+struct VertexLayout {
+	unsigned int stride;
+	VertexAttributeFormat attributes[VERTEX_NUM_ATTRIBUTES];
+};
+typedef struct VertexLayout VertexLayout;
+
+// an empty layout, for addVertexAttribute() to fill
+void initVertexLayout(VertexLayout &layout);
+
+// appends an attribute to the end of the interleaved vertex; size must be a multiple of 4, so
+// every attribute stays 4-byte aligned
+void addVertexAttribute(VertexLayout &layout, const VertexAttribute attribute, const unsigned int components,
+	const VertexComponentType type, const unsigned int size);
+
+// the layout of ObjMesh's float attributes: xyz position, uv, xyz normal and xyzw tangent
+VertexLayout floatVertexLayout();
+
+// interleaves numVertices vertices from one tightly packed array per attribute (indexed by
+// VertexAttribute, each element the attribute's size; arrays for attributes the layout lacks are
+// not read) into interleaved, which must hold numVertices * layout.stride bytes
+void interleaveVertices(const VertexLayout &layout, const void* const* attributes, const size_t numVertices,
+	void* interleaved);
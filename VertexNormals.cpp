@@ -0,0 +1,344 @@
+#include <vector>
+#include <cmath>
+#include <cstring>
+
+#include "VertexNormals.h"
+#include "Parallel.h"
+#include "MemoryArena.h"
+
+// triangles and vertices (or positions) are handed to threads in runs of at least this many
+static const size_t minTrianglesPerThread = 1 << 14;
+static const size_t minVerticesPerThread = 1 << 14;
+
+// a triangle's unit normal, and its angle at each corner, side by side so the gather reads both
+// from one cache line
+struct TriangleShape {
+	float normal[3];
+	float angles[3];
+};
+typedef struct TriangleShape TriangleShape;
+
+// acos to within 7e-5 radians (Abramowitz and Stegun 4.4.45), plenty for a weight and several
+// times faster than the library's
+static inline float fastAcos(float x) {
+	float ax = fabsf(x);
+	float r = sqrtf(1.0f - ax) * (1.5707288f + ax * (-0.2121144f + ax * (0.0742610f - ax * 0.0187293f)));
+	return x < 0.0f ? 3.14159265f - r : r;
+}
+
+// the angle between two edges leaving a corner, given their lengths
+static inline float cornerAngle(const float* u, const float* v, float lengthU, float lengthV) {
+	float cosine = (u[0] * v[0] + u[1] * v[1] + u[2] * v[2]) / (lengthU * lengthV);
+	return fastAcos(cosine < -1.0f ? -1.0f : (cosine > 1.0f ? 1.0f : cosine));
+}
+
+// the shape of a triangle; a degenerate triangle has a zero normal and zero angles, so it adds
+// nothing to its neighbours
+static inline void triangleShape(const float* a, const float* b, const float* c, TriangleShape &shape) {
+	float ab[3] = { b[0] - a[0], b[1] - a[1], b[2] - a[2] };
+	float ac[3] = { c[0] - a[0], c[1] - a[1], c[2] - a[2] };
+	float bc[3] = { c[0] - b[0], c[1] - b[1], c[2] - b[2] };
+	float ba[3] = { -ab[0], -ab[1], -ab[2] };
+	float ca[3] = { -ac[0], -ac[1], -ac[2] };
+	float cb[3] = { -bc[0], -bc[1], -bc[2] };
+
+	float normal[3] = {
+		ab[1] * ac[2] - ab[2] * ac[1],
+		ab[2] * ac[0] - ab[0] * ac[2],
+		ab[0] * ac[1] - ab[1] * ac[0]
+	};
+	float length = sqrtf(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+	float lengthAB = sqrtf(ab[0] * ab[0] + ab[1] * ab[1] + ab[2] * ab[2]);
+	float lengthAC = sqrtf(ac[0] * ac[0] + ac[1] * ac[1] + ac[2] * ac[2]);
+	float lengthBC = sqrtf(bc[0] * bc[0] + bc[1] * bc[1] + bc[2] * bc[2]);
+	if (length == 0.0f || lengthAB == 0.0f || lengthAC == 0.0f || lengthBC == 0.0f) {
+		for (int axis = 0; axis < 3; axis++) {
+			shape.normal[axis] = 0.0f;
+			shape.angles[axis] = 0.0f;
+		}
+		return;
+	}
+
+	float inverseLength = 1.0f / length;
+	shape.normal[0] = normal[0] * inverseLength;
+	shape.normal[1] = normal[1] * inverseLength;
+	shape.normal[2] = normal[2] * inverseLength;
+	shape.angles[0] = cornerAngle(ab, ac, lengthAB, lengthAC);
+	shape.angles[1] = cornerAngle(bc, ba, lengthBC, lengthAB);
+	shape.angles[2] = cornerAngle(ca, cb, lengthAC, lengthBC);
+}
+
+// groups corners by id in one compressed array: the corners with id p are corners[first[p]] up
+// to corners[first[p + 1]], in order. Ids at or above numIds are left out. Returns how many
+// corners were grouped, and leaves first and corners unset if none were.
+static size_t groupCorners(const unsigned int* ids, const size_t numCorners, const size_t numIds, MemoryArena &arena,
+	unsigned int* &first, unsigned int* &corners) {
+	first = arena.allocate<unsigned int>(numIds + 1);
+	memset(first, 0, (numIds + 1) * sizeof(unsigned int));
+	size_t numGrouped = 0;
+	for (size_t i = 0; i < numCorners; i++) {
+		if (ids[i] < numIds) {
+			first[ids[i] + 1]++;
+			numGrouped++;
+		}
+	}
+	if (numGrouped == 0) {
+		return 0;
+	}
+	for (size_t p = 0; p < numIds; p++) {
+		first[p + 1] += first[p];
+	}
+
+	// filled back to front, so each id's count ends up at its start again
+	corners = arena.allocate<unsigned int>(numGrouped);
+	for (size_t i = numCorners; i-- > 0;) {
+		if (ids[i] < numIds) {
+			corners[--first[ids[i] + 1]] = (unsigned int)i;
+		}
+	}
+	for (size_t p = 0; p < numIds; p++) {
+		first[p] = first[p + 1];
+	}
+	first[numIds] = (unsigned int)numGrouped;
+	return numGrouped;
+}
+
+void generateVertexNormals(const float* positions, const unsigned int* positionIds, const size_t numCorners,
+	const size_t numPositionIds, const float creaseAngle, const unsigned int numThreads, float* normals) {
+	size_t numTriangles = numCorners / 3;
+	MemoryArena arena;
+
+	// the corners of each position
+	unsigned int* firstCorner;
+	unsigned int* positionCorners;
+	if (groupCorners(positionIds, numTriangles * 3, numPositionIds, arena, firstCorner, positionCorners) == 0) {
+		return;
+	}
+
+	// every triangle's normal and corner angles, computed once
+	TriangleShape* shapes = arena.allocate<TriangleShape>(numTriangles);
+	parallelFor(numThreads, numTriangles, minTrianglesPerThread, [&](unsigned int, size_t begin, size_t end) {
+		for (size_t t = begin; t < end; t++) {
+			triangleShape(positions + t * 9, positions + t * 9 + 3, positions + t * 9 + 6, shapes[t]);
+		}
+	});
+
+	// each corner sums the weighted normals of the triangles on its side of any crease; a thread
+	// owns whole positions, so it is the only one to read their lists and write their corners
+	float minCosine = cosf(creaseAngle * 3.14159265f / 180.0f);
+	// if every triangle is within half the crease angle of the average, no two are more than the
+	// crease angle apart, and every corner gets the average
+	float minAverageCosine = cosf(creaseAngle * 0.5f * 3.14159265f / 180.0f);
+	parallelFor(numThreads, numPositionIds, minVerticesPerThread, [&](unsigned int, size_t begin, size_t end) {
+		// the triangles around the current position, copied together once since they are compared
+		std::vector<float> around;
+
+		for (size_t p = begin; p < end; p++) {
+			const unsigned int* corners = positionCorners + firstCorner[p];
+			size_t numPositionCorners = firstCorner[p + 1] - firstCorner[p];
+
+			around.resize(numPositionCorners * 4);
+			float average[3] = { 0.0f, 0.0f, 0.0f };
+			for (size_t j = 0; j < numPositionCorners; j++) {
+				const TriangleShape &shape = shapes[corners[j] / 3];
+				float* other = &around[j * 4];
+				other[0] = shape.normal[0];
+				other[1] = shape.normal[1];
+				other[2] = shape.normal[2];
+				other[3] = shape.angles[corners[j] % 3];
+				average[0] += other[0] * other[3];
+				average[1] += other[1] * other[3];
+				average[2] += other[2] * other[3];
+			}
+
+			float averageLength = sqrtf(average[0] * average[0] + average[1] * average[1] + average[2] * average[2]);
+			bool smooth = averageLength > 0.0f;
+			for (size_t j = 0; j < numPositionCorners && smooth; j++) {
+				const float* other = &around[j * 4];
+				smooth = other[3] == 0.0f
+					|| other[0] * average[0] + other[1] * average[1] + other[2] * average[2] >= minAverageCosine * averageLength;
+			}
+			if (smooth) {
+				float inverseLength = 1.0f / averageLength;
+				for (size_t i = 0; i < numPositionCorners; i++) {
+					float* normal = normals + (size_t)corners[i] * 3;
+					normal[0] = average[0] * inverseLength;
+					normal[1] = average[1] * inverseLength;
+					normal[2] = average[2] * inverseLength;
+				}
+				continue;
+			}
+
+			// otherwise each corner keeps to the triangles that are close enough to its own
+			for (size_t i = 0; i < numPositionCorners; i++) {
+				const float* own = &around[i * 4];
+				float sum[3] = { 0.0f, 0.0f, 0.0f };
+
+				for (size_t j = 0; j < numPositionCorners; j++) {
+					const float* other = &around[j * 4];
+					if (j != i && own[0] * other[0] + own[1] * other[1] + own[2] * other[2] < minCosine) {
+						continue;
+					}
+					sum[0] += other[0] * other[3];
+					sum[1] += other[1] * other[3];
+					sum[2] += other[2] * other[3];
+				}
+
+				float length = sqrtf(sum[0] * sum[0] + sum[1] * sum[1] + sum[2] * sum[2]);
+				if (length > 0.0f) {
+					float inverseLength = 1.0f / length;
+					float* normal = normals + (size_t)corners[i] * 3;
+					normal[0] = sum[0] * inverseLength;
+					normal[1] = sum[1] * inverseLength;
+					normal[2] = sum[2] * inverseLength;
+				}
+			}
+		}
+	});
+}
+
+// a triangle's unit tangent and bitangent, the directions of increasing u and v across it, and
+// its angle at each corner
+struct TriangleTangents {
+	float tangent[3];
+	float bitangent[3];
+	float angles[3];
+};
+typedef struct TriangleTangents TriangleTangents;
+
+// the tangents of a triangle; one whose texture coordinates are degenerate gets zero weights, so it
+// adds nothing to its vertices
+static inline void triangleTangents(const float* positions, const float* textureCoords, const unsigned int* triangle,
+	TriangleTangents &result) {
+	const float* a = positions + (size_t)triangle[0] * 3;
+	const float* b = positions + (size_t)triangle[1] * 3;
+	const float* c = positions + (size_t)triangle[2] * 3;
+	const float* ta = textureCoords + (size_t)triangle[0] * 2;
+	const float* tb = textureCoords + (size_t)triangle[1] * 2;
+	const float* tc = textureCoords + (size_t)triangle[2] * 2;
+
+	float ab[3] = { b[0] - a[0], b[1] - a[1], b[2] - a[2] };
+	float ac[3] = { c[0] - a[0], c[1] - a[1], c[2] - a[2] };
+	float bc[3] = { c[0] - b[0], c[1] - b[1], c[2] - b[2] };
+	float ba[3] = { -ab[0], -ab[1], -ab[2] };
+	float ca[3] = { -ac[0], -ac[1], -ac[2] };
+	float cb[3] = { -bc[0], -bc[1], -bc[2] };
+	float du1 = tb[0] - ta[0], dv1 = tb[1] - ta[1];
+	float du2 = tc[0] - ta[0], dv2 = tc[1] - ta[1];
+
+	// solve ab = du1 T + dv1 B, ac = du2 T + dv2 B; only the directions matter, so the
+	// determinant is only needed for its sign, which keeps mirrored mappings the right way round
+	float determinant = du1 * dv2 - du2 * dv1;
+	float lengthAB = sqrtf(ab[0] * ab[0] + ab[1] * ab[1] + ab[2] * ab[2]);
+	float lengthAC = sqrtf(ac[0] * ac[0] + ac[1] * ac[1] + ac[2] * ac[2]);
+	float lengthBC = sqrtf(bc[0] * bc[0] + bc[1] * bc[1] + bc[2] * bc[2]);
+	float sign = determinant < 0.0f ? -1.0f : 1.0f;
+	float tangent[3], bitangent[3];
+	for (int axis = 0; axis < 3; axis++) {
+		tangent[axis] = (ab[axis] * dv2 - ac[axis] * dv1) * sign;
+		bitangent[axis] = (ac[axis] * du1 - ab[axis] * du2) * sign;
+	}
+	float lengthT = sqrtf(tangent[0] * tangent[0] + tangent[1] * tangent[1] + tangent[2] * tangent[2]);
+	float lengthB = sqrtf(bitangent[0] * bitangent[0] + bitangent[1] * bitangent[1] + bitangent[2] * bitangent[2]);
+	if (determinant == 0.0f || lengthT == 0.0f || lengthB == 0.0f
+		|| lengthAB == 0.0f || lengthAC == 0.0f || lengthBC == 0.0f) {
+		for (int axis = 0; axis < 3; axis++) {
+			result.tangent[axis] = 0.0f;
+			result.bitangent[axis] = 0.0f;
+			result.angles[axis] = 0.0f;
+		}
+		return;
+	}
+
+	for (int axis = 0; axis < 3; axis++) {
+		result.tangent[axis] = tangent[axis] / lengthT;
+		result.bitangent[axis] = bitangent[axis] / lengthB;
+	}
+	result.angles[0] = cornerAngle(ab, ac, lengthAB, lengthAC);
+	result.angles[1] = cornerAngle(bc, ba, lengthBC, lengthAB);
+	result.angles[2] = cornerAngle(ca, cb, lengthAC, lengthBC);
+}
+
+// adds v, with the part along the unit normal n removed and then normalised, times weight to sum
+static inline void addProjected(const float* v, const float* n, float weight, float* sum) {
+	float along = v[0] * n[0] + v[1] * n[1] + v[2] * n[2];
+	float projected[3] = { v[0] - n[0] * along, v[1] - n[1] * along, v[2] - n[2] * along };
+	float length = sqrtf(projected[0] * projected[0] + projected[1] * projected[1] + projected[2] * projected[2]);
+	if (length > 0.0f) {
+		weight /= length;
+		sum[0] += projected[0] * weight;
+		sum[1] += projected[1] * weight;
+		sum[2] += projected[2] * weight;
+	}
+}
+
+void generateVertexTangents(const float* positions, const float* textureCoords, const float* normals,
+	const size_t numVertices, const unsigned int* indices, const size_t numIndices, const unsigned int numThreads,
+	float* tangents) {
+	size_t numTriangles = numIndices / 3;
+	MemoryArena arena;
+
+	// the corners that use each vertex
+	unsigned int* firstCorner = nullptr;
+	unsigned int* vertexCorners = nullptr;
+	groupCorners(indices, numTriangles * 3, numVertices, arena, firstCorner, vertexCorners);
+
+	TriangleTangents* triangles = arena.allocate<TriangleTangents>(numTriangles);
+	parallelFor(numThreads, numTriangles, minTrianglesPerThread, [&](unsigned int, size_t begin, size_t end) {
+		for (size_t t = begin; t < end; t++) {
+			if (indices[t * 3] < numVertices && indices[t * 3 + 1] < numVertices && indices[t * 3 + 2] < numVertices) {
+				triangleTangents(positions, textureCoords, indices + t * 3, triangles[t]);
+			} else {
+				memset(&triangles[t], 0, sizeof(TriangleTangents));
+			}
+		}
+	});
+
+	// every vertex gathers its own corners' tangents, so threads own disjoint vertex ranges
+	parallelFor(numThreads, numVertices, minVerticesPerThread, [&](unsigned int, size_t begin, size_t end) {
+		for (size_t v = begin; v < end; v++) {
+			// file normals are not always quite unit length
+			const float* normal = normals + v * 3;
+			float normalLength = sqrtf(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+			float n[3] = { 0.0f, 0.0f, 0.0f };
+			if (normalLength > 0.0f) {
+				n[0] = normal[0] / normalLength;
+				n[1] = normal[1] / normalLength;
+				n[2] = normal[2] / normalLength;
+			}
+			float tangentSum[3] = { 0.0f, 0.0f, 0.0f };
+			float bitangentSum[3] = { 0.0f, 0.0f, 0.0f };
+			unsigned int cornersBegin = firstCorner != nullptr ? firstCorner[v] : 0;
+			unsigned int cornersEnd = firstCorner != nullptr ? firstCorner[v + 1] : 0;
+			for (unsigned int i = cornersBegin; i < cornersEnd; i++) {
+				const TriangleTangents &triangle = triangles[vertexCorners[i] / 3];
+				float weight = triangle.angles[vertexCorners[i] % 3];
+				addProjected(triangle.tangent, n, weight, tangentSum);
+				addProjected(triangle.bitangent, n, weight, bitangentSum);
+			}
+
+			// a vertex without a usable mapping gets any tangent in its plane
+			float length = sqrtf(tangentSum[0] * tangentSum[0] + tangentSum[1] * tangentSum[1] + tangentSum[2] * tangentSum[2]);
+			if (length == 0.0f) {
+				float axis[3] = { 0.0f, 0.0f, 0.0f };
+				axis[fabsf(n[0]) < 0.9f ? 0 : 1] = 1.0f;
+				addProjected(axis, n, 1.0f, tangentSum);
+				length = sqrtf(tangentSum[0] * tangentSum[0] + tangentSum[1] * tangentSum[1] + tangentSum[2] * tangentSum[2]);
+			}
+
+			float* tangent = tangents + v * 4;
+			for (int axis = 0; axis < 3; axis++) {
+				tangent[axis] = length > 0.0f ? tangentSum[axis] / length : (axis == 0 ? 1.0f : 0.0f);
+			}
+
+			// w says which way the bitangent, cross(normal, tangent) * w, points
+			float cross[3] = {
+				n[1] * tangent[2] - n[2] * tangent[1],
+				n[2] * tangent[0] - n[0] * tangent[2],
+				n[0] * tangent[1] - n[1] * tangent[0]
+			};
+			float handedness = cross[0] * bitangentSum[0] + cross[1] * bitangentSum[1] + cross[2] * bitangentSum[2];
+			tangent[3] = handedness < 0.0f ? -1.0f : 1.0f;
+		}
+	});
+}
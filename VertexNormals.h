@@ -0,0 +1,25 @@
+#include <cstddef>
+
+#pragma once
+
+// replaces the normals of the corners of a triangle list (three corners per triangle, positions
+// given per corner) with smooth ones: the average of the normals of the triangles around the
+// corner's position, weighted by each triangle's angle there. Triangles whose normal is more than
+// creaseAngle degrees away from the corner's own triangle's are left out, so sharper edges stay
+// hard (0 gives flat normals, 180 smooths everything). Corners share a position when they have
+// the same id below numPositionIds; a corner whose id is out of range takes no part and keeps its
+// normal, as does one whose average vanishes. Runs on numThreads threads without any atomics:
+// each thread gathers, and writes, the normals of its own positions' corners.
+void generateVertexNormals(const float* positions, const unsigned int* positionIds, const size_t numCorners,
+	const size_t numPositionIds, const float creaseAngle, const unsigned int numThreads, float* normals);
+
+// computes a tangent frame for every vertex of an indexed triangle list, following the MikkTSpace
+// conventions: each triangle's texture-space u and v directions are projected into the plane of
+// the vertex normal, normalised, and averaged weighted by the triangle's angle at the vertex. The
+// result is xyzw per vertex: the unit tangent, and in w the sign (1 or -1) that turns
+// cross(normal, tangent) into the bitangent. Vertices that no mapped triangle uses get an
+// arbitrary tangent in their plane. Runs over triangle ranges, then vertex ranges, on numThreads
+// threads without atomics.
+void generateVertexTangents(const float* positions, const float* textureCoords, const float* normals,
+	const size_t numVertices, const unsigned int* indices, const size_t numIndices, const unsigned int numThreads,
+	float* tangents);
@@ -0,0 +1,212 @@
+#include <cmath>
+#include <cstring>
+
+#include "VertexQuantization.h"
+#include "PositionBounds.h"
+
+// the largest value of the unsigned position codes, and of the signed direction codes
+static const float positionSteps = 65535.0f;
+static const float directionSteps = 32767.0f;
+
+uint16_t floatToHalf(float value) {
+	uint32_t bits;
+	memcpy(&bits, &value, sizeof(bits));
+	uint16_t sign = (uint16_t)((bits >> 16) & 0x8000);
+	uint32_t exponent = (bits >> 23) & 0xff;
+	uint32_t mantissa = bits & 0x7fffff;
+
+	// NaN stays NaN, and infinity, or anything too big for a half, becomes infinity
+	if (exponent == 0xff) {
+		return sign | 0x7c00 | (mantissa != 0 ? 0x200 : 0);
+	}
+	int halfExponent = (int)exponent - 127 + 15;
+	if (halfExponent >= 31) {
+		return sign | 0x7c00;
+	}
+
+	if (halfExponent <= 0) {
+		// a subnormal half, or zero; the implicit leading bit becomes explicit
+		if (halfExponent < -10) {
+			return sign;
+		}
+		mantissa |= 0x800000;
+		int shift = 14 - halfExponent;
+		uint32_t halfMantissa = mantissa >> shift;
+		uint32_t remainder = mantissa & ((1u << shift) - 1);
+		uint32_t halfway = 1u << (shift - 1);
+		if (remainder > halfway || (remainder == halfway && (halfMantissa & 1))) {
+			halfMantissa++;
+		}
+		return sign | (uint16_t)halfMantissa;
+	}
+
+	// round the 23-bit mantissa to 10 bits; a carry out of the mantissa correctly bumps the exponent
+	uint32_t half = ((uint32_t)halfExponent << 10) | (mantissa >> 13);
+	uint32_t remainder = mantissa & 0x1fff;
+	if (remainder > 0x1000 || (remainder == 0x1000 && (half & 1))) {
+		half++;
+	}
+	return sign | (uint16_t)half;
+}
+
+float halfToFloat(uint16_t half) {
+	uint32_t sign = (uint32_t)(half & 0x8000) << 16;
+	uint32_t exponent = (half >> 10) & 0x1f;
+	uint32_t mantissa = half & 0x3ff;
+
+	uint32_t bits;
+	if (exponent == 0x1f) {
+		bits = sign | 0x7f800000 | (mantissa << 13);
+	} else if (exponent != 0) {
+		bits = sign | ((exponent - 15 + 127) << 23) | (mantissa << 13);
+	} else if (mantissa != 0) {
+		// a subnormal half is a normal float
+		float value = (float)mantissa * (1.0f / 16777216.0f);
+		return sign != 0 ? -value : value;
+	} else {
+		bits = sign;
+	}
+	float value;
+	memcpy(&value, &bits, sizeof(value));
+	return value;
+}
+
+static inline int16_t encodeSigned(float value) {
+	value = value < -1.0f ? -1.0f : (value > 1.0f ? 1.0f : value);
+	return (int16_t)lrintf(value * directionSteps);
+}
+
+// maps a direction onto the octahedron |x| + |y| + |z| = 1, and folds the lower half over the upper,
+// so two numbers in [-1, 1] describe it; a zero vector encodes as straight up
+static inline void encodeOctahedral(const float* direction, int16_t* encoded) {
+	float l1 = fabsf(direction[0]) + fabsf(direction[1]) + fabsf(direction[2]);
+	float x = 0.0f, y = 0.0f;
+	if (l1 > 0.0f) {
+		x = direction[0] / l1;
+		y = direction[1] / l1;
+		if (direction[2] < 0.0f) {
+			float foldedX = (1.0f - fabsf(y)) * (x >= 0.0f ? 1.0f : -1.0f);
+			float foldedY = (1.0f - fabsf(x)) * (y >= 0.0f ? 1.0f : -1.0f);
+			x = foldedX;
+			y = foldedY;
+		}
+	}
+	encoded[0] = encodeSigned(x);
+	encoded[1] = encodeSigned(y);
+}
+
+// the inverse of encodeOctahedral(), as the vertex shaders do it
+static inline void decodeOctahedral(const int16_t* encoded, float* direction) {
+	float x = encoded[0] / directionSteps;
+	float y = encoded[1] / directionSteps;
+	float z = 1.0f - fabsf(x) - fabsf(y);
+	if (z < 0.0f) {
+		float unfoldedX = (1.0f - fabsf(y)) * (x >= 0.0f ? 1.0f : -1.0f);
+		float unfoldedY = (1.0f - fabsf(x)) * (y >= 0.0f ? 1.0f : -1.0f);
+		x = unfoldedX;
+		y = unfoldedY;
+	}
+	float length = sqrtf(x * x + y * y + z * z);
+	direction[0] = x / length;
+	direction[1] = y / length;
+	direction[2] = z / length;
+}
+
+void quantizeVertices(const float* positions, const float* textureCoords, const float* normals, const float* tangents,
+	const size_t numVertices, QuantizedVertices &quantized) {
+	PositionBounds bounds;
+	computePositionBounds(positions, numVertices, bounds);
+	for (int axis = 0; axis < 3; axis++) {
+		quantized.positionOffset[axis] = bounds.min[axis];
+		quantized.positionScale[axis] = (bounds.max[axis] - bounds.min[axis]) / positionSteps;
+	}
+
+	quantized.positions.resize(numVertices * 4);
+	quantized.textureCoords.resize(numVertices * 2);
+	quantized.normals.resize(numVertices * 2);
+	quantized.tangents.resize(tangents != nullptr ? numVertices * 4 : 0);
+
+	for (size_t v = 0; v < numVertices; v++) {
+		for (int axis = 0; axis < 3; axis++) {
+			float scale = quantized.positionScale[axis];
+			float code = scale > 0.0f ? (positions[v * 3 + axis] - quantized.positionOffset[axis]) / scale : 0.0f;
+			code = code < 0.0f ? 0.0f : (code > positionSteps ? positionSteps : code);
+			quantized.positions[v * 4 + axis] = (uint16_t)lrintf(code);
+		}
+		quantized.positions[v * 4 + 3] = 0;
+
+		quantized.textureCoords[v * 2 + 0] = floatToHalf(textureCoords[v * 2 + 0]);
+		quantized.textureCoords[v * 2 + 1] = floatToHalf(textureCoords[v * 2 + 1]);
+
+		encodeOctahedral(normals + v * 3, &quantized.normals[v * 2]);
+
+		if (tangents != nullptr) {
+			encodeOctahedral(tangents + v * 4, &quantized.tangents[v * 4]);
+			quantized.tangents[v * 4 + 2] = tangents[v * 4 + 3] < 0.0f ? -32767 : 32767;
+			quantized.tangents[v * 4 + 3] = 0;
+		}
+	}
+}
+
+VertexLayout quantizedVertexLayout() {
+	VertexLayout layout;
+	initVertexLayout(layout);
+	addVertexAttribute(layout, VERTEX_POSITION, 3, VERTEX_UNSIGNED_SHORT, 4 * sizeof(uint16_t));
+	addVertexAttribute(layout, VERTEX_TEXTURE_COORDS, 2, VERTEX_HALF_FLOAT, 2 * sizeof(uint16_t));
+	addVertexAttribute(layout, VERTEX_NORMAL, 2, VERTEX_SHORT, 2 * sizeof(int16_t));
+	addVertexAttribute(layout, VERTEX_TANGENT, 3, VERTEX_SHORT, 4 * sizeof(int16_t));
+	return layout;
+}
+
+// the angle between a unit vector and another vector, in degrees; zero if the other is zero
+static inline float angleDegrees(const float* unit, const float* other) {
+	float length = sqrtf(other[0] * other[0] + other[1] * other[1] + other[2] * other[2]);
+	if (length == 0.0f) {
+		return 0.0f;
+	}
+	float cosine = (unit[0] * other[0] + unit[1] * other[1] + unit[2] * other[2]) / length;
+	cosine = cosine < -1.0f ? -1.0f : (cosine > 1.0f ? 1.0f : cosine);
+	return acosf(cosine) * 180.0f / 3.14159265f;
+}
+
+QuantizationError measureQuantizationError(const QuantizedVertices &quantized, const float* positions,
+	const float* textureCoords, const float* normals, const float* tangents, const size_t numVertices) {
+	QuantizationError error;
+	error.position = 0.0f;
+	error.relativePosition = 0.0f;
+	error.textureCoord = 0.0f;
+	error.normalDegrees = 0.0f;
+	error.tangentDegrees = 0.0f;
+
+	float largestExtent = 0.0f;
+	for (int axis = 0; axis < 3; axis++) {
+		float extent = quantized.positionScale[axis] * positionSteps;
+		largestExtent = extent > largestExtent ? extent : largestExtent;
+	}
+
+	for (size_t v = 0; v < numVertices; v++) {
+		for (int axis = 0; axis < 3; axis++) {
+			float decoded = quantized.positionOffset[axis] + quantized.positionScale[axis] * quantized.positions[v * 4 + axis];
+			float difference = fabsf(decoded - positions[v * 3 + axis]);
+			error.position = difference > error.position ? difference : error.position;
+		}
+		for (int c = 0; c < 2; c++) {
+			float difference = fabsf(halfToFloat(quantized.textureCoords[v * 2 + c]) - textureCoords[v * 2 + c]);
+			error.textureCoord = difference > error.textureCoord ? difference : error.textureCoord;
+		}
+
+		float direction[3];
+		decodeOctahedral(&quantized.normals[v * 2], direction);
+		float degrees = angleDegrees(direction, normals + v * 3);
+		error.normalDegrees = degrees > error.normalDegrees ? degrees : error.normalDegrees;
+
+		if (tangents != nullptr && !quantized.tangents.empty()) {
+			decodeOctahedral(&quantized.tangents[v * 4], direction);
+			degrees = angleDegrees(direction, tangents + v * 4);
+			error.tangentDegrees = degrees > error.tangentDegrees ? degrees : error.tangentDegrees;
+		}
+	}
+
+	error.relativePosition = largestExtent > 0.0f ? error.position / largestExtent : 0.0f;
+	return error;
+}
@@ -0,0 +1,54 @@
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "VertexLayout.h"
+
+#pragma once
+
+// a compact copy of a mesh's vertex attributes for the GPU, one array per attribute like the float
+// ones, at 24 bytes a vertex instead of 48:
+// - positions: 16-bit unsigned integers across the bounding box, xyz plus a zero pad so each
+//   vertex stays 4-byte aligned; position = positionOffset + positionScale * q
+// - texture coordinates: half floats
+// - normals: octahedral encoding in two 16-bit signed integers, over 32767
+// - tangents: the octahedral tangent in x and y, and w (the bitangent sign) as +-32767 in z
+// The integers are meant to be fed to the shaders unnormalised and decoded there, which sidesteps
+// the two different snorm conversions OpenGL versions disagree on.
+struct QuantizedVertices {
+	std::vector<uint16_t> positions;
+	std::vector<uint16_t> textureCoords;
+	std::vector<int16_t> normals;
+	std::vector<int16_t> tangents;
+	float positionOffset[3];
+	float positionScale[3];
+};
+typedef struct QuantizedVertices QuantizedVertices;
+
+// the largest error the quantisation introduced: positions in mesh units and as a fraction of the
+// largest extent, texture coordinates in texture units, and directions as angles in degrees
+struct QuantizationError {
+	float position;
+	float relativePosition;
+	float textureCoord;
+	float normalDegrees;
+	float tangentDegrees;
+};
+typedef struct QuantizationError QuantizationError;
+
+// encodes numVertices vertices of packed xyz positions, uv texture coordinates, xyz normals and
+// xyzw tangents (which may be null, and then is left empty)
+void quantizeVertices(const float* positions, const float* textureCoords, const float* normals, const float* tangents,
+	const size_t numVertices, QuantizedVertices &quantized);
+
+// decodes the quantized vertices the way the shaders do, and compares them with the originals
+QuantizationError measureQuantizationError(const QuantizedVertices &quantized, const float* positions,
+	const float* textureCoords, const float* normals, const float* tangents, const size_t numVertices);
+
+// the layout of the quantised attributes, 24 bytes a vertex when interleaved; the position and the
+// tangent each carry a pad component the shaders do not read
+VertexLayout quantizedVertexLayout();
+
+// IEEE half-float conversions, rounding to nearest even
+uint16_t floatToHalf(float value);
+float halfToFloat(uint16_t half);
@@ -2,6 +2,8 @@
 #include <iostream>
 #include <fstream>
 #include <cmath>
+#include <vector>
+#include <cstring>
 #include <GL/glew.h>
 #ifdef __APPLE__
 #  include <GLUT/glut.h>
@@ -21,11 +23,15 @@
 #include "trackball.hpp"
 #include "ShaderProgram.h"
 #include "ObjMesh.h"
+#include "VertexQuantization.h"
+#include "AssetPack.h"
 
 int width, height;
 
 GLuint programId;
 GLuint programId2;
+// the PN-triangle variant of the phong program, or 0 without OpenGL 4.0
+GLuint programIdTess = 0;
 
 GLuint vertexBuffer;
 GLuint indexBuffer;
@@ -35,11 +41,18 @@ GLuint positions_vbo = 0;
 
 GLuint textureCoords_vbo = 0;
 GLuint normals_vbo = 0;
+GLuint tangents_vbo = 0;
+GLuint vertices_vbo = 0;
 GLuint colours_vbo = 0;
 GLuint textureId;
 
 unsigned int numVertices;
 
+// how the index buffer is drawn: streamed batches are a 32-bit triangle list, while the finished
+// mesh takes whatever ObjMesh compacted it to, 16-bit indices and strips where it can
+GLenum indexType = GL_UNSIGNED_INT;
+GLenum primitiveMode = GL_TRIANGLES;
+
 float angle = 0.0f;
 float lightOffsetY = 0.0f;
 glm::vec3 eyePosition(40, 30, 30);
@@ -55,15 +68,43 @@ float xAngle = 0.0f;
 float yAngle = 0.0f;
 float zAngle = 0.0f;
 
+// the meshes, textures and shaders packed by assetpack, when there is a pack; whatever it lacks
+// is read from the loose files
+AssetPack assetPack;
+
 static void createTexture(std::string filename) {
-	int imageWidth, imageHeight;
+	int imageWidth = 0, imageHeight = 0;
 	int numComponents;
 
-	// load the image data into a bitmap
-	unsigned char *bitmap = stbi_load(filename.c_str(),
-		&imageWidth,
-		&imageHeight,
-		&numComponents, 4);
+	// load the image data into a bitmap: already decoded in the pack, compressed in the pack, or
+	// from the loose file
+	const AssetEntry* asset = assetPack.find(filename);
+	const unsigned char* pixels = nullptr;
+	unsigned char *bitmap = nullptr;
+	AssetImageHeader image;
+	if (asset != nullptr && asset->format == ASSET_IMAGE_RGBA8 && asset->size >= sizeof(image)) {
+		memcpy(&image, asset->data, sizeof(image));
+		if ((unsigned long long)image.width * image.height * 4 <= asset->size - sizeof(image)) {
+			imageWidth = (int)image.width;
+			imageHeight = (int)image.height;
+			pixels = (const unsigned char*)asset->data + sizeof(image);
+		}
+	} else if (asset != nullptr && asset->format == ASSET_RAW) {
+		bitmap = stbi_load_from_memory((const stbi_uc*)asset->data, (int)asset->size,
+			&imageWidth,
+			&imageHeight,
+			&numComponents, 4);
+		pixels = bitmap;
+	} else {
+		bitmap = stbi_load(filename.c_str(),
+			&imageWidth,
+			&imageHeight,
+			&numComponents, 4);
+		pixels = bitmap;
+	}
+	if (pixels == nullptr) {
+		std::cout << "Could not load texture " << filename.c_str() << std::endl;
+	}
 
 	// generate a texture name
 	glGenTextures(1, &textureId);
@@ -85,7 +126,7 @@ static void createTexture(std::string filename) {
 
 	// send the data to OpenGL
 	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, imageWidth, imageHeight,
-		0, GL_RGBA, GL_UNSIGNED_BYTE, bitmap);
+		0, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
 
 	// bind the texture to unit 0
 	glBindTexture(GL_TEXTURE_2D, textureId);
@@ -95,38 +136,285 @@ static void createTexture(std::string filename) {
 	stbi_image_free(bitmap);
 }
 
-// this function loads in the head obj
-static void createGeometry(void) {
-	// load in head object
-   ObjMesh mesh;
-   mesh.load("meshes/newHead.obj", true, true);
+// the head mesh is streamed in over the first frames, then swapped for the final, optimised one;
+// any other OBJ or GLB file can stand in for it, named on the command line
+ObjMesh mesh;
+std::string meshFilename = "meshes/newHead.obj";
+bool streamingGeometry = false;
+// whether back faces are culled: only once the finished mesh turns out to be closed
+bool cullBackFaces = false;
+unsigned int vertexCapacity = 0;
+unsigned int indexCapacity = 0;
+
+// how many triangles to parse at a time, and how long each frame may spend streaming
+#define STREAM_BATCH_TRIANGLES 4096
+#define STREAM_FRAME_BUDGET_MS 8
+
+// the vertical field of view, in degrees
+#define FIELD_OF_VIEW 45.0f
+
+// each of the small heads draws the coarsest level of detail whose error covers at most
+// LOD_PIXEL_ERROR pixels on screen; it only moves to a coarser level once that is comfortably
+// below the threshold, and back once the current one is comfortably above, so a head sitting on
+// the threshold does not flicker between two levels
+#define LOD_PIXEL_ERROR 1.0f
+#define LOD_HYSTERESIS 0.25f
+unsigned int headLods[4] = { 0, 0, 0, 0 };
+
+// the central head is drawn from the first level of subdivision whose remaining facets (the
+// longest curved edge left) cover at most SUBDIVISION_PIXEL_EDGE pixels on screen, unless
+// subdivision is off (toggled with 's'); each level is built and uploaded the first time it is needed
+#define SUBDIVISION_PIXEL_EDGE 12.0f
+bool subdivideHead = true;
+struct SubdivisionBuffers {
+   GLuint positions;
+   GLuint textureCoords;
+   GLuint normals;
+   GLuint tangents;
+   GLuint indices;
+};
+std::vector<SubdivisionBuffers> subdivisionBuffers;
+
+// whether the central head is tessellated on the GPU instead (toggled with 't'), as PN triangles
+// whose edges are split into segments of about TESSELLATION_PIXEL_EDGE pixels on screen, so the
+// detail follows the zoom without storing any vertices beyond the mesh's own. Patches need a
+// triangle list, which is uploaded beside the strips the first time it is needed.
+#define TESSELLATION_PIXEL_EDGE 8.0f
+bool tessellateHead = false;
+GLuint patchIndexBuffer = 0;
+bool patchIndicesUploaded = false;
+
+// whether the full-detail heads skip the meshlets that are off screen or, on a closed mesh, face
+// away (toggled with 'c')
+bool cullMeshlets = true;
+
+// whether the finished mesh is uploaded in the compact format (toggled with 'q') and interleaved
+// in vertices_vbo (toggled with 'i'), and what the buffers hold right now: the format of each
+// attribute, and whether they are interleaved or in one buffer per attribute; streamed batches
+// are always separate floats. The compact format's half-float texture coordinates need OpenGL 3.0
+// or ARB_half_float_vertex, so without either it stays off.
+bool quantizeAttributes = true;
+bool interleaveAttributes = true;
+bool attributesQuantized = false;
+bool attributesInterleaved = false;
+VertexLayout vertexLayout = floatVertexLayout();
+float positionOffset[3] = { 0.0f, 0.0f, 0.0f };
+float positionScale[3] = { 1.0f, 1.0f, 1.0f };
+
+// uploads the attributes into the buffers the current layout reads them from, and empties the
+// buffers it does not, so only one copy of the vertices stays on the GPU
+static void uploadAttributes(const void* const* attributes, const void* interleaved) {
+   GLuint attributeBuffers[VERTEX_NUM_ATTRIBUTES] = { positions_vbo, textureCoords_vbo, normals_vbo, tangents_vbo };
+   for (int a = 0; a < VERTEX_NUM_ATTRIBUTES; a++) {
+      glBindBuffer(GL_ARRAY_BUFFER, attributeBuffers[a]);
+      if (attributesInterleaved) {
+         glBufferData(GL_ARRAY_BUFFER, 0, nullptr, GL_STATIC_DRAW);
+      } else {
+         glBufferData(GL_ARRAY_BUFFER, vertexCapacity * vertexLayout.attributes[a].size, attributes[a], GL_STATIC_DRAW);
+      }
+   }
 
-   numVertices = mesh.getNumIndexedVertices();
-   Vector3* vertexPositions = mesh.getIndexedPositions();
-   Vector2* vertexTextureCoords = mesh.getIndexedTextureCoords();
-   Vector3* vertexNormals = mesh.getIndexedNormals();
+   glBindBuffer(GL_ARRAY_BUFFER, vertices_vbo);
+   if (attributesInterleaved) {
+      glBufferData(GL_ARRAY_BUFFER, vertexCapacity * vertexLayout.stride, interleaved, GL_STATIC_DRAW);
+   } else {
+      glBufferData(GL_ARRAY_BUFFER, 0, nullptr, GL_STATIC_DRAW);
+   }
+}
 
-   glGenBuffers(1, &positions_vbo);
-   glBindBuffer(GL_ARRAY_BUFFER, positions_vbo);
-   glBufferData(GL_ARRAY_BUFFER, numVertices * sizeof(Vector3), vertexPositions, GL_STATIC_DRAW);
+// uploads the vertex attributes quantised, and reports what that saved and cost
+static void uploadQuantizedAttributes(void) {
+   const float* positions = (const float*)mesh.getIndexedPositions();
+   const float* textureCoords = (const float*)mesh.getIndexedTextureCoords();
+   const float* normals = (const float*)mesh.getIndexedNormals();
+   const float* tangents = (const float*)mesh.getIndexedTangents();
+
+   QuantizedVertices quantized;
+   quantizeVertices(positions, textureCoords, normals, tangents, vertexCapacity, quantized);
+   QuantizationError error = measureQuantizationError(quantized, positions, textureCoords, normals, tangents, vertexCapacity);
+
+   std::cout << "Quantized vertices: " << floatVertexLayout().stride << " -> " << quantizedVertexLayout().stride << " bytes each; max error: position "
+      << error.position << " (" << error.relativePosition * 100.0f << "% of the extent), texture coordinate "
+      << error.textureCoord << ", normal " << error.normalDegrees << " degrees, tangent "
+      << error.tangentDegrees << " degrees" << std::endl;
+
+   attributesQuantized = true;
+   attributesInterleaved = interleaveAttributes;
+   vertexLayout = quantizedVertexLayout();
+
+   const void* attributes[VERTEX_NUM_ATTRIBUTES];
+   attributes[VERTEX_POSITION] = quantized.positions.data();
+   attributes[VERTEX_TEXTURE_COORDS] = quantized.textureCoords.data();
+   attributes[VERTEX_NORMAL] = quantized.normals.data();
+   attributes[VERTEX_TANGENT] = quantized.tangents.data();
+   std::vector<unsigned char> interleaved;
+   if (attributesInterleaved) {
+      interleaved.resize((size_t)vertexCapacity * vertexLayout.stride);
+      interleaveVertices(vertexLayout, attributes, vertexCapacity, interleaved.data());
+   }
+   uploadAttributes(attributes, interleaved.data());
 
-   glGenBuffers(1, &textureCoords_vbo);
-   glBindBuffer(GL_ARRAY_BUFFER, textureCoords_vbo);
-   glBufferData(GL_ARRAY_BUFFER, numVertices * sizeof(Vector2), vertexTextureCoords, GL_STATIC_DRAW);
+   for (int axis = 0; axis < 3; axis++) {
+      positionOffset[axis] = quantized.positionOffset[axis];
+      positionScale[axis] = quantized.positionScale[axis];
+   }
+}
 
-   glGenBuffers(1, &normals_vbo);
+// uploads the vertex attributes as the mesh holds them, in floats
+static void uploadFloatAttributes(void) {
+   attributesQuantized = false;
+   attributesInterleaved = interleaveAttributes && mesh.getInterleavedVertices() != nullptr;
+   vertexLayout = mesh.getVertexLayout();
+
+   const void* attributes[VERTEX_NUM_ATTRIBUTES];
+   attributes[VERTEX_POSITION] = mesh.getIndexedPositions();
+   attributes[VERTEX_TEXTURE_COORDS] = mesh.getIndexedTextureCoords();
+   attributes[VERTEX_NORMAL] = mesh.getIndexedNormals();
+   attributes[VERTEX_TANGENT] = mesh.getIndexedTangents();
+   uploadAttributes(attributes, mesh.getInterleavedVertices());
+
+   for (int axis = 0; axis < 3; axis++) {
+      positionOffset[axis] = 0.0f;
+      positionScale[axis] = 1.0f;
+   }
+}
+
+// uploads the whole mesh, replacing whatever the buffers held
+static void uploadGeometry(void) {
+   // welded vertices are shared between triangles, so there are fewer of them than indices
+   numVertices = mesh.getNumDrawIndices();
+   vertexCapacity = mesh.getNumVertices();
+   indexCapacity = numVertices;
+   indexType = mesh.getDrawIndexSize() == sizeof(unsigned short) ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+   primitiveMode = mesh.getDrawPrimitive() == OBJ_TRIANGLE_STRIP ? GL_TRIANGLE_STRIP : GL_TRIANGLES;
+
+   if (quantizeAttributes) {
+      uploadQuantizedAttributes();
+   } else {
+      uploadFloatAttributes();
+   }
+
+   glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer);
+   glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexCapacity * mesh.getDrawIndexSize(), mesh.getDrawIndices(), GL_STATIC_DRAW);
+   patchIndicesUploaded = false;
+   cullBackFaces = mesh.isClosed();
+
+   // the levels of subdivision uploaded so far may be of the mesh that was there before
+   for (size_t level = 0; level < subdivisionBuffers.size(); level++) {
+      const SubdivisionBuffers &buffers = subdivisionBuffers[level];
+      GLuint names[] = { buffers.positions, buffers.textureCoords, buffers.normals, buffers.tangents, buffers.indices };
+      glDeleteBuffers(5, names);
+   }
+   subdivisionBuffers.clear();
+}
+
+// the capacity to grow to for count elements; doubling keeps the total re-upload cost linear
+static unsigned int grownCapacity(unsigned int capacity, unsigned int count) {
+   return count > capacity * 2 ? count : capacity * 2;
+}
+
+// reallocates a buffer with room for capacity elements, keeping the first used elements of data
+static void reallocateBuffer(GLenum target, GLuint buffer, unsigned int capacity, unsigned int used,
+                             size_t elementSize, const void* data) {
+   glBindBuffer(target, buffer);
+   glBufferData(target, capacity * elementSize, nullptr, GL_DYNAMIC_DRAW);
+   glBufferSubData(target, 0, used * elementSize, data);
+}
+
+// uploads the part of the mesh that one streamed batch added
+static void appendGeometry(const ObjMeshBatch &batch) {
+   unsigned int vertexEnd = batch.firstVertex + batch.numVertices;
+   unsigned int indexEnd = batch.firstIndex + batch.numIndices;
+
+   if (vertexEnd > vertexCapacity) {
+      vertexCapacity = grownCapacity(vertexCapacity, vertexEnd);
+      reallocateBuffer(GL_ARRAY_BUFFER, positions_vbo, vertexCapacity, batch.firstVertex,
+                       sizeof(Vector3), mesh.getIndexedPositions());
+      reallocateBuffer(GL_ARRAY_BUFFER, textureCoords_vbo, vertexCapacity, batch.firstVertex,
+                       sizeof(Vector2), mesh.getIndexedTextureCoords());
+      reallocateBuffer(GL_ARRAY_BUFFER, normals_vbo, vertexCapacity, batch.firstVertex,
+                       sizeof(Vector3), mesh.getIndexedNormals());
+      reallocateBuffer(GL_ARRAY_BUFFER, tangents_vbo, vertexCapacity, batch.firstVertex,
+                       sizeof(Vector4), mesh.getIndexedTangents());
+   }
+   if (indexEnd > indexCapacity) {
+      indexCapacity = grownCapacity(indexCapacity, indexEnd);
+      reallocateBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer, indexCapacity, batch.firstIndex,
+                       sizeof(unsigned int), mesh.getTriangleIndices());
+   }
+
+   glBindBuffer(GL_ARRAY_BUFFER, positions_vbo);
+   glBufferSubData(GL_ARRAY_BUFFER, batch.firstVertex * sizeof(Vector3), batch.numVertices * sizeof(Vector3),
+                   mesh.getIndexedPositions() + batch.firstVertex);
+   glBindBuffer(GL_ARRAY_BUFFER, textureCoords_vbo);
+   glBufferSubData(GL_ARRAY_BUFFER, batch.firstVertex * sizeof(Vector2), batch.numVertices * sizeof(Vector2),
+                   mesh.getIndexedTextureCoords() + batch.firstVertex);
    glBindBuffer(GL_ARRAY_BUFFER, normals_vbo);
-   glBufferData(GL_ARRAY_BUFFER, numVertices * sizeof(Vector3), vertexNormals, GL_STATIC_DRAW);
+   glBufferSubData(GL_ARRAY_BUFFER, batch.firstVertex * sizeof(Vector3), batch.numVertices * sizeof(Vector3),
+                   mesh.getIndexedNormals() + batch.firstVertex);
+   glBindBuffer(GL_ARRAY_BUFFER, tangents_vbo);
+   glBufferSubData(GL_ARRAY_BUFFER, batch.firstVertex * sizeof(Vector4), batch.numVertices * sizeof(Vector4),
+                   mesh.getIndexedTangents() + batch.firstVertex);
+   glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer);
+   glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, batch.firstIndex * sizeof(unsigned int), batch.numIndices * sizeof(unsigned int),
+                   mesh.getTriangleIndices() + batch.firstIndex);
+
+   // draw everything that has arrived so far
+   numVertices = indexEnd;
+}
+
+// parses and uploads more of the head, for at most one frame's budget
+static void streamGeometry(void) {
+   int start = glutGet(GLUT_ELAPSED_TIME);
+   ObjMeshBatch batch;
+   while (glutGet(GLUT_ELAPSED_TIME) - start < STREAM_FRAME_BUDGET_MS) {
+      if (!mesh.streamBatch(STREAM_BATCH_TRIANGLES, batch)) {
+         // everything is in; swap in the welded, reordered mesh
+         mesh.endStream();
+         uploadGeometry();
+         streamingGeometry = false;
+         return;
+      }
+      appendGeometry(batch);
+   }
+}
 
-   unsigned int* indexData = mesh.getTriangleIndices();
-   int numTriangles = mesh.getNumTriangles();
+// this function starts loading in the head obj
+static void createGeometry(void) {
+	// load in head object
+   mesh.setAssetPack(&assetPack);
+   mesh.setUseCache(true);
+   mesh.setWeldVertices(true);
+   mesh.setOptimizeVertexCache(true);
+   mesh.setOptimizeVertexFetch(true);
+   // only the float format is uploaded from the mesh's interleaved copy
+   mesh.setInterleaveVertices(!quantizeAttributes);
+   // primitive restart, which joins the strips, arrived in OpenGL 3.1
+   mesh.setGenerateStrips(GLEW_VERSION_3_1 != 0);
+   mesh.setGenerateLods(true);
+   mesh.setGenerateMeshlets(true);
 
+   glGenBuffers(1, &positions_vbo);
+   glGenBuffers(1, &textureCoords_vbo);
+   glGenBuffers(1, &normals_vbo);
+   glGenBuffers(1, &tangents_vbo);
+   glGenBuffers(1, &vertices_vbo);
    glGenBuffers(1, &indexBuffer);
-   glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer);
-   glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(unsigned int) * numTriangles * 3, indexData, GL_STATIC_DRAW);
+
+   numVertices = 0;
+   indexType = GL_UNSIGNED_INT;
+   primitiveMode = GL_TRIANGLES;
+   attributesQuantized = false;
+   attributesInterleaved = false;
+   vertexLayout = floatVertexLayout();
+   streamingGeometry = mesh.beginStream(meshFilename, true, true);
 }
 
 static void update(void) {
+   if (streamingGeometry) {
+      streamGeometry();
+   }
+
    int milliseconds = glutGet(GLUT_ELAPSED_TIME);
 
    // rotate the shape about the y-axis so that we can see the shading
@@ -144,66 +432,331 @@ static void update(void) {
    glutPostRedisplay();
 }
 
+// the GL type of a vertex layout's components
+static GLenum glComponentType(VertexComponentType type) {
+	switch (type) {
+	case VERTEX_HALF_FLOAT: return GL_HALF_FLOAT;
+	case VERTEX_UNSIGNED_SHORT: return GL_UNSIGNED_SHORT;
+	case VERTEX_SHORT: return GL_SHORT;
+	default: return GL_FLOAT;
+	}
+}
+
+// points the shader's attributes at the vertex buffers, in whichever format they hold, and sets
+// the uniforms the vertex shaders decode them with
+static void bindVertexAttributes(GLuint program, GLint positionAttribId, GLint textureCoordsAttribId,
+                                 GLint normalAttribId, GLint tangentAttribId) {
+	GLuint positionOffsetId = glGetUniformLocation(program, "u_PositionOffset");
+	glUniform3f(positionOffsetId, positionOffset[0], positionOffset[1], positionOffset[2]);
+	GLuint positionScaleId = glGetUniformLocation(program, "u_PositionScale");
+	glUniform3f(positionScaleId, positionScale[0], positionScale[1], positionScale[2]);
+	GLuint octahedralNormalsId = glGetUniformLocation(program, "u_OctahedralNormals");
+	glUniform1i(octahedralNormalsId, attributesQuantized ? 1 : 0);
+
+	// quantised, the tangent's xy is octahedral and its z the sign of the bitangent, both over 32767
+	GLint attribIds[VERTEX_NUM_ATTRIBUTES] = { positionAttribId, textureCoordsAttribId, normalAttribId, tangentAttribId };
+	GLuint attributeBuffers[VERTEX_NUM_ATTRIBUTES] = { positions_vbo, textureCoords_vbo, normals_vbo, tangents_vbo };
+	for (int a = 0; a < VERTEX_NUM_ATTRIBUTES; a++) {
+		// an attribute the shader does not use (e.g. the tangent, without normal mapping) is skipped
+		if (attribIds[a] < 0) {
+			continue;
+		}
+		const VertexAttributeFormat &format = vertexLayout.attributes[a];
+		glBindBuffer(GL_ARRAY_BUFFER, attributesInterleaved ? vertices_vbo : attributeBuffers[a]);
+		glEnableVertexAttribArray(attribIds[a]);
+		glVertexAttribPointer(attribIds[a], format.components, glComponentType(format.type), GL_FALSE,
+			attributesInterleaved ? vertexLayout.stride : format.size,
+			(void*)(size_t)(attributesInterleaved ? format.offset : 0));
+	}
+}
+
+// the six planes of the view frustum in the space mvp maps from, scaled to unit normals so a
+// plane gives distances; they point inwards
+static void frustumPlanes(const glm::mat4 &mvp, glm::vec4* planes) {
+	glm::vec4 rows[4];
+	for (int i = 0; i < 4; i++) {
+		rows[i] = glm::vec4(mvp[0][i], mvp[1][i], mvp[2][i], mvp[3][i]);
+	}
+	for (int i = 0; i < 3; i++) {
+		planes[i * 2] = rows[3] + rows[i];
+		planes[i * 2 + 1] = rows[3] - rows[i];
+	}
+	for (int p = 0; p < 6; p++) {
+		planes[p] /= glm::length(glm::vec3(planes[p]));
+	}
+}
+
+// whether any of a meshlet may show: its bounding sphere reaches inside every frustum plane, and,
+// if back faces are hidden (useCone), its normal cone does not face wholly away from the eye; on
+// an open mesh the back faces show through the holes, so the cone must not drop them. planes and
+// eye are in model space, which keeps distances right as long as the model matrix scales uniformly
+static bool meshletVisible(const Meshlet &meshlet, const glm::vec4* planes, glm::vec3 eye, bool useCone) {
+	glm::vec3 centre(meshlet.centre[0], meshlet.centre[1], meshlet.centre[2]);
+	for (int p = 0; p < 6; p++) {
+		if (glm::dot(glm::vec3(planes[p]), centre) + planes[p].w < -meshlet.radius) {
+			return false;
+		}
+	}
+	if (!useCone) {
+		return true;
+	}
+	glm::vec3 axis(meshlet.coneAxis[0], meshlet.coneAxis[1], meshlet.coneAxis[2]);
+	glm::vec3 toCentre = centre - eye;
+	return glm::dot(toCentre, axis) < meshlet.coneCutoff * glm::length(toCentre) + meshlet.radius;
+}
+
+// the buffers of a level of subdivision, uploaded in floats the first time they are asked for
+static const SubdivisionBuffers &getSubdivisionBuffers(unsigned int level, const ObjSubdivision &subdivision) {
+	if (subdivisionBuffers.size() <= level) {
+		subdivisionBuffers.resize(level + 1, SubdivisionBuffers());
+	}
+	SubdivisionBuffers &buffers = subdivisionBuffers[level];
+	if (buffers.indices != 0) {
+		return buffers;
+	}
+
+	const SubdivisionMesh &levelMesh = subdivision.mesh;
+	glGenBuffers(1, &buffers.positions);
+	glBindBuffer(GL_ARRAY_BUFFER, buffers.positions);
+	glBufferData(GL_ARRAY_BUFFER, levelMesh.positions.size() * sizeof(float), levelMesh.positions.data(), GL_STATIC_DRAW);
+	glGenBuffers(1, &buffers.textureCoords);
+	glBindBuffer(GL_ARRAY_BUFFER, buffers.textureCoords);
+	glBufferData(GL_ARRAY_BUFFER, levelMesh.textureCoords.size() * sizeof(float), levelMesh.textureCoords.data(), GL_STATIC_DRAW);
+	glGenBuffers(1, &buffers.normals);
+	glBindBuffer(GL_ARRAY_BUFFER, buffers.normals);
+	glBufferData(GL_ARRAY_BUFFER, levelMesh.normals.size() * sizeof(float), levelMesh.normals.data(), GL_STATIC_DRAW);
+	glGenBuffers(1, &buffers.tangents);
+	glBindBuffer(GL_ARRAY_BUFFER, buffers.tangents);
+	glBufferData(GL_ARRAY_BUFFER, subdivision.tangents.size() * sizeof(Vector4), subdivision.tangents.data(), GL_STATIC_DRAW);
+	glGenBuffers(1, &buffers.indices);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffers.indices);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, levelMesh.indices.size() * sizeof(unsigned int), levelMesh.indices.data(), GL_STATIC_DRAW);
+	return buffers;
+}
+
+// draws a level of subdivision with its own buffers, which hold plain floats, with one call per
+// material like drawSubmeshes
+static void drawSubdivision(GLuint program, GLint* attribIds, GLuint diffuseColourId, unsigned int level) {
+	ObjSubdivision* subdivision = mesh.getSubdivision(level);
+	const SubdivisionBuffers &buffers = getSubdivisionBuffers(level, *subdivision);
+
+	glUniform3f(glGetUniformLocation(program, "u_PositionOffset"), 0.0f, 0.0f, 0.0f);
+	glUniform3f(glGetUniformLocation(program, "u_PositionScale"), 1.0f, 1.0f, 1.0f);
+	glUniform1i(glGetUniformLocation(program, "u_OctahedralNormals"), 0);
+	VertexLayout layout = floatVertexLayout();
+	GLuint attributeBuffers[VERTEX_NUM_ATTRIBUTES] = { buffers.positions, buffers.textureCoords, buffers.normals, buffers.tangents };
+	for (int a = 0; a < VERTEX_NUM_ATTRIBUTES; a++) {
+		if (attribIds[a] < 0) {
+			continue;
+		}
+		glBindBuffer(GL_ARRAY_BUFFER, attributeBuffers[a]);
+		glEnableVertexAttribArray(attribIds[a]);
+		glVertexAttribPointer(attribIds[a], layout.attributes[a].components, GL_FLOAT, GL_FALSE, layout.attributes[a].size, (void*)0);
+	}
+
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffers.indices);
+	ObjMaterial* materials = mesh.getMaterials();
+	for (size_t r = 0; r < subdivision->drawRanges.size(); r++) {
+		const ObjDrawRange &range = subdivision->drawRanges[r];
+		Vector3 diffuse = materials[range.material].diffuse;
+		glUniform4f(diffuseColourId, diffuse.x, diffuse.y, diffuse.z, materials[range.material].opacity);
+		glDrawElements(GL_TRIANGLES, range.numIndices, GL_UNSIGNED_INT, (void*)(range.firstIndex * sizeof(unsigned int)));
+	}
+}
+
+// draws the full mesh as patches of three vertices for the tessellation shaders, from its 32-bit
+// triangle list, with one call per submesh
+static void drawPatches(GLuint diffuseColourId) {
+	if (patchIndexBuffer == 0) {
+		glGenBuffers(1, &patchIndexBuffer);
+	}
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, patchIndexBuffer);
+	if (!patchIndicesUploaded) {
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, mesh.getNumIndexedVertices() * sizeof(unsigned int), mesh.getTriangleIndices(), GL_STATIC_DRAW);
+		patchIndicesUploaded = true;
+	}
+
+	glPatchParameteri(GL_PATCH_VERTICES, 3);
+	ObjSubmesh* submeshes = mesh.getSubmeshes();
+	ObjMaterial* materials = mesh.getMaterials();
+	for (unsigned int s = 0; s < mesh.getNumSubmeshes(); s++) {
+		const ObjSubmesh &submesh = submeshes[s];
+		Vector3 diffuse = materials[submesh.material].diffuse;
+		glUniform4f(diffuseColourId, diffuse.x, diffuse.y, diffuse.z, materials[submesh.material].opacity);
+		glDrawElements(GL_PATCHES, submesh.numIndices, GL_UNSIGNED_INT, (void*)(submesh.firstIndex * sizeof(unsigned int)));
+	}
+}
+
+// how many pixels a mesh unit covers at the distance of the model's origin
+static float pixelsPerUnit(glm::mat4 model_matrix) {
+	glm::vec4 centre = viewMatrix * model_matrix * glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+	float distance = fmaxf(-centre.z, 0.1f);
+	float scale = fmaxf(glm::length(glm::vec3(model_matrix[0])),
+		fmaxf(glm::length(glm::vec3(model_matrix[1])), glm::length(glm::vec3(model_matrix[2]))));
+	return scale * (float)height / (2.0f * distance * tanf(glm::radians(FIELD_OF_VIEW) * 0.5f));
+}
+
+// picks the level of subdivision to draw the central head with: the first whose longest curved
+// edge is at most SUBDIVISION_PIXEL_EDGE pixels long, so a distant head draws the mesh itself
+// (level 0) and only a close-up pays for the finer levels
+static unsigned int selectSubdivision(glm::mat4 model_matrix) {
+	if (!subdivideHead || streamingGeometry) {
+		return 0;
+	}
+	float unitPixels = pixelsPerUnit(model_matrix);
+	unsigned int level = 0;
+	while (level < mesh.getMaxSubdivisionLevel() && mesh.getSubdivisionEdgeLength(level) * unitPixels > SUBDIVISION_PIXEL_EDGE) {
+		level++;
+	}
+	return mesh.getSubdivision(level) != nullptr ? level : 0;
+}
+
+// draws one level of detail of the index buffer with one call per material, tinting the given
+// colour by each material's diffuse colour; a mesh still streaming in draws its 32-bit triangle
+// list in a single call. The full mesh leaves out the meshlets the model matrix puts outside the
+// view, or facing away on a closed mesh, unless culling is off.
+void drawSubmeshes(GLuint diffuseColourId, glm::vec4 colour, unsigned int lod, glm::mat4 model_matrix) {
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer);
+
+	if (streamingGeometry || lod >= mesh.getNumLods()) {
+		glUniform4f(diffuseColourId, colour.x, colour.y, colour.z, colour.w);
+		glDrawElements(GL_TRIANGLES, numVertices, GL_UNSIGNED_INT, (void*)0);
+		return;
+	}
+
+	// the strips of a range are separated by restart markers
+	if (primitiveMode == GL_TRIANGLE_STRIP) {
+		glEnable(GL_PRIMITIVE_RESTART);
+		glPrimitiveRestartIndex(mesh.getRestartIndex());
+	}
+
+	// level 0 has a range per meshlet, if there are any
+	bool cull = cullMeshlets && lod == 0 && mesh.getNumMeshlets() > 0;
+	Meshlet* meshlets = mesh.getMeshlets();
+	glm::vec4 planes[6];
+	glm::vec3 eye;
+	if (cull) {
+		frustumPlanes(projMatrix * viewMatrix * model_matrix, planes);
+		eye = glm::vec3(glm::inverse(model_matrix) * glm::vec4(eyePosition, 1.0f));
+	}
+
+	// the ranges of a material that are left go in one call
+	ObjDrawRange* ranges = mesh.getDrawRanges();
+	ObjMaterial* materials = mesh.getMaterials();
+	size_t indexSize = indexType == GL_UNSIGNED_SHORT ? sizeof(unsigned short) : sizeof(unsigned int);
+	ObjLod level = mesh.getLods()[lod];
+	std::vector<GLsizei> counts;
+	std::vector<const void*> offsets;
+	for (unsigned int r = level.firstRange; r < level.firstRange + level.numRanges; r++) {
+		if (!cull || meshletVisible(meshlets[r], planes, eye, cullBackFaces)) {
+			counts.push_back(ranges[r].numIndices);
+			offsets.push_back((const void*)(ranges[r].firstIndex * indexSize));
+		}
+
+		unsigned int material = ranges[r].material;
+		bool lastOfMaterial = r + 1 == level.firstRange + level.numRanges || ranges[r + 1].material != material;
+		if (lastOfMaterial && !counts.empty()) {
+			Vector3 diffuse = materials[material].diffuse;
+			glUniform4f(diffuseColourId, colour.x * diffuse.x, colour.y * diffuse.y, colour.z * diffuse.z,
+				colour.w * materials[material].opacity);
+			glMultiDrawElements(primitiveMode, counts.data(), indexType, offsets.data(), (GLsizei)counts.size());
+			counts.clear();
+			offsets.clear();
+		}
+	}
+
+	if (primitiveMode == GL_TRIANGLE_STRIP) {
+		glDisable(GL_PRIMITIVE_RESTART);
+	}
+}
 
 // THis function is used to draw the main head in the center
 // also inplements the phong shader
 void drawHead(glm::mat4 model_matrix) {
+	// the finished mesh may be tessellated instead, given OpenGL 4.0
+	bool tessellate = tessellateHead && programIdTess != 0 && !streamingGeometry;
+	GLuint program = tessellate ? programIdTess : programId;
+	glUseProgram(program);
+
 	// headModel-viewMatrix-projMatrix matrix
 	glm::mat4 mvp = projMatrix * viewMatrix * model_matrix;
-	GLuint mvpMatrixId = glGetUniformLocation(programId, "u_MVPMatrix");
+	GLuint mvpMatrixId = glGetUniformLocation(program, "u_MVPMatrix");
 	glUniformMatrix4fv(mvpMatrixId, 1, GL_FALSE, &mvp[0][0]);
 
 	// headModel-viewMatrix matrix
 	glm::mat4 mv = viewMatrix * model_matrix;
-	GLuint mvMatrixId = glGetUniformLocation(programId, "u_MVMatrix");
+	GLuint mvMatrixId = glGetUniformLocation(program, "u_MVMatrix");
 	glUniformMatrix4fv(mvMatrixId, 1, GL_FALSE, &mv[0][0]);
 	// the position of our light
-	GLuint lightPosId = glGetUniformLocation(programId, "u_LightPos");
+	GLuint lightPosId = glGetUniformLocation(program, "u_LightPos");
 	glUniform3f(lightPosId, 0, 0, 0);
 	// the position of our camera/eye
-	GLuint eyePosId = glGetUniformLocation(programId, "u_EyePosition");
+	GLuint eyePosId = glGetUniformLocation(program, "u_EyePosition");
 	glUniform3f(eyePosId, eyePosition.x, eyePosition.y, eyePosition.z);
 
-	// the colour of our object
-	GLuint diffuseColourId = glGetUniformLocation(programId, "u_DiffuseColour");
-	glUniform4f(diffuseColourId, 1.0, 1.0, 1.0, 1.0);
+	// the colour of our object, set per material as the triangles are drawn
+	GLuint diffuseColourId = glGetUniformLocation(program, "u_DiffuseColour");
 
 	// the shininess of the object's surface
-	GLuint shininessId = glGetUniformLocation(programId, "u_Shininess");
+	GLuint shininessId = glGetUniformLocation(program, "u_Shininess");
 	glUniform1f(shininessId, 45);
 
 	// find the names (ids) of each vertex attribute
-	GLint positionAttribId = glGetAttribLocation(programId, "position");
-	GLint textureCoordsAttribId = glGetAttribLocation(programId, "textureCoords");
-	GLint normalAttribId = glGetAttribLocation(programId, "normal");
-
-	// provide the vertex positions to the shaders
-	glBindBuffer(GL_ARRAY_BUFFER, positions_vbo);
-	glEnableVertexAttribArray(positionAttribId);
-	glVertexAttribPointer(positionAttribId, 3, GL_FLOAT, GL_FALSE, 0, nullptr);
-
-	// provide the vertex texture coordinates to the shaders
-	glBindBuffer(GL_ARRAY_BUFFER, textureCoords_vbo);
-	glEnableVertexAttribArray(textureCoordsAttribId);
-	glVertexAttribPointer(textureCoordsAttribId, 2, GL_FLOAT, GL_FALSE, 0, nullptr);
-
-	// provide the vertex normals to the shaders
-	glBindBuffer(GL_ARRAY_BUFFER, normals_vbo);
-	glEnableVertexAttribArray(normalAttribId);
-	glVertexAttribPointer(normalAttribId, 3, GL_FLOAT, GL_FALSE, 0, nullptr);
-
-	// draw the triangles
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer);
-	glDrawElements(GL_TRIANGLES, numVertices, GL_UNSIGNED_INT, (void*)0);
+	GLint positionAttribId = glGetAttribLocation(program, "position");
+	GLint textureCoordsAttribId = glGetAttribLocation(program, "textureCoords");
+	GLint normalAttribId = glGetAttribLocation(program, "normal");
+	GLint tangentAttribId = glGetAttribLocation(program, "tangent");
+
+	// draw the triangles, tessellated or subdivided as finely as the head's size on screen calls for
+	unsigned int level = tessellate ? 0 : selectSubdivision(model_matrix);
+	if (tessellate) {
+		GLuint viewportSizeId = glGetUniformLocation(program, "u_ViewportSize");
+		glUniform2f(viewportSizeId, (float)width, (float)height);
+		GLuint tessPixelEdgeId = glGetUniformLocation(program, "u_TessPixelEdge");
+		glUniform1f(tessPixelEdgeId, TESSELLATION_PIXEL_EDGE);
+		bindVertexAttributes(program, positionAttribId, textureCoordsAttribId, normalAttribId, tangentAttribId);
+		drawPatches(diffuseColourId);
+	} else if (level > 0) {
+		GLint attribIds[VERTEX_NUM_ATTRIBUTES] = { positionAttribId, textureCoordsAttribId, normalAttribId, tangentAttribId };
+		drawSubdivision(program, attribIds, diffuseColourId, level);
+	} else {
+		bindVertexAttributes(program, positionAttribId, textureCoordsAttribId, normalAttribId, tangentAttribId);
+		drawSubmeshes(diffuseColourId, glm::vec4(1.0, 1.0, 1.0, 1.0), 0, model_matrix);
+	}
 	// disable the attribute arrays
 	glDisableVertexAttribArray(positionAttribId);
 	glDisableVertexAttribArray(textureCoordsAttribId);
 	glDisableVertexAttribArray(normalAttribId);
+	if (tangentAttribId >= 0) {
+		glDisableVertexAttribArray(tangentAttribId);
+	}
+}
+
+// picks the level of detail to draw a head with from how large it appears: a level's error, in
+// mesh units, times the pixels a mesh unit covers at the head's distance
+static unsigned int selectLod(glm::mat4 model_matrix, unsigned int current) {
+	unsigned int numLods = mesh.getNumLods();
+	if (streamingGeometry || numLods <= 1) {
+		return 0;
+	}
+
+	float unitPixels = pixelsPerUnit(model_matrix);
+
+	// the errors grow with the level, so the last acceptable one is the coarsest
+	ObjLod* lods = mesh.getLods();
+	unsigned int lod = 0;
+	for (unsigned int l = 1; l < numLods; l++) {
+		float threshold = LOD_PIXEL_ERROR * (l <= current ? 1.0f + LOD_HYSTERESIS : 1.0f - LOD_HYSTERESIS);
+		if (lods[l].error * unitPixels <= threshold) {
+			lod = l;
+		}
+	}
+	return lod;
 }
 
 //This function is used to draw all the other heads
 // This functions uses a gouraud shader.
-void drawHead2(glm::mat4 model_matrix,   glm::vec4 colour ) {
+void drawHead2(glm::mat4 model_matrix,   glm::vec4 colour, unsigned int &lod) {
 	// headModel-viewMatrix-projMatrix matrix
 	glm::mat4 mvp = projMatrix * viewMatrix * model_matrix;
 	GLuint mvpMatrixId = glGetUniformLocation(programId2, "u_MVPMatrix");
@@ -220,9 +773,8 @@ void drawHead2(glm::mat4 model_matrix,   glm::vec4 colour ) {
 	GLuint eyePosId = glGetUniformLocation(programId2, "u_EyePosition");
 	glUniform3f(eyePosId, eyePosition.x, eyePosition.y, eyePosition.z);
 
-	// the colour of our object
+	// the colour of our object, set per material as the triangles are drawn
 	GLuint diffuseColourId = glGetUniformLocation(programId2, "u_DiffuseColour");
-	glUniform4f(diffuseColourId, colour.x, colour.y, colour.z, colour.w);
 
 	// the shininess of the object's surface
 	GLuint shininessId = glGetUniformLocation(programId2, "u_Shininess");
@@ -232,40 +784,39 @@ void drawHead2(glm::mat4 model_matrix,   glm::vec4 colour ) {
 	GLint positionAttribId = glGetAttribLocation(programId2, "position");
 	GLint textureCoordsAttribId = glGetAttribLocation(programId2, "textureCoords");
 	GLint normalAttribId = glGetAttribLocation(programId2, "normal");
+	GLint tangentAttribId = glGetAttribLocation(programId2, "tangent");
 
-	// provide the vertex positions to the shaders
-	glBindBuffer(GL_ARRAY_BUFFER, positions_vbo);
-	glEnableVertexAttribArray(positionAttribId);
-	glVertexAttribPointer(positionAttribId, 3, GL_FLOAT, GL_FALSE, 0, nullptr);
-
-	// provide the vertex texture coordinates to the shaders
-	glBindBuffer(GL_ARRAY_BUFFER, textureCoords_vbo);
-	glEnableVertexAttribArray(textureCoordsAttribId);
-	glVertexAttribPointer(textureCoordsAttribId, 2, GL_FLOAT, GL_FALSE, 0, nullptr);
+	// provide the vertex attributes to the shaders
+	bindVertexAttributes(programId2, positionAttribId, textureCoordsAttribId, normalAttribId, tangentAttribId);
 
-	// provide the vertex normals to the shaders
-	glBindBuffer(GL_ARRAY_BUFFER, normals_vbo);
-	glEnableVertexAttribArray(normalAttribId);
-	glVertexAttribPointer(normalAttribId, 3, GL_FLOAT, GL_FALSE, 0, nullptr);
-
-	// draw the triangles
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer);
-	glDrawElements(GL_TRIANGLES, numVertices, GL_UNSIGNED_INT, (void*)0);
+	// draw the triangles, as coarsely as the head's size on screen allows
+	lod = selectLod(model_matrix, lod);
+	drawSubmeshes(diffuseColourId, colour, lod, model_matrix);
 
 	// disable the attribute arrays
 	glDisableVertexAttribArray(positionAttribId);
 	glDisableVertexAttribArray(textureCoordsAttribId);
 	glDisableVertexAttribArray(normalAttribId);
+	if (tangentAttribId >= 0) {
+		glDisableVertexAttribArray(tangentAttribId);
+	}
 }
 
 static void render(void) {
    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
    // turn on depth buffering
    glEnable(GL_DEPTH_TEST);
+   // back faces are only culled on a closed mesh, where front faces always hide them; through
+   // the openings of an open one (e.g. the head's eyes and neck) its inside shows
+   if (cullBackFaces) {
+      glEnable(GL_CULL_FACE);
+   } else {
+      glDisable(GL_CULL_FACE);
+   }
 
    // projMatrix matrix - perspective projMatrix
    float aspectRatio = (float)width / (float)height;
-   projMatrix = glm::perspective(glm::radians(45.0f), aspectRatio, 0.1f, 1000.0f);
+   projMatrix = glm::perspective(glm::radians(FIELD_OF_VIEW), aspectRatio, 0.1f, 1000.0f);
 
    //view matrix
    viewMatrix = glm::lookAt(eyePosition, glm::vec3(0,0,0),glm::vec3(0,1,0));
@@ -274,7 +825,8 @@ static void render(void) {
 	glUseProgram(programId);
 
    // use sun texture on the center head
-   createTexture("textures/sun.jpg");
+   glActiveTexture(GL_TEXTURE0);
+   glBindTexture(GL_TEXTURE_2D, textureId);
 
    //vector for rotation
 
@@ -298,7 +850,7 @@ static void render(void) {
    headModel = glm::scale(headModel, glm::vec3(scaleFactor/ 7, scaleFactor / 7, scaleFactor / 7));
 	glm::vec4 blue = glm::vec4(glm::vec3(0.0,0.0,1.0),1.0 );
 
-   drawHead2(headModel, blue);
+   drawHead2(headModel, blue, headLods[0]);
 
 	// build red head
    headModel = glm::mat4(1.0f);
@@ -313,7 +865,7 @@ static void render(void) {
    headModel = glm::scale(headModel, glm::vec3(scaleFactor / 8, scaleFactor / 8, scaleFactor / 8));
 	glm::vec4 red = glm::vec4(glm::vec3(1.0,0.0,0.0),1.0 );
 
-   drawHead2(headModel, red);
+   drawHead2(headModel, red, headLods[1]);
 
 	// build green head
 	headModel = glm::mat4(1.0f);
@@ -328,7 +880,7 @@ static void render(void) {
    headModel = glm::scale(headModel, glm::vec3(scaleFactor/3, scaleFactor/3, scaleFactor/3));
 	glm::vec4 green = glm::vec4(glm::vec3(.0,1.0,0.0),1.0 );
 
-   drawHead2(headModel, green);
+   drawHead2(headModel, green, headLods[2]);
 
 	// build grey head
 	headModel = glm::mat4(1.0f);
@@ -343,7 +895,7 @@ static void render(void) {
    headModel = glm::scale(headModel, glm::vec3(scaleFactor/4, scaleFactor/4, scaleFactor/4));
 	glm::vec4 grey = glm::vec4(glm::vec3( 1.0, 1.0, 1.0),1.0 );
 
-   drawHead2(headModel, grey);
+   drawHead2(headModel, grey, headLods[3]);
 
 	// make the draw buffer to display buffer (i.e. display what we have drawn)
 	glutSwapBuffers();
@@ -363,6 +915,36 @@ static void keyboard(unsigned char key, int x, int y) {
       animateLight = !animateLight;
    } else if (key == 'r') {
       rotateObject = !rotateObject;
+   } else if (key == 'q') {
+      // switch between the compact and the float vertex formats, to compare them
+      if (GLEW_VERSION_3_0 || GLEW_ARB_half_float_vertex) {
+         quantizeAttributes = !quantizeAttributes;
+         mesh.setInterleaveVertices(!quantizeAttributes);
+         if (!streamingGeometry) {
+            uploadGeometry();
+         }
+      } else {
+         std::cout << "Quantized attributes need OpenGL 3.0 or ARB_half_float_vertex" << std::endl;
+      }
+   } else if (key == 'c') {
+      // draw every meshlet, to compare against culling them
+      cullMeshlets = !cullMeshlets;
+   } else if (key == 't') {
+      // tessellate the central head on the GPU, to compare against subdividing it
+      if (programIdTess != 0) {
+         tessellateHead = !tessellateHead;
+      } else {
+         std::cout << "Tessellation needs OpenGL 4.0" << std::endl;
+      }
+   } else if (key == 's') {
+      // draw the central head as it is, to compare against subdividing it
+      subdivideHead = !subdivideHead;
+   } else if (key == 'i') {
+      // switch between one interleaved vertex buffer and a buffer per attribute
+      interleaveAttributes = !interleaveAttributes;
+      if (!streamingGeometry) {
+         uploadGeometry();
+      }
    }
 }
 
@@ -370,6 +952,9 @@ static void keyboard(unsigned char key, int x, int y) {
 
 int main(int argc, char** argv) {
    glutInit(&argc, argv);
+   if (argc > 1) {
+      meshFilename = argv[1];
+   }
    glutInitDisplayMode(GLUT_RGB | GLUT_DOUBLE | GLUT_DEPTH);
    glutInitWindowSize(800, 600);
    glutCreateWindow("CSCI 3090u Final Project");
@@ -387,21 +972,44 @@ int main(int argc, char** argv) {
    }
    std::cout << "Using GLEW " << glewGetString(GLEW_VERSION) << std::endl;
 	std::cout << "Using OpenGL " << glGetString(GL_VERSION) << std::endl;
+   if (!GLEW_VERSION_3_0 && !GLEW_ARB_half_float_vertex) {
+      std::cout << "No half-float vertex attributes, uploading floats" << std::endl;
+      quantizeAttributes = false;
+   }
+
+   if (assetPack.open("assets.pack")) {
+      std::cout << "Using asset pack assets.pack (" << assetPack.getNumAssets() << " assets)" << std::endl;
+   } else {
+      std::cout << "No asset pack, reading loose files" << std::endl;
+   }
 
    createGeometry();
 
+   // the sun texture is decoded once, and only bound when drawing
+   createTexture("textures/sun.jpg");
+
 	// this creates program that uses the phong shader
    ShaderProgram program;
+   program.setAssetPack(&assetPack);
    program.loadShaders("shaders/phong_vertex.glsl", "shaders/phong_fragment.glsl");
 
   	programId = program.getProgramId();
    
 	// this creates program that uses the gouraud shader
    ShaderProgram program2;
+   program2.setAssetPack(&assetPack);
    program2.loadShaders("shaders/gouraud_vertex.glsl", "shaders/gouraud_fragment.glsl");
 
   	programId2 = program2.getProgramId();
 
+   // this creates the program that tessellates the central head, where tessellation shaders exist
+   ShaderProgram programTess;
+   if (GLEW_VERSION_4_0 || GLEW_ARB_tessellation_shader) {
+      programTess.setAssetPack(&assetPack);
+      programIdTess = programTess.loadShaders("shaders/pn_vertex.glsl", "shaders/pn_control.glsl",
+                                              "shaders/pn_evaluation.glsl", "shaders/phong_fragment.glsl");
+   }
+
    glutMainLoop();
 
    return 0;
@@ -3,19 +3,42 @@ uniform mat4 u_MVMatrix;
 uniform vec3 u_LightPos;
 uniform vec4 u_DiffuseColour;
 
+// the vertex attributes may be quantised: positions as integers across the mesh's bounding box,
+// and normals octahedrally encoded in two integers (see VertexQuantization.h); for float
+// attributes the offset is 0, the scale 1, and u_OctahedralNormals false
+uniform vec3 u_PositionOffset;
+uniform vec3 u_PositionScale;
+uniform bool u_OctahedralNormals;
+
 attribute vec4 position;
 attribute vec3 normal;
 
 varying vec4 v_Colour;
 
+vec3 decodeNormal(vec3 encoded) {
+    if (!u_OctahedralNormals) {
+        return encoded;
+    }
+    vec2 folded = encoded.xy / 32767.0;
+    vec3 n = vec3(folded, 1.0 - abs(folded.x) - abs(folded.y));
+    if (n.z < 0.0) {
+        vec2 signs = vec2(n.x >= 0.0 ? 1.0 : -1.0, n.y >= 0.0 ? 1.0 : -1.0);
+        n.xy = (1.0 - abs(n.yx)) * signs;
+    }
+    return normalize(n);
+}
+
 void main() {
     vec4 ambientColour = vec4(0.1, 0.1, 0.1, 1.0) * u_DiffuseColour;
 
+    // Decode the position and normal, if they are quantised.
+    vec4 modelPosition = vec4(u_PositionOffset + u_PositionScale * position.xyz, 1.0);
+
     // Transform the vertex into eye space.
-    vec3 position_worldspace = vec3(u_MVMatrix * position);
+    vec3 position_worldspace = vec3(u_MVMatrix * modelPosition);
 
     // Transform the normal's orientation into eye space.
-    vec3 normal_worldspace = normalize(vec3(u_MVMatrix * vec4(normal, 0.0)));
+    vec3 normal_worldspace = normalize(vec3(u_MVMatrix * vec4(decodeNormal(normal), 0.0)));
 
     // Will be used for attenuation.
     float distance = length(u_LightPos - position_worldspace);
@@ -35,5 +58,5 @@ void main() {
 
     // gl_Position is a special variable used to store the final position.
     // Multiply the vertex by the matrix to get the final point in normalized screen coordinates.
-    gl_Position = u_MVPMatrix * position;
+    gl_Position = u_MVPMatrix * modelPosition;
 }
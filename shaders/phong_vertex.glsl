@@ -4,6 +4,13 @@ uniform mat4 u_MVPMatrix;
 uniform mat4 u_MVMatrix;
 uniform vec4 u_DiffuseColour;
 
+// the vertex attributes may be quantised: positions as integers across the mesh's bounding box,
+// and normals octahedrally encoded in two integers (see VertexQuantization.h); for float
+// attributes the offset is 0, the scale 1, and u_OctahedralNormals false
+uniform vec3 u_PositionOffset;
+uniform vec3 u_PositionScale;
+uniform bool u_OctahedralNormals;
+
 attribute vec4 position;
 attribute vec3 normal;
 
@@ -14,14 +21,29 @@ varying vec2 v_TextureCoords;
 attribute vec2 textureCoords;
 uniform sampler2D textureSampler;
 
+vec3 decodeNormal(vec3 encoded) {
+    if (!u_OctahedralNormals) {
+        return encoded;
+    }
+    vec2 folded = encoded.xy / 32767.0;
+    vec3 n = vec3(folded, 1.0 - abs(folded.x) - abs(folded.y));
+    if (n.z < 0.0) {
+        vec2 signs = vec2(n.x >= 0.0 ? 1.0 : -1.0, n.y >= 0.0 ? 1.0 : -1.0);
+        n.xy = (1.0 - abs(n.yx)) * signs;
+    }
+    return normalize(n);
+}
+
 void main() {
    // interpolated parameters
    v_TextureCoords = textureCoords;
 
+    vec4 modelPosition = vec4(u_PositionOffset + u_PositionScale * position.xyz, 1.0);
+
     // interpolate the eye space position and normal
-    v_Position = vec3(u_MVMatrix * position);
-    v_Normal = vec3(u_MVMatrix * vec4(normal, 0.0));
+    v_Position = vec3(u_MVMatrix * modelPosition);
+    v_Normal = vec3(u_MVMatrix * vec4(decodeNormal(normal), 0.0));
 
     // perform the usual model-view-projection transformation for the vertex position
-    gl_Position = u_MVPMatrix * position;
+    gl_Position = u_MVPMatrix * modelPosition;
 }
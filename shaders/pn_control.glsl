@@ -0,0 +1,101 @@
+#version 400
+
+// turns each triangle into a PN triangle (Vlachos et al., "Curved PN Triangles"): a cubic
+// Bezier patch through its corners, bent to meet their normals, with a quadratic patch of
+// normals. The patch depends on an edge's two corners alone along that edge, so triangles that
+// share corners meet without cracks.
+//
+// Each edge is split into segments of about u_TessPixelEdge pixels on screen, so the detail
+// follows the camera; an edge's level also depends on its corners alone, so both of its
+// triangles split it alike.
+
+layout(vertices = 3) out;
+
+uniform mat4 u_MVPMatrix;
+uniform vec2 u_ViewportSize;
+uniform float u_TessPixelEdge;
+
+in vec3 vc_Position[];
+in vec3 vc_Normal[];
+in vec2 vc_TextureCoords[];
+
+out vec3 tc_Position[];
+out vec3 tc_Normal[];
+out vec2 tc_TextureCoords[];
+
+// the control points between the corners, b210 being the one by corner 0 towards corner 1, and
+// the centre one; and the normals at the middle of each edge, n110 being the one between corners
+// 0 and 1
+patch out vec3 tc_B210;
+patch out vec3 tc_B120;
+patch out vec3 tc_B021;
+patch out vec3 tc_B012;
+patch out vec3 tc_B102;
+patch out vec3 tc_B201;
+patch out vec3 tc_B111;
+patch out vec3 tc_N110;
+patch out vec3 tc_N011;
+patch out vec3 tc_N101;
+
+// a third of the way from pi to pj, projected onto the tangent plane at pi
+vec3 edgeControlPoint(vec3 pi, vec3 pj, vec3 ni) {
+    return (2.0 * pi + pj - dot(pj - pi, ni) * ni) / 3.0;
+}
+
+// the average of the corner normals, reflected in the plane across the edge
+vec3 edgeNormal(vec3 pi, vec3 pj, vec3 ni, vec3 nj) {
+    vec3 edge = pj - pi;
+    float v = 2.0 * dot(edge, ni + nj) / max(dot(edge, edge), 1e-12);
+    return normalize(ni + nj - v * edge);
+}
+
+// a corner in pixels from the centre of the viewport; one behind the eye is kept in front
+vec2 screenPosition(vec3 p) {
+    vec4 clip = u_MVPMatrix * vec4(p, 1.0);
+    return clip.xy / max(clip.w, 1e-4) * 0.5 * u_ViewportSize;
+}
+
+float edgeLevel(vec2 a, vec2 b) {
+    return clamp(distance(a, b) / u_TessPixelEdge, 1.0, float(gl_MaxTessGenLevel));
+}
+
+void main() {
+    tc_Position[gl_InvocationID] = vc_Position[gl_InvocationID];
+    tc_Normal[gl_InvocationID] = vc_Normal[gl_InvocationID];
+    tc_TextureCoords[gl_InvocationID] = vc_TextureCoords[gl_InvocationID];
+
+    // the patch's own data is written once
+    if (gl_InvocationID != 0) {
+        return;
+    }
+
+    vec3 p0 = vc_Position[0];
+    vec3 p1 = vc_Position[1];
+    vec3 p2 = vc_Position[2];
+    vec3 n0 = vc_Normal[0];
+    vec3 n1 = vc_Normal[1];
+    vec3 n2 = vc_Normal[2];
+
+    tc_B210 = edgeControlPoint(p0, p1, n0);
+    tc_B120 = edgeControlPoint(p1, p0, n1);
+    tc_B021 = edgeControlPoint(p1, p2, n1);
+    tc_B012 = edgeControlPoint(p2, p1, n2);
+    tc_B102 = edgeControlPoint(p2, p0, n2);
+    tc_B201 = edgeControlPoint(p0, p2, n0);
+    vec3 edgeAverage = (tc_B210 + tc_B120 + tc_B021 + tc_B012 + tc_B102 + tc_B201) / 6.0;
+    vec3 cornerAverage = (p0 + p1 + p2) / 3.0;
+    tc_B111 = edgeAverage + (edgeAverage - cornerAverage) * 0.5;
+
+    tc_N110 = edgeNormal(p0, p1, n0, n1);
+    tc_N011 = edgeNormal(p1, p2, n1, n2);
+    tc_N101 = edgeNormal(p2, p0, n2, n0);
+
+    // outer level i is for the edge opposite corner i
+    vec2 s0 = screenPosition(p0);
+    vec2 s1 = screenPosition(p1);
+    vec2 s2 = screenPosition(p2);
+    gl_TessLevelOuter[0] = edgeLevel(s1, s2);
+    gl_TessLevelOuter[1] = edgeLevel(s2, s0);
+    gl_TessLevelOuter[2] = edgeLevel(s0, s1);
+    gl_TessLevelInner[0] = max(gl_TessLevelOuter[0], max(gl_TessLevelOuter[1], gl_TessLevelOuter[2]));
+}
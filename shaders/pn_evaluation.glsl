@@ -0,0 +1,49 @@
+#version 400
+
+// places each vertex the tessellator generates on its PN triangle (see pn_control.glsl), and
+// hands phong_fragment.glsl the eye space position and normal it would get from phong_vertex.glsl
+
+// odd fractional spacing grows the detail smoothly as the head comes closer, rather than in steps
+layout(triangles, fractional_odd_spacing, ccw) in;
+
+uniform mat4 u_MVPMatrix;
+uniform mat4 u_MVMatrix;
+
+in vec3 tc_Position[];
+in vec3 tc_Normal[];
+in vec2 tc_TextureCoords[];
+
+patch in vec3 tc_B210;
+patch in vec3 tc_B120;
+patch in vec3 tc_B021;
+patch in vec3 tc_B012;
+patch in vec3 tc_B102;
+patch in vec3 tc_B201;
+patch in vec3 tc_B111;
+patch in vec3 tc_N110;
+patch in vec3 tc_N011;
+patch in vec3 tc_N101;
+
+out vec3 v_Position;
+out vec3 v_Normal;
+out vec2 v_TextureCoords;
+
+void main() {
+    // the weights of corners 0, 1 and 2
+    float u = gl_TessCoord.x;
+    float v = gl_TessCoord.y;
+    float w = gl_TessCoord.z;
+
+    vec3 position = tc_Position[0] * u * u * u + tc_Position[1] * v * v * v + tc_Position[2] * w * w * w
+        + tc_B210 * 3.0 * u * u * v + tc_B120 * 3.0 * u * v * v
+        + tc_B021 * 3.0 * v * v * w + tc_B012 * 3.0 * v * w * w
+        + tc_B102 * 3.0 * w * w * u + tc_B201 * 3.0 * w * u * u
+        + tc_B111 * 6.0 * u * v * w;
+    vec3 normal = tc_Normal[0] * u * u + tc_Normal[1] * v * v + tc_Normal[2] * w * w
+        + tc_N110 * u * v + tc_N011 * v * w + tc_N101 * w * u;
+
+    v_TextureCoords = tc_TextureCoords[0] * u + tc_TextureCoords[1] * v + tc_TextureCoords[2] * w;
+    v_Position = vec3(u_MVMatrix * vec4(position, 1.0));
+    v_Normal = vec3(u_MVMatrix * vec4(normalize(normal), 0.0));
+    gl_Position = u_MVPMatrix * vec4(position, 1.0);
+}
@@ -0,0 +1,37 @@
+#version 400
+
+// the vertex stage of the tessellated head: it only decodes the attributes, and leaves the
+// transforms to the evaluation shader, which builds the curved triangles in model space
+
+// the vertex attributes may be quantised, as in phong_vertex.glsl; for float attributes the
+// offset is 0, the scale 1, and u_OctahedralNormals false
+uniform vec3 u_PositionOffset;
+uniform vec3 u_PositionScale;
+uniform bool u_OctahedralNormals;
+
+in vec4 position;
+in vec3 normal;
+in vec2 textureCoords;
+
+out vec3 vc_Position;
+out vec3 vc_Normal;
+out vec2 vc_TextureCoords;
+
+vec3 decodeNormal(vec3 encoded) {
+    if (!u_OctahedralNormals) {
+        return encoded;
+    }
+    vec2 folded = encoded.xy / 32767.0;
+    vec3 n = vec3(folded, 1.0 - abs(folded.x) - abs(folded.y));
+    if (n.z < 0.0) {
+        vec2 signs = vec2(n.x >= 0.0 ? 1.0 : -1.0, n.y >= 0.0 ? 1.0 : -1.0);
+        n.xy = (1.0 - abs(n.yx)) * signs;
+    }
+    return n;
+}
+
+void main() {
+    vc_Position = u_PositionOffset + u_PositionScale * position.xyz;
+    vc_Normal = normalize(decodeNormal(normal));
+    vc_TextureCoords = textureCoords;
+}